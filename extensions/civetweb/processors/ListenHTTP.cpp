@@ -20,6 +20,12 @@
  */
 #include "ListenHTTP.h"
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "Connection.h"
+
 namespace org {
 namespace apache {
 namespace nifi {
@@ -62,6 +68,19 @@ core::Property ListenHTTP::HeadersAsAttributesRegex("HTTP Headers to receive as
                                                     " should be passed along as FlowFile attributes",
                                                     "");
 
+core::Property ListenHTTP::BatchSize(
+    core::PropertyBuilder::createProperty("Batch Size")
+        ->withDescription("Maximum number of queued requests turned into FlowFiles in a single session. 0 means all queued requests are processed at once.")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(0)->build());
+
+core::Property ListenHTTP::BufferSize(
+    core::PropertyBuilder::createProperty("Buffer Size")
+        ->withDescription("Maximum number of accepted requests waiting to be turned into FlowFiles. Requests received while the queue is full "
+                          "are refused with HTTP 503. 0 means the number of queued requests is not limited.")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(20000)->build());
+
 core::Relationship ListenHTTP::Success("success", "All files are routed to success");
 
 void ListenHTTP::initialize() {
@@ -77,11 +96,22 @@ void ListenHTTP::initialize() {
   properties.insert(SSLVerifyPeer);
   properties.insert(SSLMinimumVersion);
   properties.insert(HeadersAsAttributesRegex);
+  properties.insert(BatchSize);
+  properties.insert(BufferSize);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
   relationships.insert(Success);
   setSupportedRelationships(relationships);
+  // the queued requests are work even without incoming FlowFiles
+  setTriggerWhenEmpty(true);
+}
+
+void ListenHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  // the requests queued for the previous schedule are committed before its server is replaced
+  notifyStop();
+  session_factory_ = sessionFactory;
+  onSchedule(context.get(), sessionFactory.get());
 }
 
 void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) {
@@ -145,6 +175,10 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
     logger_->log_debug("ListenHTTP using %s: %s", HeadersAsAttributesRegex.getName(), headersAsAttributesPattern);
   }
 
+  context->getProperty(BatchSize.getName(), batch_size_);
+  uint64_t bufferSize = 0;
+  context->getProperty(BufferSize.getName(), bufferSize);
+
   auto numThreads = getMaxConcurrentTasks();
 
   logger_->log_info("ListenHTTP starting HTTP server on port %s and path %s with %d threads", randomPort ? "random" : listeningPort, basePath, numThreads);
@@ -191,7 +225,7 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
   }
 
   server_.reset(new CivetServer(options, &callbacks_, &logger_));
-  handler_.reset(new Handler(basePath, context, sessionFactory, std::move(authDNPattern), std::move(headersAsAttributesPattern)));
+  handler_.reset(new Handler(basePath, context, sessionFactory, std::move(authDNPattern), std::move(headersAsAttributesPattern), bufferSize));
   server_->addHandler(basePath, handler_.get());
 
   if (randomPort) {
@@ -211,69 +245,227 @@ void ListenHTTP::onSchedule(core::ProcessContext *context, core::ProcessSessionF
 
 ListenHTTP::~ListenHTTP() = default;
 
+void ListenHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  auto session = sessionFactory->createSession();
+  std::vector<Request> requests;
+  try {
+    processRequests(context.get(), session.get(), requests);
+    session->commit();
+  } catch (std::exception &exception) {
+    logger_->log_warn("Caught Exception %s during ListenHTTP::onTrigger of processor: %s (%s)", exception.what(), getUUIDStr(), getName());
+    session->rollback();
+    if (handler_) {
+      handler_->requeue_requests(std::move(requests));
+    }
+    throw;
+  } catch (...) {
+    logger_->log_warn("Caught Exception during ListenHTTP::onTrigger of processor: %s (%s)", getUUIDStr(), getName());
+    session->rollback();
+    if (handler_) {
+      handler_->requeue_requests(std::move(requests));
+    }
+    throw;
+  }
+  if (handler_) {
+    handler_->release_requests(requests);
+  }
+}
+
 void ListenHTTP::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+  std::vector<Request> requests;
+  processRequests(context, session, requests);
+  if (handler_) {
+    // the FlowFiles own the content as well, whether or not the caller commits
+    handler_->release_requests(requests);
+  }
+}
+
+void ListenHTTP::processRequests(core::ProcessContext *context, core::ProcessSession *session, std::vector<Request> &requests) {
   std::shared_ptr<FlowFileRecord> flow_file = std::static_pointer_cast<FlowFileRecord>(session->get());
 
-  // Do nothing if there are no incoming files
-  if (!flow_file) {
-    return;
+  if (flow_file) {
+    std::string type;
+    flow_file->getAttribute("http.type", type);
+
+    if (type == "response_body") {
+
+      if (handler_) {
+        struct response_body response { "", "", "" };
+        ResponseBodyReadCallback cb(&response.body);
+        flow_file->getAttribute("filename", response.uri);
+        flow_file->getAttribute("mime.type", response.mime_type);
+        if (response.mime_type.empty()) {
+          logger_->log_warn("Using default mime type of application/octet-stream for response body file: %s", response.uri);
+          response.mime_type = "application/octet-stream";
+        }
+        session->read(flow_file, &cb);
+        handler_->set_response_body(std::move(response));
+      }
+    }
+
+    session->remove(flow_file);
   }
 
-  std::string type;
-  flow_file->getAttribute("http.type", type);
+  if (!handler_) {
+    return;
+  }
 
-  if (type == "response_body") {
+  handler_->dequeue_requests(requests, batch_size_);
+  if (requests.empty()) {
+    if (!flow_file) {
+      // nothing was received since the last trigger
+      context->yield();
+    }
+    return;
+  }
+  logger_->log_debug("ListenHTTP turning %zu queued requests into FlowFiles", requests.size());
+  createFlowFiles(session, requests);
+}
 
-    if (handler_) {
-      struct response_body response { "", "", "" };
-      ResponseBodyReadCallback cb(&response.body);
-      flow_file->getAttribute("filename", response.uri);
-      flow_file->getAttribute("mime.type", response.mime_type);
-      if (response.mime_type.empty()) {
-        logger_->log_warn("Using default mime type of application/octet-stream for response body file: %s", response.uri);
-        response.mime_type = "application/octet-stream";
-      }
-      session->read(flow_file, &cb);
-      handler_->set_response_body(std::move(response));
+void ListenHTTP::createFlowFiles(core::ProcessSession *session, std::vector<Request> &requests) {
+  for (auto &request : requests) {
+    auto request_flow_file = session->create();
+    if (request.claim) {
+      // the content was written by the handler, the queue keeps owning it until the session is committed
+      request_flow_file->setResourceClaim(request.claim);
+      request.claim->increaseFlowFileRecordOwnedCount();
+      request_flow_file->setSize(request.size);
+      request_flow_file->setOffset(0);
     }
+    for (const auto &attribute : request.attributes) {
+      session->putAttribute(request_flow_file, attribute.first, attribute.second);
+    }
+    session->transfer(request_flow_file, Success);
   }
+}
 
-  session->remove(flow_file);
+void ListenHTTP::flushRequests() {
+  if (!handler_ || !session_factory_) {
+    return;
+  }
+  std::vector<Request> requests;
+  handler_->dequeue_requests(requests, 0);
+  if (requests.empty()) {
+    return;
+  }
+  logger_->log_info("ListenHTTP turning %zu queued requests into FlowFiles before stopping", requests.size());
+  auto session = session_factory_->createSession();
+  try {
+    createFlowFiles(session.get(), requests);
+    session->commit();
+  } catch (std::exception &exception) {
+    logger_->log_error("ListenHTTP could not commit the queued requests: %s", exception.what());
+    session->rollback();
+    handler_->requeue_requests(std::move(requests));
+    return;
+  } catch (...) {
+    logger_->log_error("ListenHTTP could not commit the queued requests");
+    session->rollback();
+    handler_->requeue_requests(std::move(requests));
+    return;
+  }
+  handler_->release_requests(requests);
 }
 
-ListenHTTP::Handler::Handler(std::string base_uri, core::ProcessContext *context, core::ProcessSessionFactory *session_factory, std::string &&auth_dn_regex, std::string &&header_as_attrs_regex)
+ListenHTTP::Handler::Handler(std::string base_uri, core::ProcessContext *context, core::ProcessSessionFactory *session_factory, std::string &&auth_dn_regex, std::string &&header_as_attrs_regex,
+                             uint64_t buffer_size)
     : base_uri_(std::move(base_uri)),
       auth_dn_regex_(std::move(auth_dn_regex)),
       headers_as_attrs_regex_(std::move(header_as_attrs_regex)),
+      content_repo_(context->getContentRepository()),
+      buffer_size_(buffer_size),
       logger_(logging::LoggerFactory<ListenHTTP::Handler>::getLogger()) {
   process_context_ = context;
   session_factory_ = session_factory;
 }
 
+ListenHTTP::Handler::~Handler() {
+  std::lock_guard<std::mutex> guard(requests_mutex_);
+  if (!requests_.empty()) {
+    logger_->log_warn("Dropping %zu requests that could not be turned into FlowFiles before ListenHTTP stopped", requests_.size());
+  }
+  for (const auto &request : requests_) {
+    release_claim(request.claim);
+  }
+}
+
 void ListenHTTP::Handler::send_error_response(struct mg_connection *conn) {
   mg_printf(conn, "HTTP/1.1 500 Internal Server Error\r\n"
             "Content-Type: text/html\r\n"
             "Content-Length: 0\r\n\r\n");
 }
 
-void ListenHTTP::Handler::set_header_attributes(const mg_request_info *req_info, const std::shared_ptr<FlowFileRecord> &flow_file) const {
+void ListenHTTP::Handler::send_unavailable_response(struct mg_connection *conn) {
+  mg_printf(conn, "HTTP/1.1 503 Service Unavailable\r\n"
+            "Content-Type: text/html\r\n"
+            "Content-Length: 0\r\n\r\n");
+}
+
+void ListenHTTP::Handler::set_header_attributes(const mg_request_info *req_info, std::map<std::string, std::string> &attributes) const {
   // Add filename from "filename" header value (and pattern headers)
   for (int i = 0; i < req_info->num_headers; i++) {
     auto header = &req_info->http_headers[i];
 
-    if (strcmp("filename", header->name) == 0) {
-      if (!flow_file->updateAttribute("filename", header->value)) {
-        flow_file->addAttribute("filename", header->value);
-      }
-    } else if (std::regex_match(header->name, headers_as_attrs_regex_)) {
-      if (!flow_file->updateAttribute(header->name, header->value)) {
-        flow_file->addAttribute(header->name, header->value);
-      }
+    if (strcmp("filename", header->name) == 0 || std::regex_match(header->name, headers_as_attrs_regex_)) {
+      attributes[header->name] = header->value;
     }
   }
 
   if (req_info->query_string) {
-    flow_file->addAttribute("http.query", req_info->query_string);
+    attributes["http.query"] = req_info->query_string;
+  }
+}
+
+bool ListenHTTP::Handler::is_back_pressured() {
+  {
+    std::lock_guard<std::mutex> guard(requests_mutex_);
+    if (buffer_size_ > 0 && requests_.size() >= buffer_size_) {
+      return true;
+    }
+  }
+  for (const auto &connectable : process_context_->getProcessorNode()->getOutGoingConnections(Success.getName())) {
+    auto connection = std::dynamic_pointer_cast<Connection>(connectable);
+    if (connection && connection->isFull()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ListenHTTP::Handler::enqueue_request(Request &&request) {
+  std::lock_guard<std::mutex> guard(requests_mutex_);
+  // other threads may have filled the queue since the request was accepted
+  if (buffer_size_ > 0 && requests_.size() >= buffer_size_) {
+    return false;
+  }
+  requests_.push_back(std::move(request));
+  return true;
+}
+
+void ListenHTTP::Handler::dequeue_requests(std::vector<Request> &requests, uint64_t max_count) {
+  std::lock_guard<std::mutex> guard(requests_mutex_);
+  const size_t count = max_count > 0 && max_count < requests_.size() ? static_cast<size_t>(max_count) : requests_.size();
+  requests.reserve(requests.size() + count);
+  std::move(requests_.begin(), requests_.begin() + count, std::back_inserter(requests));
+  requests_.erase(requests_.begin(), requests_.begin() + count);
+}
+
+void ListenHTTP::Handler::requeue_requests(std::vector<Request> &&requests) {
+  std::lock_guard<std::mutex> guard(requests_mutex_);
+  requests_.insert(requests_.begin(), std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+  requests.clear();
+}
+
+void ListenHTTP::Handler::release_requests(const std::vector<Request> &requests) {
+  for (const auto &request : requests) {
+    release_claim(request.claim);
+  }
+}
+
+void ListenHTTP::Handler::release_claim(const std::shared_ptr<ResourceClaim> &claim) {
+  if (claim) {
+    claim->decreaseFlowFileRecordOwnedCount();
+    content_repo_->removeIfOrphaned(claim);
   }
 }
 
@@ -289,35 +481,52 @@ bool ListenHTTP::Handler::handlePost(CivetServer *server, struct mg_connection *
     return true;
   }
 
+  if (is_back_pressured()) {
+    logger_->log_debug("ListenHTTP refusing POST request, its FlowFile could not be queued");
+    send_unavailable_response(conn);
+    return true;
+  }
+
   // Always send 100 Continue, as allowed per standard to minimize client delay (https://www.w3.org/Protocols/rfc2616/rfc2616-sec8.html)
   mg_printf(conn, "HTTP/1.1 100 Continue\r\n\r\n");
 
-  auto session = session_factory_->createSession();
-  ListenHTTP::WriteCallback callback(conn, req_info);
-  auto flow_file = std::static_pointer_cast<FlowFileRecord>(session->create());
-
-  if (!flow_file) {
-    send_error_response(conn);
-    return true;
-  }
+  Request request;
+  request.claim = std::make_shared<ResourceClaim>(content_repo_);
+  request.claim->increaseFlowFileRecordOwnedCount();
 
   try {
-    session->write(flow_file, &callback);
-    set_header_attributes(req_info, flow_file);
-
-    session->transfer(flow_file, Success);
-    session->commit();
+    auto stream = content_repo_->write(request.claim);
+    if (!stream) {
+      logger_->log_error("ListenHTTP could not write the content of the request to %s", request.claim->getContentFullPath());
+      release_claim(request.claim);
+      send_error_response(conn);
+      return true;
+    }
+    ListenHTTP::WriteCallback callback(conn, req_info);
+    const int64_t size = callback.process(stream);
+    stream->closeStream();
+    request.size = size > 0 ? size : 0;
   } catch (std::exception &exception) {
     logger_->log_error("ListenHTTP Caught Exception %s", exception.what());
+    release_claim(request.claim);
     send_error_response(conn);
-    session->rollback();
     throw;
   } catch (...) {
     logger_->log_error("ListenHTTP Caught Exception Processor::onTrigger");
+    release_claim(request.claim);
     send_error_response(conn);
-    session->rollback();
     throw;
   }
+  set_header_attributes(req_info, request.attributes);
+
+  // the claim is moved into the queue, keep it for releasing it when the queue is full
+  const auto claim = request.claim;
+  if (!enqueue_request(std::move(request))) {
+    logger_->log_debug("ListenHTTP refusing POST request, its FlowFile could not be queued");
+    release_claim(claim);
+    send_unavailable_response(conn);
+    return true;
+  }
 
   mg_printf(conn, "HTTP/1.1 200 OK\r\n");
   write_body(conn, req_info);
@@ -352,31 +561,16 @@ bool ListenHTTP::Handler::handleGet(CivetServer *server, struct mg_connection *c
     return true;
   }
 
-  auto session = session_factory_->createSession();
-  auto flow_file = std::static_pointer_cast<FlowFileRecord>(session->create());
+  Request request;
+  request.size = 0;
+  set_header_attributes(req_info, request.attributes);
 
-  if (!flow_file) {
-    send_error_response(conn);
+  if (is_back_pressured() || !enqueue_request(std::move(request))) {
+    logger_->log_debug("ListenHTTP refusing GET request, its FlowFile could not be queued");
+    send_unavailable_response(conn);
     return true;
   }
 
-  try {
-    set_header_attributes(req_info, flow_file);
-
-    session->transfer(flow_file, Success);
-    session->commit();
-  } catch (std::exception &exception) {
-    logger_->log_error("ListenHTTP Caught Exception %s", exception.what());
-    send_error_response(conn);
-    session->rollback();
-    throw;
-  } catch (...) {
-    logger_->log_error("ListenHTTP Caught Exception Processor::onTrigger");
-    send_error_response(conn);
-    session->rollback();
-    throw;
-  }
-
   mg_printf(conn, "HTTP/1.1 200 OK\r\n");
   write_body(conn, req_info);
 
@@ -487,8 +681,11 @@ std::string ListenHTTP::getPort() const {
 }
 
 void ListenHTTP::notifyStop() {
+  // no request is accepted once the server is gone
   server_.reset();
+  flushRequests();
   handler_.reset();
+  session_factory_.reset();
 }
 
 } /* namespace processors */
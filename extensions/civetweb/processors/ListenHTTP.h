@@ -20,13 +20,19 @@
 #ifndef __LISTEN_HTTP_H__
 #define __LISTEN_HTTP_H__
 
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
+#include <string>
+#include <vector>
 
 #include <CivetServer.h>
 #include <concurrentqueue.h>
 
 #include "FlowFileRecord.h"
+#include "ResourceClaim.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
 #include "core/Core.h"
@@ -49,7 +55,8 @@ class ListenHTTP : public core::Processor {
    */
   ListenHTTP(std::string name, utils::Identifier uuid = utils::Identifier())
       : Processor(name, uuid),
-        logger_(logging::LoggerFactory<ListenHTTP>::getLogger()) {
+        logger_(logging::LoggerFactory<ListenHTTP>::getLogger()),
+        batch_size_(0) {
     callbacks_.log_message = &log_message;
     callbacks_.log_access = &log_access;
   }
@@ -66,11 +73,15 @@ class ListenHTTP : public core::Processor {
   static core::Property SSLVerifyPeer;
   static core::Property SSLMinimumVersion;
   static core::Property HeadersAsAttributesRegex;
+  static core::Property BatchSize;
+  static core::Property BufferSize;
   // Supported Relationships
   static core::Relationship Success;
 
+  void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
   void onTrigger(core::ProcessContext *context, core::ProcessSession *session) override;
   void initialize() override;
+  void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
   void onSchedule(core::ProcessContext *context, core::ProcessSessionFactory *sessionFactory) override;
   std::string getPort() const;
   bool isSecure() const;
@@ -81,14 +92,35 @@ class ListenHTTP : public core::Processor {
     std::string body;
   };
 
-  // HTTP request handler
+  /**
+   * A request accepted by the server, waiting to be turned into a FlowFile by onTrigger.
+   */
+  struct Request {
+    // content staged in the content repository, null for requests without a body
+    std::shared_ptr<ResourceClaim> claim;
+    uint64_t size;
+    std::map<std::string, std::string> attributes;
+  };
+
+  /**
+   * Purpose: HTTP request handler running on the threads of the server.
+   *
+   * Design: Request bodies are written straight into the content repository and the accepted
+   * requests are queued for onTrigger, which creates their FlowFiles in batches. The client
+   * is answered once its request is queued; when the queue or the outgoing connection is full
+   * the request is refused with 503 instead. The queue owns the content of a request until the
+   * session holding its FlowFile is committed: rolled back requests are queued again and the
+   * requests still queued when the processor stops are committed in a session of their own.
+   */
   class Handler : public CivetHandler {
    public:
     Handler(std::string base_uri,
             core::ProcessContext *context,
             core::ProcessSessionFactory *sessionFactory,
             std::string &&authDNPattern,
-            std::string &&headersAsAttributesPattern);
+            std::string &&headersAsAttributesPattern,
+            uint64_t buffer_size);
+    ~Handler();
     bool handlePost(CivetServer *server, struct mg_connection *conn);
     bool handleGet(CivetServer *server, struct mg_connection *conn);
     bool handleHead(CivetServer *server, struct mg_connection *conn);
@@ -112,11 +144,31 @@ class ListenHTTP : public core::Processor {
       }
     }
 
+    /**
+     * Moves at most max_count queued requests (all of them if max_count is 0) to requests.
+     */
+    void dequeue_requests(std::vector<Request> &requests, uint64_t max_count);
+
+    /**
+     * Puts requests whose FlowFiles were rolled back in front of the queue, even beyond its size.
+     */
+    void requeue_requests(std::vector<Request> &&requests);
+
+    /**
+     * Releases the content of requests whose FlowFiles were committed.
+     */
+    void release_requests(const std::vector<Request> &requests);
+
    private:
     // Send HTTP 500 error response to client
     void send_error_response(struct mg_connection *conn);
+    // Send HTTP 503 response to client when its request cannot be queued
+    void send_unavailable_response(struct mg_connection *conn);
     bool auth_request(mg_connection *conn, const mg_request_info *req_info) const;
-    void set_header_attributes(const mg_request_info *req_info, const std::shared_ptr<FlowFileRecord> &flow_file) const;
+    void set_header_attributes(const mg_request_info *req_info, std::map<std::string, std::string> &attributes) const;
+    bool is_back_pressured();
+    bool enqueue_request(Request &&request);
+    void release_claim(const std::shared_ptr<ResourceClaim> &claim);
     void write_body(mg_connection *conn, const mg_request_info *req_info, bool include_payload = true);
 
     std::string base_uri_;
@@ -124,6 +176,12 @@ class ListenHTTP : public core::Processor {
     std::regex headers_as_attrs_regex_;
     core::ProcessContext *process_context_;
     core::ProcessSessionFactory *session_factory_;
+    std::shared_ptr<core::ContentRepository> content_repo_;
+
+    // 0 means the queue is not bounded
+    uint64_t buffer_size_;
+    std::deque<Request> requests_;
+    std::mutex requests_mutex_;
 
     // Logger
     std::shared_ptr<logging::Logger> logger_;
@@ -205,13 +263,22 @@ class ListenHTTP : public core::Processor {
   void notifyStop() override;
 
  private:
+  // handles a response body FlowFile and turns at most Batch Size queued requests into FlowFiles
+  void processRequests(core::ProcessContext *context, core::ProcessSession *session, std::vector<Request> &requests);
+  void createFlowFiles(core::ProcessSession *session, std::vector<Request> &requests);
+  // commits the requests still queued once the server is gone
+  void flushRequests();
+
   // Logger
   std::shared_ptr<logging::Logger> logger_;
 
   CivetCallbacks callbacks_;
   std::unique_ptr<CivetServer> server_;
   std::unique_ptr<Handler> handler_;
+  // kept for committing the queued requests when the processor stops
+  std::shared_ptr<core::ProcessSessionFactory> session_factory_;
   std::string listeningPort;
+  uint64_t batch_size_;
 };
 
 REGISTER_RESOURCE(ListenHTTP, "Starts an HTTP Server and listens on a given base path to transform incoming requests into FlowFiles. The default URI of the Service will be "
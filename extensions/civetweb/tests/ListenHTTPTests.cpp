@@ -159,6 +159,7 @@ class ListenHTTPTestsFixture {
             REQUIRE("" == response_body);
           }
 
+          plan->runCurrentProcessor(); // ListenHTTP
           plan->runNextProcessor(); // LogAttribute
           REQUIRE(LogTestController::getInstance().contains("Size:" + std::to_string(payload.size()) + " Offset:0"));
         }
@@ -168,6 +169,16 @@ class ListenHTTPTestsFixture {
     }
   }
 
+  int64_t send_request() {
+    client = std::unique_ptr<utils::HTTPClient>(new utils::HTTPClient());
+    client->initialize(method, url, ssl_context_service);
+    if (method == "POST") {
+      client->setPostFields(payload);
+    }
+    REQUIRE(client->submit());
+    return client->getResponseCode();
+  }
+
  protected:
   char* tmp_dir_format;
   std::string tmp_dir;
@@ -208,6 +219,54 @@ TEST_CASE_METHOD(ListenHTTPTestsFixture, "HTTP POST", "[basic]") {
   test_connect();
 }
 
+TEST_CASE_METHOD(ListenHTTPTestsFixture, "HTTP requests are turned into FlowFiles in batches", "[basic][batch]") {
+  plan->setProperty(listen_http, "Batch Size", "2");
+  endpoint = "test2";
+  method = "POST";
+  payload = "Test payload";
+  run_server();
+
+  for (int i = 0; i < 3; ++i) {
+    REQUIRE(send_request() == 200);
+  }
+  plan->runCurrentProcessor(); // ListenHTTP
+  REQUIRE(LogTestController::getInstance().contains("ListenHTTP turning 2 queued requests into FlowFiles"));
+  plan->runCurrentProcessor(); // ListenHTTP
+  REQUIRE(LogTestController::getInstance().contains("ListenHTTP turning 1 queued requests into FlowFiles"));
+}
+
+TEST_CASE_METHOD(ListenHTTPTestsFixture, "HTTP requests are refused while the queue is full", "[basic][batch]") {
+  plan->setProperty(listen_http, "Buffer Size", "1");
+  endpoint = "test2";
+  method = "POST";
+  payload = "Test payload";
+  run_server();
+
+  REQUIRE(send_request() == 200);
+  REQUIRE(send_request() == 503);
+  plan->runCurrentProcessor(); // ListenHTTP
+  REQUIRE(send_request() == 200);
+
+  plan->runCurrentProcessor(); // ListenHTTP
+  plan->runNextProcessor(); // LogAttribute
+  REQUIRE(LogTestController::getInstance().contains("Size:" + std::to_string(payload.size()) + " Offset:0"));
+}
+
+TEST_CASE_METHOD(ListenHTTPTestsFixture, "HTTP requests still queued are committed when ListenHTTP stops", "[basic][batch]") {
+  endpoint = "test2";
+  method = "POST";
+  payload = "Test payload";
+  run_server();
+
+  REQUIRE(send_request() == 200);
+  REQUIRE(send_request() == 200);
+  listen_http->setScheduledState(core::ScheduledState::STOPPED);
+  REQUIRE(LogTestController::getInstance().contains("ListenHTTP turning 2 queued requests into FlowFiles before stopping"));
+
+  plan->runNextProcessor(); // LogAttribute
+  REQUIRE(LogTestController::getInstance().contains("Size:" + std::to_string(payload.size()) + " Offset:0"));
+}
+
 TEST_CASE_METHOD(ListenHTTPTestsFixture, "HTTP PUT", "[basic]") {
   run_server();
 
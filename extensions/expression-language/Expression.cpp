@@ -734,18 +734,12 @@ Value expr_replace(const std::vector<Value> &args) {
   return Value(result);
 }
 
-Value expr_replaceFirst(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
-  const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace, std::regex_constants::format_first_only));
+Value expr_replaceFirst(const std::vector<Value> &args, const std::regex &find) {
+  return Value(std::regex_replace(args[0].asString(), find, args[2].asString(), std::regex_constants::format_first_only));
 }
 
-Value expr_replaceAll(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
-  const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace));
+Value expr_replaceAll(const std::vector<Value> &args, const std::regex &find) {
+  return Value(std::regex_replace(args[0].asString(), find, args[2].asString()));
 }
 
 Value expr_replaceNull(const std::vector<Value> &args) {
@@ -757,23 +751,17 @@ Value expr_replaceNull(const std::vector<Value> &args) {
 }
 
 Value expr_replaceEmpty(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find("^[ \n\r\t]*$");
-  const std::string &replace = args[1].asString();
-  return Value(std::regex_replace(result, find, replace));
+  static const std::regex find("^[ \n\r\t]*$", std::regex::ECMAScript | std::regex::optimize);
+  return Value(std::regex_replace(args[0].asString(), find, args[1].asString()));
 }
 
-Value expr_matches(const std::vector<Value> &args) {
-  const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
-
+Value expr_matches(const std::vector<Value> &args, const std::regex &expr) {
+  const auto subject = args[0].asString();
   return Value(std::regex_match(subject.begin(), subject.end(), expr));
 }
 
-Value expr_find(const std::vector<Value> &args) {
-  const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
-
+Value expr_find(const std::vector<Value> &args, const std::regex &expr) {
+  const auto subject = args[0].asString();
   return Value(std::regex_search(subject.begin(), subject.end(), expr));
 }
 
@@ -889,8 +877,16 @@ Value expr_random(const std::vector<Value> &args) {
   return Value(distribution(generator));
 }
 
-template<Value T(const std::vector<Value> &)>
-Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+/**
+ * Functions whose result depends on more than their arguments, they are never evaluated at compile time.
+ */
+bool is_volatile_function(const std::string &function_name) {
+  return function_name == "hostname" || function_name == "ip" || function_name == "UUID" || function_name == "random" || function_name == "now"
+      || function_name == "resolve_user_id";
+}
+
+Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args,
+                                            const std::function<Value(const std::vector<Value> &)> &fn) {
 
   if (args.size() < num_args) {
     std::stringstream message_ss;
@@ -905,23 +901,79 @@ Expression make_dynamic_function_incomplete(const std::string &function_name, co
       multi_args.emplace_back(*it);
     }
 
-    return args[0].compose_multi([=](const std::vector<Value> &args) -> Value {
-      return T(args);
-    },
-                                 multi_args);
-  } else {
-    return make_dynamic([=](const Parameters &params, const std::vector<Expression> &sub_exprs) -> Value {
-      std::vector<Value> evaluated_args;
+    return args[0].compose_multi(fn, multi_args);
+  }
 
-      for (const auto &arg : args) {
-        evaluated_args.emplace_back(arg(params));
-      }
+  const bool is_constant = !args.empty() && !is_volatile_function(function_name) && std::none_of(args.begin(), args.end(), [](const Expression &arg) {
+    return arg.is_dynamic();
+  });
+  if (is_constant) {
+    // static subtrees are folded into a single value, unless they fail, in which case the error is
+    // left to be reported when the expression is evaluated
+    std::vector<Value> static_args;
+    static_args.reserve(args.size());
+    for (const auto &arg : args) {
+      static_args.emplace_back(arg(Parameters()));
+    }
+    try {
+      return Expression(fn(static_args));
+    } catch (const std::exception &) {
+    }
+  }
+
+  return make_dynamic([=](const Parameters &params, const std::vector<Expression> &sub_exprs) -> Value {
+    std::vector<Value> evaluated_args;
+    evaluated_args.reserve(args.size());
+
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(params));
+    }
 
-      return T(evaluated_args);
+    return fn(evaluated_args);
+  });
+}
+
+template<Value T(const std::vector<Value> &)>
+Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+  return make_dynamic_function_incomplete(function_name, args, num_args, T);
+}
+
+#ifdef EXPRESSION_LANGUAGE_USE_REGEX
+
+std::shared_ptr<const std::regex> compile_static_regex(const Expression &pattern) {
+  if (pattern.is_dynamic() || pattern.is_multi()) {
+    return nullptr;
+  }
+  try {
+    return std::make_shared<const std::regex>(pattern(Parameters()).asString(), std::regex::ECMAScript | std::regex::optimize);
+  } catch (const std::regex_error &) {
+    // invalid patterns fail on evaluation, as dynamic ones do
+    return nullptr;
+  }
+}
+
+/**
+ * Creates a function taking a regular expression as its regex_arg-th argument. Literal patterns are compiled
+ * once, dynamic ones on every evaluation.
+ */
+template<Value T(const std::vector<Value> &, const std::regex &)>
+Expression make_regex_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args, std::size_t regex_arg) {
+  std::shared_ptr<const std::regex> regex;
+  if (args.size() > regex_arg) {
+    regex = compile_static_regex(args[regex_arg]);
+  }
+  if (regex) {
+    return make_dynamic_function_incomplete(function_name, args, num_args, [regex](const std::vector<Value> &args) -> Value {
+      return T(args, *regex);
     });
   }
+  return make_dynamic_function_incomplete(function_name, args, num_args, [regex_arg](const std::vector<Value> &args) -> Value {
+    return T(args, std::regex(args[regex_arg].asString()));
+  });
 }
 
+#endif  // EXPRESSION_LANGUAGE_USE_REGEX
+
 Value expr_literal(const std::vector<Value> &args) {
   return args[0];
 }
@@ -1127,11 +1179,19 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
     return Value(all_true);
   });
 
+  std::vector<std::shared_ptr<const std::regex>> static_regexes;
+  for (const auto &arg : args) {
+    static_regexes.push_back(compile_static_regex(arg));
+  }
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      auto attr_regex = static_regexes[i];
+      if (!attr_regex) {
+        attr_regex = std::make_shared<const std::regex>(args[i](params).asString());
+      }
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1140,7 +1200,7 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1180,11 +1240,19 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
     return Value(any_true);
   });
 
+  std::vector<std::shared_ptr<const std::regex>> static_regexes;
+  for (const auto &arg : args) {
+    static_regexes.push_back(compile_static_regex(arg));
+  }
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      auto attr_regex = static_regexes[i];
+      if (!attr_regex) {
+        attr_regex = std::make_shared<const std::regex>(args[i](params).asString());
+      }
       const auto cur_flow_file = params.flow_file.lock();
       std::map<std::string, std::string> attrs;
 
@@ -1193,7 +1261,7 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
       }
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (std::regex_match(attr.first.begin(), attr.first.end(), *attr_regex)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1407,17 +1475,17 @@ Expression make_dynamic_function(const std::string &function_name, const std::ve
   } else if (function_name == "replace") {
     return make_dynamic_function_incomplete<expr_replace>(function_name, args, 2);
   } else if (function_name == "replaceFirst") {
-    return make_dynamic_function_incomplete<expr_replaceFirst>(function_name, args, 2);
+    return make_regex_function_incomplete<expr_replaceFirst>(function_name, args, 2, 1);
   } else if (function_name == "replaceAll") {
-    return make_dynamic_function_incomplete<expr_replaceAll>(function_name, args, 2);
+    return make_regex_function_incomplete<expr_replaceAll>(function_name, args, 2, 1);
   } else if (function_name == "replaceNull") {
     return make_dynamic_function_incomplete<expr_replaceNull>(function_name, args, 1);
   } else if (function_name == "replaceEmpty") {
     return make_dynamic_function_incomplete<expr_replaceEmpty>(function_name, args, 1);
   } else if (function_name == "matches") {
-    return make_dynamic_function_incomplete<expr_matches>(function_name, args, 1);
+    return make_regex_function_incomplete<expr_matches>(function_name, args, 1, 1);
   } else if (function_name == "find") {
-    return make_dynamic_function_incomplete<expr_find>(function_name, args, 1);
+    return make_regex_function_incomplete<expr_find>(function_name, args, 1, 1);
   } else if (function_name == "allMatchingAttributes") {
     return make_allMatchingAttributes(function_name, args);
   } else if (function_name == "anyMatchingAttribute") {
@@ -1534,30 +1602,33 @@ Expression Expression::operator+(const Expression &other_expr) const {
     sub_expr_generator,
     other_sub_expr_generator](const Parameters &params,
         const std::vector<Expression> &sub_exprs) -> Value {
-      Value result = val_fn(params, sub_expr_generator(params));
-      return Value(result.asString().append(other_val_fn(params, other_sub_expr_generator(params)).asString()));
+      std::string result = val_fn(params, sub_expr_generator(params)).asString();
+      result.append(other_val_fn(params, other_sub_expr_generator(params)).asString());
+      return Value(std::move(result));
     });
   } else if (is_dynamic() && !other_expr.is_dynamic()) {
     auto val_fn = val_fn_;
-    auto other_val = other_expr.val_;
+    auto other_val = other_expr.val_.asString();
     auto sub_expr_generator = sub_expr_generator_;
     return make_dynamic([val_fn,
     other_val,
     sub_expr_generator](const Parameters &params,
         const std::vector<Expression> &sub_exprs) -> Value {
-      Value result = val_fn(params, sub_expr_generator(params));
-      return Value(result.asString().append(other_val.asString()));
+      std::string result = val_fn(params, sub_expr_generator(params)).asString();
+      result.append(other_val);
+      return Value(std::move(result));
     });
   } else if (!is_dynamic() && other_expr.is_dynamic()) {
-    auto val = val_;
+    auto val = val_.asString();
     auto other_val_fn = other_expr.val_fn_;
     auto other_sub_expr_generator = other_expr.sub_expr_generator_;
     return make_dynamic([val,
     other_val_fn,
     other_sub_expr_generator](const Parameters &params,
         const std::vector<Expression> &sub_exprs) -> Value {
-      Value result(val);
-      return Value(result.asString().append(other_val_fn(params, other_sub_expr_generator(params)).asString()));
+      std::string result(val);
+      result.append(other_val_fn(params, other_sub_expr_generator(params)).asString());
+      return Value(std::move(result));
     });
   } else if (!is_dynamic() && !other_expr.is_dynamic()) {
     std::string result(val_.asString());
@@ -18,8 +18,12 @@
 
 #include <time.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 #ifndef DISABLE_CURL
 #pragma comment(lib, "libcurl.lib")
 #pragma comment(lib, "Ws2_32.lib")
@@ -540,6 +544,26 @@ TEST_CASE("Find 3", "[expressionLanguageFind3]") {  // NOLINT
   REQUIRE("true" == expr( { flow_file_a }).asString());
 }
 
+TEST_CASE("Dynamic regex", "[expressionLanguageDynamicRegex]") {  // NOLINT
+  auto expr = expression::compile("${attr:replaceAll(${pattern}, '_'):matches(${match})}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "a.brand.new.txt");
+  flow_file_a->addAttribute("pattern", "[.]");
+  flow_file_a->addAttribute("match", "a_brand_new_txt");
+  REQUIRE("true" == expr( { flow_file_a }).asString());
+  flow_file_a->setAttribute("pattern", "n");
+  REQUIRE("false" == expr( { flow_file_a }).asString());
+}
+
+TEST_CASE("Invalid literal regex fails on evaluation", "[expressionLanguageInvalidRegex]") {  // NOLINT
+  auto expr = expression::compile("${attr:matches('(unclosed')}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "unclosed");
+  REQUIRE_THROWS(expr( { flow_file_a }));
+}
+
 TEST_CASE("IndexOf", "[expressionLanguageIndexOf]") {  // NOLINT
   auto expr = expression::compile("${attr:indexOf('a.*txt')}");
 
@@ -1570,3 +1594,44 @@ TEST_CASE("resolve_user_id_test", "[resolve_user_id tests]") {  // NOLINT
 }
 }
 
+
+TEST_CASE("Static subexpressions are folded", "[expressionLanguageConstantFolding]") {  // NOLINT
+  auto expr = expression::compile("${literal('abc'):toUpper():append(${literal(2):plus(3)})}");
+  REQUIRE("ABC5" == expr( { }).asString());
+}
+
+TEST_CASE("Failing static subexpressions fail on evaluation", "[expressionLanguageConstantFolding2]") {  // NOLINT
+  auto expr = expression::compile("${literal('10'):fromRadix(40)}");
+  REQUIRE_THROWS(expr( { }));
+}
+
+TEST_CASE("Volatile functions are not folded", "[expressionLanguageConstantFolding3]") {  // NOLINT
+  auto expr = expression::compile("${UUID():toUpper()}");
+  REQUIRE(expr( { }).asString() != expr( { }).asString());
+}
+
+TEST_CASE("Expression evaluation throughput", "[.][benchmark]") {  // NOLINT
+  // typical UpdateAttribute and RouteOnAttribute properties
+  const std::vector<std::string> expressions = {
+    "${filename:matches('.*[.]txt')}",
+    "${filename:find('brand')}",
+    "${attr:replaceAll('a+', 'b')}",
+    "${attr:replaceFirst('[0-9]+', 'N'):toUpper()}",
+    "${filename:startsWith('a'):and(${attr:length():gt(${literal(2):plus(3)})})}",
+    "prefix_${filename:substringBefore('.')}_suffix"
+  };
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("filename", "a brand new filename.txt");
+  flow_file_a->addAttribute("attr", "aaa1234aaaa567aa");
+
+  const size_t evaluations = 100000;
+  for (const auto &expr_str : expressions) {
+    auto expr = expression::compile(expr_str);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < evaluations; ++i) {
+      expr( { flow_file_a });
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << expr_str << ": " << (evaluations * 1000000 / (std::max)(elapsed.count(), static_cast<decltype(elapsed.count())>(1))) << " evaluations/s" << std::endl;
+  }
+}
@@ -62,10 +62,54 @@ HTTPClient::~HTTPClient() {
   // forceClose ended up not being the issue in MINIFICPP-667, but leaving here
   // out of good hygiene.
   forceClose();
-  read_callback_.close();
+  read_callback_->close();
   logger_->log_trace("Closing HTTPClient for %s", url_);
 }
 
+void HTTPClient::reset() {
+  if (nullptr != headers_) {
+    curl_slist_free_all(headers_);
+    headers_ = nullptr;
+  }
+  read_callback_->close();
+  // the options are cleared, while the connection, session and DNS caches of the handle are left alone
+  curl_easy_reset(http_session_);
+  // the share handle is an option as well
+  if (share_ != nullptr) {
+    curl_easy_setopt(http_session_, CURLOPT_SHARE, share_);
+  }
+
+  ssl_context_service_ = nullptr;
+  url_.clear();
+  method_.clear();
+  connect_timeout_ms_ = std::chrono::milliseconds(30000);
+  read_timeout_ms_ = std::chrono::milliseconds(30000);
+  content_type_str_ = nullptr;
+  content_type_.clear();
+  callback = nullptr;
+  write_callback_ = nullptr;
+  open_response_stream_ = nullptr;
+  response_stream_ = nullptr;
+  http_code = 0;
+  read_callback_.reset(new ByteOutputCallback(INT_MAX));
+  header_response_ = utils::HTTPHeaderResponse(-1);
+  response_body_.clear();
+  res = CURLE_OK;
+  keep_alive_probe_ = std::chrono::milliseconds(-1);
+  keep_alive_idle_ = std::chrono::milliseconds(-1);
+}
+
+void HTTPClient::setShare(CURLSH *share) {
+  share_ = share;
+  curl_easy_setopt(http_session_, CURLOPT_SHARE, share);
+}
+
+int64_t HTTPClient::getNewConnectionCount() {
+  long count = 0;  // NOLINT
+  curl_easy_getinfo(http_session_, CURLINFO_NUM_CONNECTS, &count);
+  return count;
+}
+
 void HTTPClient::forceClose() {
   if (nullptr != callback) {
     callback->stop = true;
@@ -141,6 +185,17 @@ bool HTTPClient::setSpecificSSLVersion(SSLVersion specific_version) {
 }
 
 // If not set, the default will be TLS 1.0, see https://curl.haxx.se/libcurl/c/CURLOPT_SSLVERSION.html
+bool HTTPClient::setUseHTTP2() {
+#if CURL_AT_LEAST_VERSION(7, 47, 0)
+  // falls back to HTTP/1.1 where the server does not offer HTTP/2, and waits for a connection
+  // being set up to the same host rather than opening another one
+  return curl_easy_setopt(http_session_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS) == CURLE_OK
+      && curl_easy_setopt(http_session_, CURLOPT_PIPEWAIT, 1L) == CURLE_OK;
+#else
+  return false;
+#endif
+}
+
 bool HTTPClient::setMinimumSSLVersion(SSLVersion minimum_version) {
   CURLcode ret = CURLE_UNKNOWN_OPTION;
   switch (minimum_version) {
@@ -180,6 +235,34 @@ void HTTPClient::setReadCallback(HTTPReadCallback *callbackObj) {
   curl_easy_setopt(http_session_, CURLOPT_WRITEDATA, static_cast<void*>(callbackObj));
 }
 
+void HTTPClient::setResponseStream(io::BaseStream *stream) {
+  setResponseStream([stream] {return stream;});
+}
+
+void HTTPClient::setResponseStream(std::function<io::BaseStream*()> open_stream) {
+  open_response_stream_ = std::move(open_stream);
+  response_stream_ = nullptr;
+}
+
+size_t HTTPClient::writeResponseStream(char *data, size_t size, size_t nmemb, void *client_ptr) {
+  HTTPClient *client = static_cast<HTTPClient*>(client_ptr);
+  long code = 0;  // NOLINT
+  curl_easy_getinfo(client->http_session_, CURLINFO_RESPONSE_CODE, &code);
+  if (code / 100 != 2) {
+    return utils::HTTPRequestResponse::recieve_write(data, size, nmemb, static_cast<void*>(&client->content_));
+  }
+  const size_t length = size * nmemb;
+  if (client->response_stream_ == nullptr && (client->response_stream_ = client->open_response_stream_()) == nullptr) {
+    client->logger_->log_error("Could not open a stream for the response of %s", client->url_);
+    return utils::HTTPRequestResponse::CALLBACK_ABORT;
+  }
+  if (client->response_stream_->writeData(reinterpret_cast<uint8_t*>(data), static_cast<int>(length)) != static_cast<int>(length)) {
+    client->logger_->log_error("Could not store the response of %s", client->url_);
+    return utils::HTTPRequestResponse::CALLBACK_ABORT;
+  }
+  return length;
+}
+
 void HTTPClient::setUploadCallback(HTTPUploadCallback *callbackObj) {
   logger_->log_debug("Setting callback for %s", url_);
   write_callback_ = callbackObj;
@@ -239,6 +322,13 @@ void HTTPClient::setUseChunkedEncoding() {
 }
 
 bool HTTPClient::submit() {
+  if (!prepare()) {
+    return false;
+  }
+  return finish(curl_easy_perform(http_session_));
+}
+
+bool HTTPClient::prepare() {
   if (IsNullOrEmpty(url_))
     return false;
 
@@ -266,9 +356,14 @@ bool HTTPClient::submit() {
   curl_easy_setopt(http_session_, CURLOPT_URL, url_.c_str());
   logger_->log_debug("Submitting to %s", url_);
   if (callback == nullptr) {
-    content_.ptr = &read_callback_;
-    curl_easy_setopt(http_session_, CURLOPT_WRITEFUNCTION, &utils::HTTPRequestResponse::recieve_write);
-    curl_easy_setopt(http_session_, CURLOPT_WRITEDATA, static_cast<void*>(&content_));
+    content_.ptr = read_callback_.get();
+    if (open_response_stream_) {
+      curl_easy_setopt(http_session_, CURLOPT_WRITEFUNCTION, &HTTPClient::writeResponseStream);
+      curl_easy_setopt(http_session_, CURLOPT_WRITEDATA, static_cast<void*>(this));
+    } else {
+      curl_easy_setopt(http_session_, CURLOPT_WRITEFUNCTION, &utils::HTTPRequestResponse::recieve_write);
+      curl_easy_setopt(http_session_, CURLOPT_WRITEDATA, static_cast<void*>(&content_));
+    }
   }
   curl_easy_setopt(http_session_, CURLOPT_HEADERFUNCTION, &utils::HTTPHeaderResponse::receive_headers);
   curl_easy_setopt(http_session_, CURLOPT_HEADERDATA, static_cast<void*>(&header_response_));
@@ -284,9 +379,14 @@ bool HTTPClient::submit() {
     logger_->log_debug("Not using keep alive");
     curl_easy_setopt(http_session_, CURLOPT_TCP_KEEPALIVE, 0L);
   }
-  res = curl_easy_perform(http_session_);
+  return true;
+}
+
+bool HTTPClient::finish(CURLcode result) {
+  const int absoluteTimeout = std::max(0, 3 * static_cast<int>(read_timeout_ms_.count()));
+  res = result;
   if (callback == nullptr) {
-    read_callback_.close();
+    read_callback_->close();
   }
   curl_easy_getinfo(http_session_, CURLINFO_RESPONSE_CODE, &http_code);
   curl_easy_getinfo(http_session_, CURLINFO_CONTENT_TYPE, &content_type_str_);
@@ -319,7 +419,7 @@ const std::vector<char> &HTTPClient::getResponseBody() {
     if (callback && callback->ptr) {
       response_body_ = callback->ptr->to_string();
     } else {
-      response_body_ = read_callback_.to_string();
+      response_body_ = read_callback_->to_string();
     }
   }
   return response_body_;
@@ -35,6 +35,7 @@
 #include <iostream>
 #include <map>
 #include <chrono>
+#include <functional>
 #include <string>
 #ifdef WIN32
 #include <regex>
@@ -47,6 +48,7 @@
 #include "core/logging/Logger.h"
 #include "core/logging/LoggerConfiguration.h"
 #include "properties/Configure.h"
+#include "io/BaseStream.h"
 #include "io/validation.h"
 
 namespace org {
@@ -79,6 +81,26 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   void forceClose();
 
+  /**
+   * Prepares the client for another request. The connections, TLS sessions and DNS entries
+   * cached by the curl handle are kept, so the next request to the same host skips the handshakes.
+   */
+  void reset();
+
+  /**
+   * Shares the caches of the given curl share handle, which has to outlive the client. The share is kept across reset.
+   */
+  void setShare(CURLSH *share);
+
+  CURLSH *getShare() const {
+    return share_;
+  }
+
+  /**
+   * Provides the number of connections the last request had to open, 0 if it reused one.
+   */
+  int64_t getNewConnectionCount();
+
   void initialize(const std::string &method, const std::string url = "", const std::shared_ptr<minifi::controllers::SSLContextService> ssl_context_service = nullptr) override;
 
   // This is a bad API and deprecated. Use the std::chrono variant of this
@@ -99,6 +121,20 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   virtual void setReadCallback(HTTPReadCallback *callbackObj);
 
+  /**
+   * Writes the body of a successful (2xx) response to the stream as it arrives, so that it is never held
+   * in memory. The small bodies of the other responses are still provided by getResponseBody.
+   * @param stream stream which has to outlive the request
+   */
+  void setResponseStream(io::BaseStream *stream);
+
+  /**
+   * Like setResponseStream, but the stream is only opened once the first chunk of a successful body arrives,
+   * so that responses without one cost nothing.
+   * @param open_stream returns the stream, which has to outlive the request, or nullptr to abort the transfer
+   */
+  void setResponseStream(std::function<io::BaseStream*()> open_stream);
+
   struct curl_slist *build_header_list(std::string regex, const std::map<std::string, std::string> &attributes);
 
   void setContentType(std::string content_type) override;
@@ -115,6 +151,23 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   bool submit() override;
 
+  /**
+   * Sets up the request, so that the handle can be performed by a curl multi handle.
+   * @return false if the request cannot be made
+   */
+  bool prepare();
+
+  /**
+   * Collects the response once the handle of a prepared request has been performed.
+   * @param result result of the transfer
+   * @return true if the transfer succeeded
+   */
+  bool finish(CURLcode result);
+
+  CURL *getHandle() const {
+    return http_session_;
+  }
+
   CURLcode getResponseResult();
 
   int64_t &getResponseCode() override;
@@ -135,6 +188,12 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   bool setMinimumSSLVersion(SSLVersion minimum_version) override;
 
+  /**
+   * Negotiates HTTP/2 with TLS endpoints, so that concurrent requests to a host share a connection.
+   * @return false if the curl library does not support it
+   */
+  bool setUseHTTP2();
+
   DEPRECATED(/*deprecated in*/ 0.8.0, /*will remove in */ 2.0) void setKeepAliveProbe(long probe) {
     keep_alive_probe_ = std::chrono::milliseconds(probe * 1000);
   }
@@ -225,6 +284,8 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
  private:
   static int onProgress(void *client, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 
+  static size_t writeResponseStream(char *data, size_t size, size_t nmemb, void *client);
+
   struct Progress{
     std::chrono::steady_clock::time_point last_transferred_;
     curl_off_t uploaded_data_;
@@ -269,14 +330,18 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
   struct curl_slist *headers_{nullptr};
   HTTPReadCallback *callback{nullptr};
   HTTPUploadCallback *write_callback_{nullptr};
+  std::function<io::BaseStream*()> open_response_stream_;
+  io::BaseStream *response_stream_{nullptr};
   int64_t http_code{0};
-  ByteOutputCallback read_callback_{INT_MAX};
+  std::unique_ptr<ByteOutputCallback> read_callback_{new ByteOutputCallback(INT_MAX)};
   utils::HTTPHeaderResponse header_response_{-1};
 
   CURLcode res{CURLE_OK};
 
   CURL *http_session_;
 
+  CURLSH *share_{nullptr};
+
   std::string method_;
 
   std::chrono::milliseconds keep_alive_probe_{-1};
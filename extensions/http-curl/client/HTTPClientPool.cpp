@@ -0,0 +1,110 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPClientPool.h"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+constexpr size_t HTTPClientPool::DEFAULT_MAX_IDLE_CLIENTS;
+
+HTTPClientPool::HTTPClientPool(size_t max_idle_clients)
+    : share_(curl_share_init()),
+      max_idle_clients_(max_idle_clients) {
+  if (share_ != nullptr) {
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HTTPClientPool::lock);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HTTPClientPool::unlock);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, static_cast<void*>(this));
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+}
+
+HTTPClientPool::~HTTPClientPool() {
+  // the clients have to go before the share they use
+  clear();
+  if (share_ != nullptr) {
+    curl_share_cleanup(share_);
+  }
+}
+
+void HTTPClientPool::setMaxIdleClients(size_t max_idle_clients) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_idle_clients_ = max_idle_clients;
+  if (idle_clients_.size() > max_idle_clients_) {
+    idle_clients_.resize(max_idle_clients_);
+  }
+}
+
+std::unique_ptr<HTTPClient> HTTPClientPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_clients_.empty()) {
+      auto client = std::move(idle_clients_.back());
+      idle_clients_.pop_back();
+      return client;
+    }
+  }
+  std::unique_ptr<HTTPClient> client(new HTTPClient());
+  if (share_ != nullptr) {
+    client->setShare(share_);
+  }
+  return client;
+}
+
+void HTTPClientPool::release(std::unique_ptr<HTTPClient> client) {
+  if (client == nullptr) {
+    return;
+  }
+  // drops the callbacks and the response of the finished request
+  client->reset();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (idle_clients_.size() < max_idle_clients_) {
+    idle_clients_.push_back(std::move(client));
+  }
+}
+
+void HTTPClientPool::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_clients_.clear();
+}
+
+size_t HTTPClientPool::getIdleCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_clients_.size();
+}
+
+void HTTPClientPool::lock(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void *pool) {
+  static_cast<HTTPClientPool*>(pool)->share_locks_[data].lock();
+}
+
+void HTTPClientPool::unlock(CURL* /*handle*/, curl_lock_data data, void *pool) {
+  static_cast<HTTPClientPool*>(pool)->share_locks_[data].unlock();
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,96 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_HTTP_CURL_CLIENT_HTTPCLIENTPOOL_H_
+#define EXTENSIONS_HTTP_CURL_CLIENT_HTTPCLIENTPOOL_H_
+
+#include <curl/curl.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "HTTPClient.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Reuses HTTP clients across requests, so that requests to the same endpoint keep their
+ * connections alive instead of paying for the DNS lookup and the TCP and TLS handshakes every time.
+ *
+ * Design: Idle clients keep their curl handle, whose connection cache holds the kept alive connections.
+ * All clients of the pool share their DNS and TLS session caches through a curl share handle, so even a
+ * client opening a new connection resumes the TLS session of another one.
+ */
+class HTTPClientPool {
+ public:
+  static constexpr size_t DEFAULT_MAX_IDLE_CLIENTS = 1;
+
+  explicit HTTPClientPool(size_t max_idle_clients = DEFAULT_MAX_IDLE_CLIENTS);
+
+  ~HTTPClientPool();
+
+  HTTPClientPool(const HTTPClientPool &other) = delete;
+  HTTPClientPool &operator=(const HTTPClientPool &other) = delete;
+
+  /**
+   * Sets the number of idle clients kept, which is usually the number of concurrent requests.
+   */
+  void setMaxIdleClients(size_t max_idle_clients);
+
+  /**
+   * Provides an idle client or a new one when there is none.
+   */
+  std::unique_ptr<HTTPClient> acquire();
+
+  /**
+   * Resets the client and keeps it for a later request.
+   */
+  void release(std::unique_ptr<HTTPClient> client);
+
+  /**
+   * Drops the idle clients along with their connections.
+   */
+  void clear();
+
+  size_t getIdleCount() const;
+
+ private:
+  static void lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *pool);
+
+  static void unlock(CURL *handle, curl_lock_data data, void *pool);
+
+  CURLSH *share_;
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<HTTPClient>> idle_clients_;
+  size_t max_idle_clients_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // EXTENSIONS_HTTP_CURL_CLIENT_HTTPCLIENTPOOL_H_
@@ -0,0 +1,100 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPMultiClient.h"
+
+#include <utility>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+HTTPMultiClient::HTTPMultiClient(bool multiplex)
+    : multi_(curl_multi_init()),
+      logger_(logging::LoggerFactory<HTTPMultiClient>::getLogger()) {
+#ifdef CURLPIPE_MULTIPLEX
+  if (multiplex && multi_ != nullptr) {
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  }
+#endif
+}
+
+HTTPMultiClient::~HTTPMultiClient() {
+  // requests still running are abandoned, their handles must leave before the clients clean them up
+  for (auto handle : active_) {
+    curl_multi_remove_handle(multi_, handle);
+  }
+  if (multi_ != nullptr) {
+    curl_multi_cleanup(multi_);
+  }
+}
+
+bool HTTPMultiClient::add(HTTPClient *client) {
+  if (multi_ == nullptr || !client->prepare()) {
+    return false;
+  }
+  CURL *handle = client->getHandle();
+  curl_easy_setopt(handle, CURLOPT_PRIVATE, static_cast<void*>(client));
+  const CURLMcode result = curl_multi_add_handle(multi_, handle);
+  if (result != CURLM_OK) {
+    logger_->log_error("Could not start the request to %s: %s", client->getURL(), curl_multi_strerror(result));
+    return false;
+  }
+  active_.insert(handle);
+  return true;
+}
+
+std::vector<std::pair<HTTPClient*, bool>> HTTPMultiClient::perform(std::chrono::milliseconds timeout) {
+  std::vector<std::pair<HTTPClient*, bool>> completed;
+  int running = 0;
+  curl_multi_perform(multi_, &running);
+  collect(completed);
+  if (completed.empty() && running > 0) {
+    curl_multi_wait(multi_, nullptr, 0, static_cast<int>(timeout.count()), nullptr);
+    curl_multi_perform(multi_, &running);
+    collect(completed);
+  }
+  return completed;
+}
+
+void HTTPMultiClient::collect(std::vector<std::pair<HTTPClient*, bool>> &completed) {
+  CURLMsg *message;
+  int queued = 0;
+  while ((message = curl_multi_info_read(multi_, &queued)) != nullptr) {
+    if (message->msg != CURLMSG_DONE) {
+      continue;
+    }
+    // the message is gone once its handle is removed
+    CURL *handle = message->easy_handle;
+    const CURLcode result = message->data.result;
+    char *client = nullptr;
+    curl_easy_getinfo(handle, CURLINFO_PRIVATE, &client);
+    curl_multi_remove_handle(multi_, handle);
+    active_.erase(handle);
+    auto http_client = reinterpret_cast<HTTPClient*>(client);
+    completed.emplace_back(http_client, http_client->finish(result));
+  }
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
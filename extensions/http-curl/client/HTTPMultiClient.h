@@ -0,0 +1,85 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_HTTP_CURL_CLIENT_HTTPMULTICLIENT_H_
+#define EXTENSIONS_HTTP_CURL_CLIENT_HTTPMULTICLIENT_H_
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "HTTPClient.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Performs the requests of several HTTP clients at once from a single thread, so that
+ * waiting for slow endpoints does not take a thread per request.
+ *
+ * Design: The handles of the clients are driven by a curl multi handle, which also keeps the
+ * connections they opened for the following requests. With multiplexing enabled, requests to a
+ * host that negotiated HTTP/2 share a single connection. The class is not thread safe.
+ */
+class HTTPMultiClient {
+ public:
+  explicit HTTPMultiClient(bool multiplex = false);
+
+  ~HTTPMultiClient();
+
+  HTTPMultiClient(const HTTPMultiClient &other) = delete;
+  HTTPMultiClient &operator=(const HTTPMultiClient &other) = delete;
+
+  /**
+   * Starts the request of the client, which has to stay alive until perform reports it as completed.
+   * @return false if the request could not be started
+   */
+  bool add(HTTPClient *client);
+
+  /**
+   * Drives the requests until at least one of them completes or the timeout elapses.
+   * @return the clients of the completed requests, each with whether its transfer succeeded
+   */
+  std::vector<std::pair<HTTPClient*, bool>> perform(std::chrono::milliseconds timeout);
+
+  size_t getActiveCount() const {
+    return active_.size();
+  }
+
+ private:
+  void collect(std::vector<std::pair<HTTPClient*, bool>> &completed);
+
+  CURLM *multi_;
+  std::set<CURL*> active_;
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // EXTENSIONS_HTTP_CURL_CLIENT_HTTPMULTICLIENT_H_
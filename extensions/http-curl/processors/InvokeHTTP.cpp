@@ -45,6 +45,7 @@
 #include "io/StreamFactory.h"
 #include "ResourceClaim.h"
 #include "utils/StringUtils.h"
+#include "utils/file/FileUtils.h"
 
 namespace org {
 namespace apache {
@@ -106,6 +107,17 @@ core::Property InvokeHTTP::AlwaysOutputResponse("Always Output Response", "Will
                                                 "false");
 core::Property InvokeHTTP::PenalizeOnNoRetry("Penalize on \"No Retry\"", "Enabling this property will penalize FlowFiles that are routed to the \"No Retry\" relationship.", "false");
 
+core::Property InvokeHTTP::MaxConcurrentRequests(
+    core::PropertyBuilder::createProperty("Max Concurrent Requests")->withDescription("The number of requests a single task keeps in flight. The requests of a task are "
+                                                                                      "performed without blocking a thread each and their FlowFiles are routed as the "
+                                                                                      "responses arrive.")
+        ->isRequired(false)->withDefaultValue<uint64_t>(1)->build());
+
+core::Property InvokeHTTP::UseHTTP2(
+    core::PropertyBuilder::createProperty("Use HTTP/2")->withDescription("Negotiates HTTP/2 with https endpoints, so that the concurrent requests to a host are "
+                                                                         "multiplexed over a single connection.")
+        ->isRequired(false)->withDefaultValue<bool>(false)->build());
+
 core::Property InvokeHTTP::DisablePeerVerification("Disable Peer Verification", "Disables peer verification for the SSL session", "false");
 const char* InvokeHTTP::STATUS_CODE = "invokehttp.status.code";
 const char* InvokeHTTP::STATUS_MESSAGE = "invokehttp.status.message";
@@ -150,6 +162,8 @@ void InvokeHTTP::initialize() {
   properties.insert(SendBody);
   properties.insert(DisablePeerVerification);
   properties.insert(AlwaysOutputResponse);
+  properties.insert(MaxConcurrentRequests);
+  properties.insert(UseHTTP2);
 
   setSupportedProperties(properties);
   // Set the supported relationships
@@ -245,6 +259,24 @@ void InvokeHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context
   if (context->getProperty(DisablePeerVerification.getName(), disablePeerVerification)) {
     utils::StringUtils::StringToBool(disablePeerVerification, disable_peer_verification_);
   }
+
+  uint64_t max_concurrent_requests = 1;
+  if (context->getProperty(MaxConcurrentRequests.getName(), max_concurrent_requests)) {
+    max_concurrent_requests_ = (std::max)(max_concurrent_requests, static_cast<uint64_t>(1));
+  }
+  context->getProperty(UseHTTP2.getName(), use_http2_);
+
+  // the connections of the previous schedule may belong to a different endpoint
+  client_pool_.clear();
+  client_pool_.setMaxIdleClients((std::max)(getMaxConcurrentTasks(), static_cast<uint8_t>(1)) * max_concurrent_requests_);
+  std::lock_guard<std::mutex> lock(multi_client_mutex_);
+  idle_multi_clients_.clear();
+}
+
+void InvokeHTTP::onUnSchedule() {
+  client_pool_.clear();
+  std::lock_guard<std::mutex> lock(multi_client_mutex_);
+  idle_multi_clients_.clear();
 }
 
 InvokeHTTP::~InvokeHTTP() = default;
@@ -260,9 +292,12 @@ bool InvokeHTTP::emitFlowFile(const std::string &method) {
 }
 
 void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
-  std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(session->get());
+  if (max_concurrent_requests_ > 1) {
+    onTriggerConcurrently(context, session);
+    return;
+  }
 
-  std::string url = url_;
+  std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(session->get());
 
   if (flowFile == nullptr) {
     if (!emitFlowFile(method_)) {
@@ -278,12 +313,60 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
 
   logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, url_);
 
+  auto request = createRequest(flowFile, context, session);
+  logger_->log_trace("InvokeHTTP -- curl performed");
+  const bool submitted = request->client->submit();
+  onResponse(*request, submitted, context, session);
+}
+
+void InvokeHTTP::onTriggerConcurrently(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+  // declared first, so that the requests outlive the multi client when an exception leaves them running
+  std::map<utils::HTTPClient*, std::unique_ptr<Request>> running;
+  std::unique_ptr<utils::HTTPMultiClient> multi_client = acquireMultiClient();
+
+  for (size_t i = 0; i < max_concurrent_requests_; ++i) {
+    std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(session->get());
+    if (flowFile == nullptr) {
+      if (i > 0 || emitFlowFile(method_)) {
+        break;
+      }
+      flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
+    }
+    auto request = createRequest(flowFile, context, session);
+    if (!multi_client->add(request->client.get())) {
+      onResponse(*request, false, context, session);
+      continue;
+    }
+    running[request->client.get()] = std::move(request);
+  }
+  logger_->log_debug("InvokeHTTP -- %d requests to %s in flight", running.size(), url_);
+
+  // the flow files are routed as their responses arrive
+  while (!running.empty()) {
+    for (const auto &completed : multi_client->perform(std::chrono::milliseconds(100))) {
+      auto request = running.find(completed.first);
+      if (request == running.end()) {
+        continue;
+      }
+      onResponse(*request->second, completed.second, context, session);
+      running.erase(request);
+    }
+  }
+  releaseMultiClient(std::move(multi_client));
+}
+
+std::unique_ptr<InvokeHTTP::Request> InvokeHTTP::createRequest(const std::shared_ptr<FlowFileRecord> &flowFile, const std::shared_ptr<core::ProcessContext> &context,
+                                                                const std::shared_ptr<core::ProcessSession> &session) {
+  std::unique_ptr<Request> request(new Request());
+  request->flow_file = flowFile;
   // create a transaction id
-  std::string tx_id = generateId();
+  request->tx_id = generateId();
 
-  utils::HTTPClient client(url_, ssl_context_service_);
+  // a pooled client reuses the connection of an earlier request to the same host
+  request->client = client_pool_.acquire();
+  utils::HTTPClient &client = *request->client;
 
-  client.initialize(method_);
+  client.initialize(method_, url_, ssl_context_service_);
   client.setConnectionTimeout(connect_timeout_ms_);
   client.setReadTimeout(read_timeout_ms_);
 
@@ -300,22 +383,24 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     client.setDisablePeerVerification();
   }
 
-  std::unique_ptr<utils::ByteInputCallBack> callback = nullptr;
-  std::unique_ptr<utils::HTTPUploadCallback> callbackObj = nullptr;
+  if (use_http2_ && !client.setUseHTTP2()) {
+    logger_->log_debug("HTTP/2 is not supported by the curl library");
+  }
+
   if (emitFlowFile(method_)) {
     logger_->log_trace("InvokeHTTP -- reading flowfile");
     std::shared_ptr<ResourceClaim> claim = flowFile->getResourceClaim();
     if (claim) {
-      callback = std::unique_ptr<utils::ByteInputCallBack>(new utils::ByteInputCallBack());
-      session->read(flowFile, callback.get());
-      callbackObj = std::unique_ptr<utils::HTTPUploadCallback>(new utils::HTTPUploadCallback);
-      callbackObj->ptr = callback.get();
-      callbackObj->pos = 0;
-      logger_->log_trace("InvokeHTTP -- Setting callback, size is %d", callback->getBufferSize());
+      request->content = std::unique_ptr<utils::ByteInputCallBack>(new utils::ByteInputCallBack());
+      session->read(flowFile, request->content.get());
+      request->upload = std::unique_ptr<utils::HTTPUploadCallback>(new utils::HTTPUploadCallback);
+      request->upload->ptr = request->content.get();
+      request->upload->pos = 0;
+      logger_->log_trace("InvokeHTTP -- Setting callback, size is %d", request->content->getBufferSize());
       if (!use_chunked_encoding_) {
         client.appendHeader("Content-Length", std::to_string(flowFile->getSize()));
       }
-      client.setUploadCallback(callbackObj.get());
+      client.setUploadCallback(request->upload.get());
     } else {
       logger_->log_error("InvokeHTTP -- no resource claim");
     }
@@ -324,15 +409,37 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     logger_->log_trace("InvokeHTTP -- Not emitting flowfile to HTTP Server");
   }
 
+  if (IsNullOrEmpty(put_attribute_name_)) {
+    // the body is written into the content repository, which owns it once it becomes the content of the response flow file
+    Request *pending = request.get();
+    pending->content_repository = context->getContentRepository();
+    client.setResponseStream([pending]() -> io::BaseStream* {
+      auto claim = std::make_shared<ResourceClaim>(pending->content_repository);
+      claim->increaseFlowFileRecordOwnedCount();
+      pending->response_stream = pending->content_repository->write(claim);
+      if (pending->response_stream == nullptr) {
+        claim->decreaseFlowFileRecordOwnedCount();
+        return nullptr;
+      }
+      pending->response_claim = claim;
+      return pending->response_stream.get();
+    });
+  }
+
   // append all headers
   client.build_header_list(attribute_to_send_regex_, flowFile->getAttributes());
+  return request;
+}
 
-  logger_->log_trace("InvokeHTTP -- curl performed");
-  if (client.submit()) {
+void InvokeHTTP::onResponse(Request &request, bool submitted, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+  std::shared_ptr<FlowFileRecord> &flowFile = request.flow_file;
+  utils::HTTPClient &client = *request.client;
+  if (submitted) {
     logger_->log_trace("InvokeHTTP -- curl successful");
 
     bool putToAttribute = !IsNullOrEmpty(put_attribute_name_);
 
+    // the body of a successful response is in the response stream, when there is one
     const std::vector<char> &response_body = client.getResponseBody();
     const std::vector<std::string> &response_headers = client.getHeaders();
 
@@ -342,7 +449,7 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     if (!response_headers.empty())
       flowFile->addAttribute(STATUS_MESSAGE, response_headers.at(0));
     flowFile->addAttribute(REQUEST_URL, url_);
-    flowFile->addAttribute(TRANSACTION_ID, tx_id);
+    flowFile->addAttribute(TRANSACTION_ID, request.tx_id);
 
     bool isSuccess = ((int32_t) (http_code / 100)) == 2;
     bool output_body_to_content = isSuccess && !putToAttribute;
@@ -363,17 +470,44 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
       response_flow->addAttribute(STATUS_CODE, std::to_string(http_code));
       if (!response_headers.empty())
         response_flow->addAttribute(STATUS_MESSAGE, response_headers.at(0));
-      response_flow->addAttribute(REQUEST_URL, url);
-      response_flow->addAttribute(TRANSACTION_ID, tx_id);
-      io::DataStream stream((const uint8_t*) response_body.data(), response_body.size());
-      // need an import from the data stream.
-      session->importFrom(stream, response_flow);
+      response_flow->addAttribute(REQUEST_URL, url_);
+      response_flow->addAttribute(TRANSACTION_ID, request.tx_id);
+      if (request.response_claim != nullptr) {
+        response_flow->setSize(request.response_stream->getSize());
+        response_flow->setOffset(0);
+        request.response_stream->closeStream();
+        response_flow->setResourceClaim(request.response_claim);
+        // the response flow file took over the ownership of the claim
+        request.response_claim = nullptr;
+      } else {
+        io::DataStream stream((const uint8_t*) response_body.data(), response_body.size());
+        // need an import from the data stream.
+        session->importFrom(stream, response_flow);
+      }
     }
     route(flowFile, response_flow, session, context, isSuccess, http_code);
   } else {
     session->penalize(flowFile);
     session->transfer(flowFile, RelFailure);
   }
+  client_pool_.release(std::move(request.client));
+}
+
+std::unique_ptr<utils::HTTPMultiClient> InvokeHTTP::acquireMultiClient() {
+  {
+    std::lock_guard<std::mutex> lock(multi_client_mutex_);
+    if (!idle_multi_clients_.empty()) {
+      auto multi_client = std::move(idle_multi_clients_.back());
+      idle_multi_clients_.pop_back();
+      return multi_client;
+    }
+  }
+  return std::unique_ptr<utils::HTTPMultiClient>(new utils::HTTPMultiClient(use_http2_));
+}
+
+void InvokeHTTP::releaseMultiClient(std::unique_ptr<utils::HTTPMultiClient> multi_client) {
+  std::lock_guard<std::mutex> lock(multi_client_mutex_);
+  idle_multi_clients_.push_back(std::move(multi_client));
 }
 
 void InvokeHTTP::route(std::shared_ptr<FlowFileRecord> &request, std::shared_ptr<FlowFileRecord> &response, const std::shared_ptr<core::ProcessSession> &session,
@@ -20,7 +20,9 @@
 #define __INVOKE_HTTP_H__
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <curl/curl.h>
 #include "utils/ByteArrayCallback.h"
@@ -34,6 +36,8 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/Id.h"
 #include "../client/HTTPClient.h"
+#include "../client/HTTPClientPool.h"
+#include "../client/HTTPMultiClient.h"
 
 namespace org {
 namespace apache {
@@ -80,6 +84,10 @@ class InvokeHTTP : public core::Processor {
 
   static core::Property PenalizeOnNoRetry;
 
+  static core::Property MaxConcurrentRequests;
+
+  static core::Property UseHTTP2;
+
   static const char* STATUS_CODE;
   static const char* STATUS_MESSAGE;
   static const char* RESPONSE_BODY;
@@ -98,6 +106,7 @@ class InvokeHTTP : public core::Processor {
   virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
   virtual void initialize() override;
   virtual void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
+  virtual void onUnSchedule() override;
   /**
    * Provides a reference to the URL.
    */
@@ -106,6 +115,50 @@ class InvokeHTTP : public core::Processor {
   }
 
  protected:
+  /**
+   * A request and what has to live until its response arrives.
+   */
+  struct Request {
+    std::shared_ptr<FlowFileRecord> flow_file;
+    std::string tx_id;
+    std::unique_ptr<utils::HTTPClient> client;
+    std::unique_ptr<utils::ByteInputCallBack> content;
+    std::unique_ptr<utils::HTTPUploadCallback> upload;
+    // the body of a successful response is written to this claim, which is created with its first chunk
+    std::shared_ptr<core::ContentRepository> content_repository;
+    std::shared_ptr<ResourceClaim> response_claim;
+    std::shared_ptr<io::BaseStream> response_stream;
+
+    ~Request() {
+      if (response_claim != nullptr) {
+        // the body did not become the content of a flow file
+        response_stream->closeStream();
+        response_claim->decreaseFlowFileRecordOwnedCount();
+        content_repository->removeIfOrphaned(response_claim);
+      }
+    }
+  };
+
+  /**
+   * Performs up to Max Concurrent Requests requests at once from the calling thread.
+   */
+  void onTriggerConcurrently(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
+
+  /**
+   * Sets up the request for the flow file with a pooled client.
+   */
+  std::unique_ptr<Request> createRequest(const std::shared_ptr<FlowFileRecord> &flowFile, const std::shared_ptr<core::ProcessContext> &context,
+                                         const std::shared_ptr<core::ProcessSession> &session);
+
+  /**
+   * Routes the flow file of a finished request and returns its client to the pool.
+   * @param submitted whether the request got a response
+   */
+  void onResponse(Request &request, bool submitted, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
+
+  std::unique_ptr<utils::HTTPMultiClient> acquireMultiClient();
+
+  void releaseMultiClient(std::unique_ptr<utils::HTTPMultiClient> multi_client);
 
   /**
    * Generate a transaction ID
@@ -157,6 +210,15 @@ class InvokeHTTP : public core::Processor {
   bool penalize_no_retry_{false};
   // disable peer verification ( makes susceptible for MITM attacks )
   bool disable_peer_verification_{false};
+  // number of requests a task keeps in flight
+  uint64_t max_concurrent_requests_{1};
+  // negotiate HTTP/2
+  bool use_http2_{false};
+  // idle clients with their kept alive connections
+  utils::HTTPClientPool client_pool_;
+  // the multi clients keep the connections of the concurrent requests
+  std::mutex multi_client_mutex_;
+  std::vector<std::unique_ptr<utils::HTTPMultiClient>> idle_multi_clients_;
  private:
   std::shared_ptr<logging::Logger> logger_{logging::LoggerFactory<InvokeHTTP>::getLogger()};
 };
@@ -55,6 +55,7 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
   uri << getBaseURI() << "data-transfer/" << dir_str << "/" << getPortId() << "/transactions";
   auto client = create_http_client(uri.str(), "POST");
   client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+  client->appendHeader(USE_COMPRESSION_HEADER, use_compression_ ? "true" : "false");
   client->setConnectionTimeout(std::chrono::milliseconds(5000));
   client->setContentType("application/json");
   client->appendHeader("Accept: application/json");
@@ -89,6 +90,7 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
         }
 
         client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+        client->appendHeader(USE_COMPRESSION_HEADER, use_compression_ ? "true" : "false");
         peer_->setStream(std::unique_ptr<io::DataStream>(new io::HttpStream(client)));
         transactionID = transaction->getUUIDStr();
         logger_->log_debug("Created transaction id -%s-", transactionID);
@@ -22,12 +22,17 @@
 #include <utility>
 #include <string>
 #include <set>
+#include <thread>
+#include <chrono>
 #include "FlowController.h"
 #include "io/BaseStream.h"
+#include "io/BufferedFileStream.h"
 #include "TestBase.h"
 #include "processors/GetFile.h"
 #include "core/Core.h"
 #include "client/HTTPClient.h"
+#include "client/HTTPClientPool.h"
+#include "client/HTTPMultiClient.h"
 #include "CivetServer.h"
 
 TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
@@ -93,3 +98,177 @@ TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
 
   LogTestController::getInstance().reset();
 }
+
+TEST_CASE("HTTPClientPoolReusesConnections", "[basic]") {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      mg_printf(conn, "HTTP/1.1 200 OK\r\n");
+      mg_printf(conn, "Content-Type: text/plain\r\n");
+      mg_printf(conn, "Content-Length: 5\r\n");
+      mg_printf(conn, "\r\n");
+      mg_printf(conn, "hello");
+      return true;
+    }
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("enable_keep_alive");
+  options.emplace_back("yes");
+  options.emplace_back("keep_alive_timeout_ms");
+  options.emplace_back("15000");
+  options.emplace_back("num_threads");
+  options.emplace_back("1");
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string port = std::to_string(server.getListeningPorts().at(0));
+
+  utils::HTTPClientPool pool(1);
+  CURLSH* share = nullptr;
+  for (int i = 0; i < 3; ++i) {
+    auto client = pool.acquire();
+    // the reused client keeps the DNS and TLS session caches of the pool
+    if (i == 0) {
+      share = client->getShare();
+      REQUIRE(share != nullptr);
+    }
+    REQUIRE(client->getShare() == share);
+    client->initialize("GET", "http://localhost:" + port + "/request" + std::to_string(i));
+    REQUIRE(client->submit());
+    REQUIRE(client->getResponseCode() == 200);
+    const std::vector<char>& response = client->getResponseBody();
+    REQUIRE("hello" == std::string(response.begin(), response.end()));
+    // only the first request opens a connection
+    REQUIRE(client->getNewConnectionCount() == (i == 0 ? 1 : 0));
+    pool.release(std::move(client));
+    REQUIRE(pool.getIdleCount() == 1);
+  }
+
+  pool.clear();
+  REQUIRE(pool.getIdleCount() == 0);
+}
+
+TEST_CASE("HTTPMultiClientPerformsConcurrentRequests", "[basic]") {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      // the requests only finish in time if they wait for their responses at the same time
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      const std::string body = mg_get_request_info(conn)->local_uri;
+      mg_printf(conn, "HTTP/1.1 200 OK\r\n");
+      mg_printf(conn, "Content-Length: %d\r\n", static_cast<int>(body.size()));
+      mg_printf(conn, "\r\n");
+      mg_printf(conn, "%s", body.c_str());
+      return true;
+    }
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("num_threads");
+  options.emplace_back("8");
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string port = std::to_string(server.getListeningPorts().at(0));
+
+  utils::HTTPMultiClient multi_client;
+  std::vector<std::unique_ptr<utils::HTTPClient>> clients;
+  for (int i = 0; i < 8; ++i) {
+    clients.emplace_back(new utils::HTTPClient());
+    clients.back()->initialize("GET", "http://localhost:" + port + "/request" + std::to_string(i));
+    REQUIRE(multi_client.add(clients.back().get()));
+  }
+  REQUIRE(multi_client.getActiveCount() == 8);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::set<utils::HTTPClient*> completed;
+  while (multi_client.getActiveCount() > 0) {
+    for (const auto &result : multi_client.perform(std::chrono::milliseconds(100))) {
+      REQUIRE(result.second);
+      completed.insert(result.first);
+    }
+  }
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(3));
+
+  REQUIRE(completed.size() == 8);
+  for (int i = 0; i < 8; ++i) {
+    REQUIRE(clients[i]->getResponseCode() == 200);
+    const std::vector<char>& response = clients[i]->getResponseBody();
+    REQUIRE("/request" + std::to_string(i) == std::string(response.begin(), response.end()));
+  }
+}
+
+TEST_CASE("HTTPClientStreamsSuccessfulResponses", "[basic]") {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      const std::string uri = mg_get_request_info(conn)->local_uri;
+      if (uri == "/missing") {
+        mg_printf(conn, "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found");
+        return true;
+      }
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+      const std::string chunk(64 * 1024, 'x');
+      for (int i = 0; i < 64; ++i) {
+        mg_send_chunk(conn, chunk.data(), chunk.size());
+      }
+      mg_send_chunk(conn, nullptr, 0U);
+      return true;
+    }
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string port = std::to_string(server.getListeningPorts().at(0));
+
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  const std::string path = testController.createTempDirectory(format) + "/response";
+
+  {
+    minifi::io::BufferedFileStream stream(path);
+    utils::HTTPClient client;
+    client.initialize("GET", "http://localhost:" + port + "/download");
+    client.setResponseStream(&stream);
+    REQUIRE(client.submit());
+    REQUIRE(client.getResponseCode() == 200);
+    REQUIRE(client.getResponseBody().empty());
+    REQUIRE(stream.getSize() == 64 * 64 * 1024);
+  }
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  REQUIRE(file.tellg() == 64 * 64 * 1024);
+
+  minifi::io::BufferedFileStream stream(path);
+  utils::HTTPClient client;
+  client.initialize("GET", "http://localhost:" + port + "/missing");
+  client.setResponseStream(&stream);
+  REQUIRE(client.submit());
+  REQUIRE(client.getResponseCode() == 404);
+  const std::vector<char>& response = client.getResponseBody();
+  REQUIRE("not found" == std::string(response.begin(), response.end()));
+  REQUIRE(stream.getSize() == 0);
+
+  // a lazily opened stream is not even created without a successful body
+  bool opened = false;
+  utils::HTTPClient lazy_client;
+  lazy_client.initialize("GET", "http://localhost:" + port + "/missing");
+  lazy_client.setResponseStream([&opened, &stream]() -> minifi::io::BaseStream* {
+    opened = true;
+    return &stream;
+  });
+  REQUIRE(lazy_client.submit());
+  REQUIRE(lazy_client.getResponseCode() == 404);
+  REQUIRE_FALSE(opened);
+}
@@ -0,0 +1,473 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ConsumeKafka.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "utils/StringUtils.h"
+#include "utils/GeneralUtils.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSession.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace processors {
+
+const core::Property ConsumeKafka::SeedBrokers(
+    core::PropertyBuilder::createProperty("Known Brokers")->withDescription("A comma-separated list of known Kafka Brokers in the format <host>:<port>")
+        ->isRequired(true)->supportsExpressionLanguage(true)->build());
+
+const core::Property ConsumeKafka::TopicNames(
+    core::PropertyBuilder::createProperty("Topic Names")->withDescription("A comma-separated list of the Kafka Topics to consume from")
+        ->isRequired(true)->supportsExpressionLanguage(true)->build());
+
+const core::Property ConsumeKafka::GroupID(
+    core::PropertyBuilder::createProperty("Group ID")->withDescription("The consumer group the processor consumes as, the partitions of the topics are shared among its members")
+        ->isRequired(true)->supportsExpressionLanguage(true)->build());
+
+const core::Property ConsumeKafka::ClientName(
+    core::PropertyBuilder::createProperty("Client Name")->withDescription("Client Name to use when communicating with Kafka")
+        ->isRequired(false)->supportsExpressionLanguage(true)->build());
+
+const core::Property ConsumeKafka::OffsetReset(
+    core::PropertyBuilder::createProperty("Offset Reset")
+        ->withDescription("Where to start consuming when the group has no committed offset for a partition: at the earliest or the latest available message, "
+                          "or fail for none")
+        ->isRequired(false)
+        ->withAllowableValues<std::string>({OFFSET_RESET_EARLIEST, OFFSET_RESET_LATEST, OFFSET_RESET_NONE})
+        ->withDefaultValue(OFFSET_RESET_LATEST)->build());
+
+const core::Property ConsumeKafka::MessageDemarcator(
+    core::PropertyBuilder::createProperty("Message Demarcator")
+        ->withDescription("If set, the messages received from the same partition in a poll are written into a single FlowFile, separated by this string. "
+                          "Otherwise each message becomes a FlowFile.")
+        ->isRequired(false)->build());
+
+const core::Property ConsumeKafka::MaxPollRecords(
+    core::PropertyBuilder::createProperty("Max Poll Records")->withDescription("Maximum number of messages consumed in a single session")
+        ->isRequired(false)->withDefaultValue<uint64_t>(10000)->build());
+
+const core::Property ConsumeKafka::MaxPollTime(
+    core::PropertyBuilder::createProperty("Max Poll Time")->withDescription("Maximum time to wait for messages to accumulate before the received ones are written")
+        ->isRequired(false)->withDefaultValue<core::TimePeriodValue>("1 sec")->build());
+
+const core::Relationship ConsumeKafka::Success("success", "All FlowFiles created from Kafka messages are routed to this Relationship");
+
+namespace {
+struct rd_kafka_topic_partition_list_deleter {
+  void operator()(rd_kafka_topic_partition_list_t* p) const noexcept { rd_kafka_topic_partition_list_destroy(p); }
+};
+
+const char *PREFIX_ERROR_MSG = "ConsumeKafka: configure error result: ";
+
+void setKafkaConfiguration(rd_kafka_conf_t *conf, const std::string &name, const std::string &value) {
+  std::array<char, 512U> errstr{};
+  if (rd_kafka_conf_set(conf, name.c_str(), value.c_str(), errstr.data(), errstr.size()) != RD_KAFKA_CONF_OK) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, utils::StringUtils::join_pack(PREFIX_ERROR_MSG, errstr.data()));
+  }
+}
+
+std::string getTopicName(const rd_kafka_message_t *message) {
+  return rd_kafka_topic_name(message->rkt);
+}
+}  // namespace
+
+ConsumeKafka::~ConsumeKafka() {
+  std::lock_guard<std::mutex> lock(consumer_mutex_);
+  closeConsumer();
+}
+
+void ConsumeKafka::initialize() {
+  // Set the supported properties
+  std::set<core::Property> properties;
+  properties.insert(SeedBrokers);
+  properties.insert(TopicNames);
+  properties.insert(GroupID);
+  properties.insert(ClientName);
+  properties.insert(OffsetReset);
+  properties.insert(MessageDemarcator);
+  properties.insert(MaxPollRecords);
+  properties.insert(MaxPollTime);
+  setSupportedProperties(properties);
+  // Set the supported relationships
+  std::set<core::Relationship> relationships;
+  relationships.insert(Success);
+  setSupportedRelationships(relationships);
+}
+
+void ConsumeKafka::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  std::lock_guard<std::mutex> lock(consumer_mutex_);
+  closeConsumer();
+
+  std::string brokers, topics, group_id, client_id;
+  if (!context->getProperty(SeedBrokers.getName(), brokers) || brokers.empty()) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Known Brokers property missing or invalid");
+  }
+  if (!context->getProperty(TopicNames.getName(), topics) || topics.empty()) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Topic Names property missing or invalid");
+  }
+  if (!context->getProperty(GroupID.getName(), group_id) || group_id.empty()) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Group ID property missing or invalid");
+  }
+  context->getProperty(ClientName.getName(), client_id);
+
+  topic_names_.clear();
+  for (const auto &topic : utils::StringUtils::split(topics, ",")) {
+    const auto topic_name = utils::StringUtils::trim(topic);
+    if (!topic_name.empty()) {
+      topic_names_.push_back(topic_name);
+    }
+  }
+  if (topic_names_.empty()) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Topic Names property does not name any topic");
+  }
+
+  demarcator_.clear();
+  context->getProperty(MessageDemarcator.getName(), demarcator_);
+
+  context->getProperty(MaxPollRecords.getName(), max_poll_records_);
+  max_poll_records_ = (std::max)(max_poll_records_, uint64_t{1});
+  batch_.resize(max_poll_records_);
+
+  std::string value;
+  int64_t valInt;
+  core::TimeUnit unit;
+  if (context->getProperty(MaxPollTime.getName(), value) && core::Property::StringToTime(value, valInt, unit) && core::Property::ConvertTimeUnitToMS(valInt, unit, valInt)) {
+    max_poll_time_ms_ = valInt;
+  }
+  logger_->log_debug("ConsumeKafka: Max Poll Records [%llu], Max Poll Time [%lld ms]", max_poll_records_, max_poll_time_ms_);
+
+  key_.brokers_ = brokers;
+  // the client id only tells the connections of the agent apart, the group has to be unique anyway
+  key_.client_id_ = client_id.empty() ? group_id : client_id;
+
+  conn_ = utils::make_unique<KafkaConnection>(key_);
+  configureNewConnection(context);
+
+  logger_->log_debug("Successfully configured ConsumeKafka");
+}
+
+std::unique_ptr<rd_kafka_conf_t, ConsumeKafka::rd_kafka_conf_deleter> ConsumeKafka::createConfiguration(const std::shared_ptr<core::ProcessContext> &context) {
+  std::unique_ptr<rd_kafka_conf_t, rd_kafka_conf_deleter> conf{ rd_kafka_conf_new() };
+  if (conf == nullptr) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Failed to create rd_kafka_conf_t object");
+  }
+
+  setKafkaConfiguration(conf.get(), "bootstrap.servers", key_.brokers_);
+  logger_->log_debug("ConsumeKafka: bootstrap.servers [%s]", key_.brokers_);
+
+  std::string value;
+  if (context->getProperty(ClientName.getName(), value) && !value.empty()) {
+    setKafkaConfiguration(conf.get(), "client.id", value);
+    logger_->log_debug("ConsumeKafka: client.id [%s]", value);
+  }
+
+  value = "";
+  context->getProperty(GroupID.getName(), value);
+  setKafkaConfiguration(conf.get(), "group.id", value);
+  logger_->log_debug("ConsumeKafka: group.id [%s]", value);
+
+  value = "";
+  if (context->getProperty(OffsetReset.getName(), value) && !value.empty()) {
+    setKafkaConfiguration(conf.get(), "auto.offset.reset", value == OFFSET_RESET_NONE ? "error" : value);
+    logger_->log_debug("ConsumeKafka: auto.offset.reset [%s]", value);
+  }
+
+  // Add all of the dynamic properties as librdkafka configurations
+  const auto &dynamic_prop_keys = context->getDynamicPropertyKeys();
+  logger_->log_info("ConsumeKafka registering %d librdkafka dynamic properties", dynamic_prop_keys.size());
+
+  for (const auto &prop_key : dynamic_prop_keys) {
+    value = "";
+    if (context->getDynamicProperty(prop_key, value) && !value.empty()) {
+      logger_->log_debug("ConsumeKafka: DynamicProperty: [%s] -> [%s]", prop_key, value);
+      setKafkaConfiguration(conf.get(), prop_key, value);
+    } else {
+      logger_->log_warn("ConsumeKafka Dynamic Property '%s' is empty and therefore will not be configured", prop_key);
+    }
+  }
+
+  // offsets are committed by onTrigger once the FlowFiles are safe, this overrides the dynamic properties
+  setKafkaConfiguration(conf.get(), "enable.auto.commit", "false");
+
+  rd_kafka_conf_set_offset_commit_cb(conf.get(), &ConsumeKafka::offsetCommitCallback);
+  rd_kafka_conf_set_log_cb(conf.get(), &KafkaConnection::logCallback);
+  return conf;
+}
+
+void ConsumeKafka::configureNewConnection(const std::shared_ptr<core::ProcessContext> &context) {
+  std::array<char, 512U> errstr{};
+  auto conf = createConfiguration(context);
+
+  // The consumer takes ownership of the configuration, we must not free it
+  gsl::owner<rd_kafka_t*> consumer = rd_kafka_new(RD_KAFKA_CONSUMER, conf.release(), errstr.data(), errstr.size());
+  if (consumer == nullptr) {
+    auto error_msg = utils::StringUtils::join_pack("Failed to create Kafka consumer ", errstr.data());
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, error_msg);
+  }
+
+  conn_->setConnection(consumer);
+
+  std::unique_ptr<rd_kafka_topic_partition_list_t, rd_kafka_topic_partition_list_deleter> subscription{ rd_kafka_topic_partition_list_new(topic_names_.size()) };
+  for (const auto &topic_name : topic_names_) {
+    rd_kafka_topic_partition_list_add(subscription.get(), topic_name.c_str(), RD_KAFKA_PARTITION_UA);
+  }
+  const auto err = rd_kafka_subscribe(consumer, subscription.get());
+  if (err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+    auto error_msg = utils::StringUtils::join_pack("Failed to subscribe to the Kafka topics: ", rd_kafka_err2str(err));
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, error_msg);
+  }
+
+  queue_ = rd_kafka_queue_get_consumer(consumer);
+  if (queue_ == nullptr) {
+    throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Failed to get the queue of the Kafka consumer");
+  }
+}
+
+void ConsumeKafka::notifyStop() {
+  logger_->log_debug("notifyStop called");
+  std::lock_guard<std::mutex> lock(consumer_mutex_);
+  closeConsumer();
+}
+
+void ConsumeKafka::closeConsumer() {
+  if (queue_) {
+    rd_kafka_queue_destroy(queue_);
+    queue_ = nullptr;
+  }
+  if (conn_ && conn_->getConnection()) {
+    // leaves the group, so that its partitions are reassigned right away
+    rd_kafka_consumer_close(conn_->getConnection());
+  }
+  conn_.reset();
+  uncommitted_offsets_.clear();
+}
+
+void ConsumeKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  std::lock_guard<std::mutex> lock(consumer_mutex_);
+  if (!queue_) {
+    logger_->log_error("ConsumeKafka is not connected to Kafka");
+    context->yield();
+    return;
+  }
+
+  auto session = sessionFactory->createSession();
+  try {
+    onTrigger(context, session);
+    session->commit();
+  } catch (std::exception &exception) {
+    logger_->log_warn("Caught Exception %s during ConsumeKafka::onTrigger of processor: %s (%s)", exception.what(), getUUIDStr(), getName());
+    session->rollback();
+    rewind();
+    throw;
+  } catch (...) {
+    logger_->log_warn("Caught Exception during ConsumeKafka::onTrigger of processor: %s (%s)", getUUIDStr(), getName());
+    session->rollback();
+    rewind();
+    throw;
+  }
+  commitOffsets();
+}
+
+void ConsumeKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+  std::vector<rd_kafka_message_unique_ptr> messages;
+  poll(messages);
+  if (messages.empty()) {
+    return;
+  }
+  logger_->log_debug("ConsumeKafka received %zu messages", messages.size());
+
+  std::vector<std::pair<size_t, size_t>> ranges;
+  if (!demarcator_.empty()) {
+    ranges = groupByPartition(messages);
+  } else {
+    ranges.reserve(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+      ranges.emplace_back(i, i + 1);
+    }
+  }
+
+  for (const auto &range : ranges) {
+    const size_t begin = range.first;
+    const size_t end = range.second;
+    const rd_kafka_message_t *first = messages[begin].get();
+
+    auto flow_file = session->create();
+    WriteCallback callback(messages, begin, end, demarcator_);
+    session->write(flow_file, &callback);
+    session->putAttribute(flow_file, "kafka.topic", getTopicName(first));
+    session->putAttribute(flow_file, "kafka.partition", std::to_string(first->partition));
+    session->putAttribute(flow_file, "kafka.offset", std::to_string(first->offset));
+    if (end - begin > 1) {
+      session->putAttribute(flow_file, "kafka.count", std::to_string(end - begin));
+    } else if (first->key != nullptr) {
+      session->putAttribute(flow_file, "kafka.key", std::string(static_cast<const char*>(first->key), first->key_len));
+    }
+    session->transfer(flow_file, Success);
+  }
+}
+
+std::vector<std::pair<size_t, size_t>> ConsumeKafka::groupByPartition(std::vector<rd_kafka_message_unique_ptr> &messages) {
+  // the queue interleaves the partitions
+  std::stable_sort(messages.begin(), messages.end(), [](const rd_kafka_message_unique_ptr &lhs, const rd_kafka_message_unique_ptr &rhs) {
+    const int topic_order = lhs->rkt == rhs->rkt ? 0 : std::strcmp(rd_kafka_topic_name(lhs->rkt), rd_kafka_topic_name(rhs->rkt));
+    return topic_order < 0 || (topic_order == 0 && lhs->partition < rhs->partition);
+  });
+  const auto same_partition = [](const rd_kafka_message_unique_ptr &lhs, const rd_kafka_message_unique_ptr &rhs) {
+    return lhs->partition == rhs->partition && (lhs->rkt == rhs->rkt || getTopicName(lhs.get()) == getTopicName(rhs.get()));
+  };
+
+  std::vector<std::pair<size_t, size_t>> ranges;
+  for (size_t begin = 0, end = 0; begin < messages.size(); begin = end) {
+    end = begin + 1;
+    while (end < messages.size() && same_partition(messages[begin], messages[end])) {
+      ++end;
+    }
+    ranges.emplace_back(begin, end);
+  }
+  return ranges;
+}
+
+void ConsumeKafka::poll(std::vector<rd_kafka_message_unique_ptr> &messages) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(max_poll_time_ms_);
+  while (messages.size() < max_poll_records_) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    // waits until the batch is full or the time is up
+    const auto result = rd_kafka_consume_batch_queue(queue_, static_cast<int>((std::max)(remaining, int64_t{0})), batch_.data(), max_poll_records_ - messages.size());
+    if (result < 0) {
+      logger_->log_error("ConsumeKafka failed to consume messages: %s", rd_kafka_err2str(rd_kafka_last_error()));
+      break;
+    }
+    const size_t count = static_cast<size_t>(result);
+    for (size_t i = 0; i < count; ++i) {
+      rd_kafka_message_unique_ptr message{ batch_[i] };
+      if (message->err == RD_KAFKA_RESP_ERR__PARTITION_EOF) {
+        continue;
+      }
+      if (message->err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        logger_->log_error("ConsumeKafka received an error from Kafka: %s", rd_kafka_message_errstr(message.get()));
+        continue;
+      }
+      const TopicPartition topic_partition(getTopicName(message.get()), message->partition);
+      auto offsets = uncommitted_offsets_.find(topic_partition);
+      if (offsets == uncommitted_offsets_.end()) {
+        uncommitted_offsets_.emplace(topic_partition, PartitionOffsets{message->offset, message->offset + 1});
+      } else {
+        offsets->second.next = message->offset + 1;
+      }
+      messages.push_back(std::move(message));
+    }
+    if (count == 0 || remaining <= 0) {
+      break;
+    }
+  }
+}
+
+void ConsumeKafka::commitOffsets() {
+  if (uncommitted_offsets_.empty() || !conn_) {
+    return;
+  }
+  std::unique_ptr<rd_kafka_topic_partition_list_t, rd_kafka_topic_partition_list_deleter> offsets{ rd_kafka_topic_partition_list_new(uncommitted_offsets_.size()) };
+  for (const auto &partition : uncommitted_offsets_) {
+    rd_kafka_topic_partition_list_add(offsets.get(), partition.first.first.c_str(), partition.first.second)->offset = partition.second.next;
+  }
+  uncommitted_offsets_.clear();
+  // the result is reported to offsetCommitCallback. The consumer goes on from its position either way, a failed
+  // commit only means that the messages are delivered again to whoever consumes the partition after a restart or
+  // a rebalance.
+  const auto err = rd_kafka_commit(conn_->getConnection(), offsets.get(), 1 /*async*/);
+  if (err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+    logger_->log_error("ConsumeKafka failed to commit offsets: %s", rd_kafka_err2str(err));
+  }
+}
+
+void ConsumeKafka::rewind() {
+  for (const auto &partition : uncommitted_offsets_) {
+    const auto topic = getTopic(partition.first.first);
+    if (!topic) {
+      continue;
+    }
+    const auto err = rd_kafka_seek(topic->getTopic(), partition.first.second, partition.second.first, 1000);
+    if (err != RD_KAFKA_RESP_ERR_NO_ERROR) {
+      logger_->log_error("ConsumeKafka failed to rewind partition %d of %s to offset %lld: %s", partition.first.second, partition.first.first, partition.second.first, rd_kafka_err2str(err));
+    }
+  }
+  uncommitted_offsets_.clear();
+}
+
+std::shared_ptr<KafkaTopic> ConsumeKafka::getTopic(const std::string &topic_name) {
+  if (!conn_) {
+    return nullptr;
+  }
+  auto topic = conn_->getTopic(topic_name);
+  if (topic) {
+    return topic;
+  }
+  gsl::owner<rd_kafka_topic_t*> topic_reference = rd_kafka_topic_new(conn_->getConnection(), topic_name.c_str(), nullptr);
+  if (topic_reference == nullptr) {
+    logger_->log_error("Failed to create topic handle for %s: %s", topic_name, rd_kafka_err2str(rd_kafka_last_error()));
+    return nullptr;
+  }
+  topic = std::make_shared<KafkaTopic>(topic_reference);
+  conn_->putTopic(topic_name, topic);
+  return topic;
+}
+
+void ConsumeKafka::offsetCommitCallback(rd_kafka_t* /*rk*/, rd_kafka_resp_err_t err, rd_kafka_topic_partition_list_t* /*offsets*/, void* /*opaque*/) {
+  if (err != RD_KAFKA_RESP_ERR_NO_ERROR && err != RD_KAFKA_RESP_ERR__NO_OFFSET) {
+    // the consumer has moved on already, only the next owner of the partitions sees the messages again
+    logging::LoggerFactory<ConsumeKafka>::getLogger()->log_warn("ConsumeKafka failed to commit offsets, the messages since the last committed offset "
+                                                                "will be delivered again after a restart or a rebalance: %s", rd_kafka_err2str(err));
+  }
+}
+
+int64_t ConsumeKafka::WriteCallback::process(std::shared_ptr<io::BaseStream> stream) {
+  int64_t written = 0;
+  for (size_t i = begin_; i < end_; ++i) {
+    if (i > begin_) {
+      if (stream->writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(demarcator_.data())), demarcator_.size()) < 0) {
+        return -1;
+      }
+      written += demarcator_.size();
+    }
+    const rd_kafka_message_t *message = messages_[i].get();
+    if (message->len == 0) {
+      continue;
+    }
+    // straight from the buffer of librdkafka
+    if (stream->writeData(static_cast<uint8_t*>(message->payload), message->len) < 0) {
+      return -1;
+    }
+    written += message->len;
+  }
+  return written;
+}
+
+}  // namespace processors
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
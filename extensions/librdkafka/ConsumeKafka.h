@@ -0,0 +1,185 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_LIBRDKAFKA_CONSUMEKAFKA_H_
+#define EXTENSIONS_LIBRDKAFKA_CONSUMEKAFKA_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FlowFileRecord.h"
+#include "core/Processor.h"
+#include "core/ProcessSession.h"
+#include "core/Core.h"
+#include "core/Resource.h"
+#include "core/Property.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "core/logging/Logger.h"
+#include "rdkafka.h"
+#include "KafkaConnection.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace processors {
+
+#define OFFSET_RESET_EARLIEST "earliest"
+#define OFFSET_RESET_LATEST "latest"
+#define OFFSET_RESET_NONE "none"
+
+/**
+ * Purpose: Consumes messages from Apache Kafka topics as a member of a consumer group.
+ *
+ * Design: Messages are taken from the consumer queue in batches with rd_kafka_consume_batch_queue
+ * and their payloads are written from the buffers of librdkafka straight into the content
+ * repository. With a demarcator the messages of a partition are packed into a single FlowFile.
+ * Automatic offset commits are disabled: the offsets are committed once the session holding the
+ * FlowFiles has been committed, and the consumer is rewound when the session is rolled back, so
+ * messages are delivered at least once.
+ */
+class ConsumeKafka : public core::Processor {
+ public:
+  explicit ConsumeKafka(std::string name, utils::Identifier uuid = utils::Identifier())
+      : core::Processor(std::move(name), uuid),
+        logger_(logging::LoggerFactory<ConsumeKafka>::getLogger()),
+        queue_(nullptr),
+        max_poll_records_(10000),
+        max_poll_time_ms_(1000) {
+  }
+
+  virtual ~ConsumeKafka();
+
+  static constexpr char const* ProcessorName = "ConsumeKafka";
+
+  // Supported Properties
+  static const core::Property SeedBrokers;
+  static const core::Property TopicNames;
+  static const core::Property GroupID;
+  static const core::Property ClientName;
+  static const core::Property OffsetReset;
+  static const core::Property MessageDemarcator;
+  static const core::Property MaxPollRecords;
+  static const core::Property MaxPollTime;
+
+  // Supported Relationships
+  static const core::Relationship Success;
+
+  bool supportsDynamicProperties() override {
+    return true;
+  }
+
+  void initialize() override;
+  void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
+  void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
+  void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
+  void notifyStop() override;
+
+  struct rd_kafka_conf_deleter {
+    void operator()(rd_kafka_conf_t* ptr) const noexcept {
+      rd_kafka_conf_destroy(ptr);
+    }
+  };
+
+  struct rd_kafka_message_deleter {
+    void operator()(rd_kafka_message_t* ptr) const noexcept {
+      rd_kafka_message_destroy(ptr);
+    }
+  };
+  using rd_kafka_message_unique_ptr = std::unique_ptr<rd_kafka_message_t, rd_kafka_message_deleter>;
+
+  // Writes the payloads of the messages, separated by the demarcator
+  class WriteCallback : public OutputStreamCallback {
+   public:
+    WriteCallback(const std::vector<rd_kafka_message_unique_ptr> &messages, size_t begin, size_t end, const std::string &demarcator)
+        : messages_(messages),
+          begin_(begin),
+          end_(end),
+          demarcator_(demarcator) {
+    }
+    int64_t process(std::shared_ptr<io::BaseStream> stream) override;
+
+   private:
+    const std::vector<rd_kafka_message_unique_ptr> &messages_;
+    const size_t begin_;
+    const size_t end_;
+    const std::string &demarcator_;
+  };
+
+  /**
+   * Orders the messages by topic and partition, keeping the order within a partition, and returns
+   * the [begin, end) ranges of the messages of each partition.
+   */
+  static std::vector<std::pair<size_t, size_t>> groupByPartition(std::vector<rd_kafka_message_unique_ptr> &messages);
+
+ protected:
+  void configureNewConnection(const std::shared_ptr<core::ProcessContext> &context);
+
+  /**
+   * Translates the properties into the configuration of the consumer.
+   */
+  std::unique_ptr<rd_kafka_conf_t, rd_kafka_conf_deleter> createConfiguration(const std::shared_ptr<core::ProcessContext> &context);
+
+ private:
+  // offsets consumed by a trigger and not committed yet
+  struct PartitionOffsets {
+    int64_t first;
+    int64_t next;
+  };
+  using TopicPartition = std::pair<std::string, int32_t>;
+
+  void closeConsumer();
+  void poll(std::vector<rd_kafka_message_unique_ptr> &messages);
+  void commitOffsets();
+  void rewind();
+  std::shared_ptr<KafkaTopic> getTopic(const std::string &topic_name);
+
+  static void offsetCommitCallback(rd_kafka_t *rk, rd_kafka_resp_err_t err, rd_kafka_topic_partition_list_t *offsets, void *opaque);
+
+  std::shared_ptr<logging::Logger> logger_;
+
+  KafkaConnectionKey key_;
+  std::unique_ptr<KafkaConnection> conn_;
+  rd_kafka_queue_t *queue_;
+  // a single consumer serves one trigger at a time
+  std::mutex consumer_mutex_;
+
+  std::vector<std::string> topic_names_;
+  std::string demarcator_;
+  uint64_t max_poll_records_;
+  int64_t max_poll_time_ms_;
+  // receives the messages of rd_kafka_consume_batch_queue
+  std::vector<rd_kafka_message_t*> batch_;
+
+  std::map<TopicPartition, PartitionOffsets> uncommitted_offsets_;
+};
+
+REGISTER_RESOURCE(ConsumeKafka, "Consumes messages from Apache Kafka topics as a member of a consumer group. Each message becomes the content of a FlowFile, or when a Message Demarcator is "
+                  "set, the messages received from the same partition are bundled into one FlowFile separated by the demarcator. Offsets are committed to Kafka only after the "
+                  "FlowFiles have been committed, so messages are delivered at least once.");
+
+}  // namespace processors
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // EXTENSIONS_LIBRDKAFKA_CONSUMEKAFKA_H_
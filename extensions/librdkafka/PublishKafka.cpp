@@ -561,23 +561,15 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
   logger_->log_debug("PublishKafka onTrigger");
 
   // Collect FlowFiles to process
-  uint64_t actual_bytes = 0U;
-  std::vector<std::shared_ptr<core::FlowFile>> flowFiles;
-  for (uint32_t i = 0; i < batch_size_; i++) {
-    std::shared_ptr<core::FlowFile> flowFile = session->get();
-    if (flowFile == nullptr) {
-      break;
-    }
-    actual_bytes += flowFile->getSize();
-    flowFiles.emplace_back(std::move(flowFile));
-    if (target_batch_payload_size_ != 0U && actual_bytes >= target_batch_payload_size_) {
-      break;
-    }
-  }
+  std::vector<std::shared_ptr<core::FlowFile>> flowFiles = session->get(batch_size_, target_batch_payload_size_);
   if (flowFiles.empty()) {
     context->yield();
     return;
   }
+  uint64_t actual_bytes = 0U;
+  for (const auto& flowFile : flowFiles) {
+    actual_bytes += flowFile->getSize();
+  }
   logger_->log_debug("Processing %lu flow files with a total size of %llu B", flowFiles.size(), actual_bytes);
 
   auto messages = std::make_shared<Messages>();
@@ -0,0 +1,184 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TestBase.h"
+#include "io/BaseStream.h"
+#include "ConsumeKafka.h"
+
+using org::apache::nifi::minifi::processors::ConsumeKafka;
+
+namespace {
+
+// Messages of real topic handles, without a broker
+class TestMessages {
+ public:
+  TestMessages() {
+    std::array<char, 512U> errstr{};
+    producer_ = rd_kafka_new(RD_KAFKA_PRODUCER, rd_kafka_conf_new(), errstr.data(), errstr.size());
+    REQUIRE(producer_ != nullptr);
+  }
+
+  ~TestMessages() {
+    // the messages were not allocated by librdkafka
+    for (auto &message : messages) {
+      delete message.release();
+    }
+    for (const auto &topic : topics_) {
+      rd_kafka_topic_destroy(topic.second);
+    }
+    rd_kafka_destroy(producer_);
+  }
+
+  void add(const std::string &topic, int32_t partition, const std::string &payload) {
+    auto &topic_handle = topics_[topic];
+    if (topic_handle == nullptr) {
+      topic_handle = rd_kafka_topic_new(producer_, topic.c_str(), nullptr);
+      REQUIRE(topic_handle != nullptr);
+    }
+    payloads_.push_back(payload);
+    auto message = new rd_kafka_message_t();
+    message->rkt = topic_handle;
+    message->partition = partition;
+    message->payload = payload.empty() ? nullptr : &payloads_.back()[0];
+    message->len = payload.size();
+    message->offset = static_cast<int64_t>(messages.size());
+    messages.emplace_back(message);
+  }
+
+  std::string payload(size_t index) const {
+    const rd_kafka_message_t *message = messages.at(index).get();
+    return message->len > 0 ? std::string(static_cast<const char*>(message->payload), message->len) : std::string();
+  }
+
+  std::string write(size_t begin, size_t end, const std::string &demarcator) const {
+    ConsumeKafka::WriteCallback callback(messages, begin, end, demarcator);
+    auto stream = std::make_shared<minifi::io::BaseStream>();
+    REQUIRE(callback.process(stream) == static_cast<int64_t>(stream->getSize()));
+    return std::string(reinterpret_cast<const char*>(stream->getBuffer()), stream->getSize());
+  }
+
+  std::vector<ConsumeKafka::rd_kafka_message_unique_ptr> messages;
+
+ private:
+  rd_kafka_t *producer_;
+  std::map<std::string, rd_kafka_topic_t*> topics_;
+  std::deque<std::string> payloads_;
+};
+
+class ConsumeKafkaConfiguration : public ConsumeKafka {
+ public:
+  using ConsumeKafka::ConsumeKafka;
+  using ConsumeKafka::createConfiguration;
+};
+
+std::string getConfiguration(const rd_kafka_conf_t *conf, const std::string &name) {
+  std::array<char, 512U> value{};
+  size_t size = value.size();
+  REQUIRE(rd_kafka_conf_get(conf, name.c_str(), value.data(), &size) == RD_KAFKA_CONF_OK);
+  return std::string(value.data());
+}
+
+std::shared_ptr<core::Processor> addConsumeKafka(const std::shared_ptr<TestPlan> &plan, const std::shared_ptr<core::Processor> &processor, const std::string &topics,
+                                                 const std::string &group_id) {
+  plan->addProcessor(processor, "consume_kafka");
+  plan->setProperty(processor, ConsumeKafka::SeedBrokers.getName(), "localhost:9092");
+  plan->setProperty(processor, ConsumeKafka::TopicNames.getName(), topics);
+  if (!group_id.empty()) {
+    plan->setProperty(processor, ConsumeKafka::GroupID.getName(), group_id);
+  }
+  return processor;
+}
+
+}  // namespace
+
+TEST_CASE("ConsumeKafka writes the payloads separated by the demarcator", "[ConsumeKafka][WriteCallback]") {
+  TestMessages test_messages;
+  test_messages.add("topic", 0, "one");
+  test_messages.add("topic", 0, "");
+  test_messages.add("topic", 0, "three");
+  test_messages.add("topic", 0, "");
+
+  REQUIRE(test_messages.write(0, 1, "|") == "one");
+  REQUIRE(test_messages.write(1, 2, "|").empty());
+  REQUIRE(test_messages.write(0, 3, "|") == "one||three");
+  REQUIRE(test_messages.write(0, 4, "--") == "one----three--");
+  REQUIRE(test_messages.write(1, 4, "|") == "|three|");
+}
+
+TEST_CASE("ConsumeKafka bundles the messages by partition in their order", "[ConsumeKafka][groupByPartition]") {
+  TestMessages test_messages;
+  test_messages.add("b", 0, "b0-1");
+  test_messages.add("a", 1, "a1-1");
+  test_messages.add("a", 0, "a0-1");
+  test_messages.add("b", 0, "b0-2");
+  test_messages.add("a", 1, "a1-2");
+  test_messages.add("a", 0, "a0-2");
+  test_messages.add("b", 0, "");
+
+  const auto ranges = ConsumeKafka::groupByPartition(test_messages.messages);
+  const std::vector<std::pair<size_t, size_t>> expected_ranges{{0, 2}, {2, 4}, {4, 7}};
+  REQUIRE(ranges == expected_ranges);
+
+  const std::vector<std::string> expected_payloads{"a0-1", "a0-2", "a1-1", "a1-2", "b0-1", "b0-2", ""};
+  for (size_t i = 0; i < expected_payloads.size(); ++i) {
+    REQUIRE(test_messages.payload(i) == expected_payloads[i]);
+  }
+  REQUIRE(test_messages.write(0, 2, "\n") == "a0-1\na0-2");
+  REQUIRE(test_messages.write(2, 4, "\n") == "a1-1\na1-2");
+  REQUIRE(test_messages.write(4, 7, "\n") == "b0-1\nb0-2\n");
+}
+
+TEST_CASE("ConsumeKafka requires a Group ID", "[ConsumeKafka][onSchedule]") {
+  TestController test_controller;
+  auto plan = test_controller.createPlan();
+  addConsumeKafka(plan, std::make_shared<ConsumeKafka>("consume_kafka"), "topic", "");
+
+  REQUIRE_THROWS_WITH(plan->runNextProcessor(), Catch::Contains("Group ID property missing or invalid"));
+}
+
+TEST_CASE("ConsumeKafka requires a topic", "[ConsumeKafka][onSchedule]") {
+  TestController test_controller;
+  auto plan = test_controller.createPlan();
+  addConsumeKafka(plan, std::make_shared<ConsumeKafka>("consume_kafka"), " , ", "group");
+
+  REQUIRE_THROWS_WITH(plan->runNextProcessor(), Catch::Contains("Topic Names property does not name any topic"));
+}
+
+TEST_CASE("ConsumeKafka configures the consumer", "[ConsumeKafka][onSchedule]") {
+  TestController test_controller;
+  auto plan = test_controller.createPlan();
+  auto processor = std::make_shared<ConsumeKafkaConfiguration>("consume_kafka");
+  addConsumeKafka(plan, processor, "topic1, topic2", "group");
+  plan->setProperty(processor, ConsumeKafka::OffsetReset.getName(), "none");
+  // the offsets are committed by the processor only
+  plan->setProperty(processor, "enable.auto.commit", "true", true);
+
+  // rd_kafka_new and rd_kafka_subscribe do not need a broker
+  plan->runNextProcessor([&processor](const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession>&) {
+    const auto conf = processor->createConfiguration(context);
+    REQUIRE(getConfiguration(conf.get(), "group.id") == "group");
+    REQUIRE(getConfiguration(conf.get(), "auto.offset.reset") == "error");
+    REQUIRE(getConfiguration(conf.get(), "enable.auto.commit") == "false");
+  });
+}
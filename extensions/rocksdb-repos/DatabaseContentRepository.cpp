@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include "RocksDbStream.h"
+#include "core/Property.h"
 #include "rocksdb/merge_operator.h"
 
 namespace org {
@@ -36,10 +37,19 @@ bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configu
   } else {
     directory_ = configuration->getHome() + "/dbcontentrepository";
   }
+  if (configuration->get(Configure::nifi_dbcontent_repository_chunk_size, value)) {
+    uint64_t chunk_size = 0;
+    if (core::Property::StringToInt(value, chunk_size) && chunk_size > 0) {
+      chunk_size_ = chunk_size;
+    } else {
+      logger_->log_error("Invalid chunk size %s, using %zu bytes", value, chunk_size_);
+    }
+  }
   rocksdb::Options options;
   options.create_if_missing = true;
   options.use_direct_io_for_flush_and_compaction = true;
   options.use_direct_reads = true;
+  // content written by earlier versions may still contain merge operands
   options.merge_operator = std::make_shared<StringAppender>();
   options.error_if_exists = false;
   options.max_successive_merges = 0;
@@ -67,7 +77,7 @@ std::shared_ptr<io::BaseStream> DatabaseContentRepository::write(const std::shar
   if (nullptr == claim || !is_valid_ || !db_)
     return nullptr;
   // append is already supported in all modes
-  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, true);
+  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, true, chunk_size_);
 }
 
 std::shared_ptr<io::BaseStream> DatabaseContentRepository::read(const std::shared_ptr<minifi::ResourceClaim> &claim) {
@@ -75,14 +85,11 @@ std::shared_ptr<io::BaseStream> DatabaseContentRepository::read(const std::share
   // we can simply return a nullptr, which is also valid from the API when this stream is not valid.
   if (nullptr == claim || !is_valid_ || !db_)
     return nullptr;
-  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, false);
+  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, false, chunk_size_);
 }
 
 bool DatabaseContentRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
-  std::string value;
-  rocksdb::Status status;
-  status = db_->Get(rocksdb::ReadOptions(), streamId->getContentFullPath(), &value);
-  if (status.ok()) {
+  if (io::RocksDbStream::exists(db_, streamId->getContentFullPath())) {
     logger_->log_debug("%s exists", streamId->getContentFullPath());
     return true;
   } else {
@@ -94,9 +101,7 @@ bool DatabaseContentRepository::exists(const std::shared_ptr<minifi::ResourceCla
 bool DatabaseContentRepository::remove(const std::shared_ptr<minifi::ResourceClaim> &claim) {
   if (nullptr == claim || !is_valid_ || !db_)
     return false;
-  rocksdb::Status status;
-  status = db_->Delete(rocksdb::WriteOptions(), claim->getContentFullPath());
-  if (status.ok()) {
+  if (io::RocksDbStream::remove(db_, claim->getContentFullPath())) {
     logger_->log_debug("Deleted %s", claim->getContentFullPath());
     return true;
   } else {
@@ -25,6 +25,7 @@
 #include "core/ContentRepository.h"
 #include "properties/Configure.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "RocksDbStream.h"
 namespace org {
 namespace apache {
 namespace nifi {
@@ -65,7 +66,8 @@ class StringAppender : public rocksdb::AssociativeMergeOperator {
 };
 
 /**
- * DatabaseContentRepository is a content repository that stores data onto the local file system.
+ * DatabaseContentRepository is a content repository that stores data in RocksDB. Content is stored
+ * in fixed size chunks, see RocksDbStream.
  */
 class DatabaseContentRepository : public core::ContentRepository, public core::Connectable {
  public:
@@ -74,6 +76,7 @@ class DatabaseContentRepository : public core::ContentRepository, public core::C
       : core::Connectable(name, uuid),
         is_valid_(false),
         db_(nullptr),
+        chunk_size_(io::RocksDbStream::DEFAULT_CHUNK_SIZE),
         logger_(logging::LoggerFactory<DatabaseContentRepository>::getLogger()) {
   }
   virtual ~DatabaseContentRepository() {
@@ -118,6 +121,8 @@ class DatabaseContentRepository : public core::ContentRepository, public core::C
  private:
   bool is_valid_;
   rocksdb::DB* db_;
+  // size of the chunks new content is split into
+  size_t chunk_size_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -18,6 +18,7 @@
 #include "FlowFileRecord.h"
 #include "FlowFileRepository.h"
 #include "utils/ScopeGuard.h"
+#include "utils/StringUtils.h"
 
 #include "rocksdb/options.h"
 #include "rocksdb/write_batch.h"
@@ -186,6 +187,118 @@ bool FlowFileRepository::ExecuteWithRetry(std::function<rocksdb::Status()> opera
   return false;
 }
 
+bool FlowFileRepository::parseDurability(const std::string &value, Durability &durability) {
+  if (utils::StringUtils::equalsIgnoreCase(value, "none")) {
+    durability = Durability::NONE;
+  } else if (utils::StringUtils::equalsIgnoreCase(value, "async")) {
+    durability = Durability::ASYNC;
+  } else if (utils::StringUtils::equalsIgnoreCase(value, "sync")) {
+    durability = Durability::SYNC;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+rocksdb::WriteOptions FlowFileRepository::getWriteOptions() const {
+  rocksdb::WriteOptions options;
+  options.sync = durability_ == Durability::SYNC;
+  options.disableWAL = durability_ == Durability::NONE;
+  return options;
+}
+
+bool FlowFileRepository::groupCommit(std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> &&records) {
+  if (records.empty()) {
+    return true;
+  }
+  auto pending_write = std::make_shared<PendingWrite>(std::move(records));
+  std::future<bool> result = pending_write->result.get_future();
+  bool queued = false;
+  {
+    std::lock_guard<std::mutex> lock(group_commit_mutex_);
+    if (group_commit_running_) {
+      pending_record_count_ += pending_write->records.size();
+      pending_writes_.push_back(pending_write);
+      queued = true;
+    }
+  }
+  if (!queued) {
+    // the writer is gone, nobody would fulfill the promise
+    rocksdb::WriteBatch batch;
+    for (const auto &record : pending_write->records) {
+      batch.Put(record.first, record.second);
+    }
+    auto operation = [this, &batch]() { return writeBatch(getWriteOptions(), &batch); };
+    return ExecuteWithRetry(operation);
+  }
+  group_commit_condition_.notify_one();
+  return result.get();
+}
+
+void FlowFileRepository::startGroupCommit() {
+  if (group_commit_running_) {
+    return;
+  }
+  group_commit_running_ = true;
+  group_commit_thread_ = std::thread(&FlowFileRepository::runGroupCommit, this);
+  logger_->log_debug("%s group commit writer started", getName());
+}
+
+void FlowFileRepository::stopGroupCommit() {
+  {
+    std::lock_guard<std::mutex> lock(group_commit_mutex_);
+    group_commit_running_ = false;
+  }
+  group_commit_condition_.notify_all();
+  if (group_commit_thread_.joinable()) {
+    group_commit_thread_.join();
+  }
+}
+
+void FlowFileRepository::stop() {
+  stopGroupCommit();
+  Repository::stop();
+}
+
+void FlowFileRepository::runGroupCommit() {
+  std::vector<std::shared_ptr<PendingWrite>> group;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(group_commit_mutex_);
+      group_commit_condition_.wait(lock, [this] { return !pending_writes_.empty() || !group_commit_running_; });
+      if (pending_writes_.empty()) {
+        // stopped and nothing left to write
+        return;
+      }
+      // give the other committers a chance to join the group
+      const auto deadline = std::chrono::steady_clock::now() + group_commit_max_latency_;
+      group_commit_condition_.wait_until(lock, deadline, [this] {
+        return pending_record_count_ >= FLOWFILE_REPOSITORY_MAX_GROUP_COMMIT_RECORDS || !group_commit_running_;
+      });
+      group.swap(pending_writes_);
+      pending_record_count_ = 0;
+    }
+
+    rocksdb::WriteBatch batch;
+    bool batched = true;
+    for (const auto &pending_write : group) {
+      for (const auto &record : pending_write->records) {
+        if (!batch.Put(record.first, record.second).ok()) {
+          logger_->log_error("Failed to add item to batch operation");
+          batched = false;
+        }
+      }
+    }
+    auto operation = [this, &batch]() { return writeBatch(getWriteOptions(), &batch); };
+    const bool success = batched && ExecuteWithRetry(operation);
+    logger_->log_trace("Group commit of %zu committers %s", group.size(), success ? "succeeded" : "failed");
+    for (const auto &pending_write : group) {
+      pending_write->result.set_value(success);
+    }
+    group.clear();
+  }
+}
+
 /**
  * Returns True if there is data to interrogate.
  * @return true if our db has data stored.
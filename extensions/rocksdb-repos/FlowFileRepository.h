@@ -18,11 +18,21 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "utils/file/FileUtils.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/utilities/checkpoint.h"
+#include "rocksdb/write_batch.h"
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "Connection.h"
@@ -47,6 +57,7 @@ namespace repository {
 #define MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME (600000) // 10 minute
 #define FLOWFILE_REPOSITORY_PURGE_PERIOD (2000) // 2000 msec
 #define FLOWFILE_REPOSITORY_RETRY_INTERVAL_INCREMENTS (500)  // msec
+#define FLOWFILE_REPOSITORY_MAX_GROUP_COMMIT_RECORDS (10000)
 
 /**
  * Flow File repository
@@ -66,12 +77,16 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<FlowFileRepository>(), directory, maxPartitionMillis, maxPartitionBytes, purgePeriod),
         content_repo_(nullptr),
         checkpoint_(nullptr),
+        durability_(Durability::ASYNC),
+        group_commit_max_latency_(0),
+        group_commit_running_(false),
         logger_(logging::LoggerFactory<FlowFileRepository>::getLogger()) {
     db_ = NULL;
   }
 
   // Destructor
   ~FlowFileRepository() {
+    stopGroupCommit();
     if (db_)
       delete db_;
   }
@@ -102,6 +117,19 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
       }
     }
     logger_->log_debug("NiFi FlowFile Max Storage Time: [%d] ms", max_partition_millis_);
+    if (configure->get(Configure::nifi_flowfile_repository_durability, value)) {
+      if (!parseDurability(value, durability_)) {
+        logger_->log_error("Invalid FlowFile repository durability %s, the valid values are none, async and sync", value);
+      }
+    }
+    if (configure->get(Configure::nifi_flowfile_repository_group_commit_max_latency, value)) {
+      TimeUnit unit;
+      uint64_t max_latency = 0;
+      if (Property::StringToTime(value, max_latency, unit) && Property::ConvertTimeUnitToMS(max_latency, unit, max_latency)) {
+        group_commit_max_latency_ = std::chrono::milliseconds(max_latency);
+      }
+    }
+    logger_->log_debug("NiFi FlowFile Group Commit Max Latency: [%d] ms", group_commit_max_latency_.count());
     rocksdb::Options options;
     options.create_if_missing = true;
     options.use_direct_io_for_flush_and_compaction = true;
@@ -119,6 +147,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     rocksdb::Status status = rocksdb::DB::Open(options, directory_, &db_);
     if (status.ok()) {
       logger_->log_debug("NiFi FlowFile Repository database open %s success", directory_);
+      if (group_commit_max_latency_.count() > 0) {
+        startGroupCommit();
+      }
     } else {
       logger_->log_error("NiFi FlowFile Repository database open %s fail", directory_);
     }
@@ -130,11 +161,24 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
     // persistent to the DB
     rocksdb::Slice value((const char *) buf, bufLen);
-    auto operation = [this, &key, &value]() { return db_->Put(rocksdb::WriteOptions(), key, value); };
+    if (group_commit_running_) {
+      return groupCommit({{rocksdb::Slice(key), value}});
+    }
+    rocksdb::WriteBatch batch;
+    batch.Put(key, value);
+    auto operation = [this, &batch]() { return writeBatch(getWriteOptions(), &batch); };
     return ExecuteWithRetry(operation);
   }
 
   virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::DataStream>>>& data) {
+    if (group_commit_running_) {
+      std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> records;
+      records.reserve(data.size());
+      for (const auto &item : data) {
+        records.emplace_back(rocksdb::Slice(item.first), rocksdb::Slice((const char *) item.second->getBuffer(), item.second->getSize()));
+      }
+      return groupCommit(std::move(records));
+    }
     rocksdb::WriteBatch batch;
     for (const auto &item: data) {
       rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->getSize());
@@ -143,7 +187,7 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
         return false;
       }
     }
-    auto operation = [this, &batch]() { return db_->Write(rocksdb::WriteOptions(), &batch); };
+    auto operation = [this, &batch]() { return writeBatch(getWriteOptions(), &batch); };
     return ExecuteWithRetry(operation);
   }
 
@@ -170,6 +214,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   virtual void loadComponent(const std::shared_ptr<core::ContentRepository> &content_repo);
 
   void start() {
+    if (db_ != nullptr && group_commit_max_latency_.count() > 0) {
+      startGroupCommit();
+    }
     if (this->purge_period_ <= 0) {
       return;
     }
@@ -181,10 +228,77 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     logger_->log_debug("%s Repository Monitor Thread Start", getName());
   }
 
+  /**
+   * Stops the group commit writer once it has written the records of every waiting committer, then the monitor thread.
+   */
+  virtual void stop();
+
+ protected:
+  /**
+   * Writes a batch of records to the database.
+   */
+  using BatchWriter = std::function<rocksdb::Status(rocksdb::DB *db, const rocksdb::WriteOptions &options, rocksdb::WriteBatch *batch)>;
+
+  /**
+   * Replaces the writer every Put and MultiPut of the repository ends up in. It is called from the group commit
+   * writer thread as well, so it must not use anything that is destroyed before this repository.
+   * Has to be set before the repository is initialized.
+   */
+  void setBatchWriter(BatchWriter batch_writer) {
+    batch_writer_ = std::move(batch_writer);
+  }
+
+  rocksdb::WriteOptions getWriteOptions() const;
+
  private:
+  /**
+   * How hard the repository tries to keep the written records across crashes.
+   * NONE skips the write ahead log, ASYNC writes it without syncing, SYNC syncs it on every write.
+   */
+  enum class Durability {
+    NONE,
+    ASYNC,
+    SYNC
+  };
+
+  /**
+   * Records of a single committer waiting for the group commit writer.
+   * The slices point into the buffers of the committer, which is blocked until the write completes.
+   */
+  struct PendingWrite {
+    explicit PendingWrite(std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> &&records)
+        : records(std::move(records)) {
+    }
+    std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> records;
+    std::promise<bool> result;
+  };
+
+  static bool parseDurability(const std::string &value, Durability &durability);
 
   bool ExecuteWithRetry(std::function<rocksdb::Status()> operation);
 
+  rocksdb::Status writeBatch(const rocksdb::WriteOptions &options, rocksdb::WriteBatch *batch) {
+    return batch_writer_ ? batch_writer_(db_, options, batch) : db_->Write(options, batch);
+  }
+
+  /**
+   * Hands the records over to the group commit writer and waits until they are written.
+   */
+  bool groupCommit(std::vector<std::pair<rocksdb::Slice, rocksdb::Slice>> &&records);
+
+  void startGroupCommit();
+
+  /**
+   * Stops the group commit writer once it has written the records of every waiting committer.
+   */
+  void stopGroupCommit();
+
+  /**
+   * Coalesces the records of concurrent committers into a single write batch. Once the first
+   * committer arrives it waits at most group_commit_max_latency_ for others to join.
+   */
+  void runGroupCommit();
+
   /**
    * Initialize the repository
    */
@@ -205,6 +319,15 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
   std::shared_ptr<core::ContentRepository> content_repo_;
   rocksdb::DB* db_;
   std::unique_ptr<rocksdb::Checkpoint> checkpoint_;
+  Durability durability_;
+  std::chrono::milliseconds group_commit_max_latency_;
+  std::atomic<bool> group_commit_running_;
+  std::mutex group_commit_mutex_;
+  std::condition_variable group_commit_condition_;
+  std::vector<std::shared_ptr<PendingWrite>> pending_writes_;
+  size_t pending_record_count_ = 0;
+  std::thread group_commit_thread_;
+  BatchWriter batch_writer_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
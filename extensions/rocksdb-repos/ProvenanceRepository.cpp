@@ -17,13 +17,159 @@
  */
 
 #include "ProvenanceRepository.h"
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <set>
 #include <string>
+#include <vector>
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
 namespace provenance {
 
+const char *ProvenanceRepository::CURSOR_COLUMN_FAMILY = "reporting";
+
+const char *ProvenanceRepository::CURSOR_KEY = "reporting.cursor";
+
+const char *ProvenanceRepository::INDEX_COLUMN_FAMILY = "index";
+
+std::string ProvenanceRepository::encodeSequenceNumber(uint64_t sequence_number) {
+  std::string key(sizeof(uint64_t), '\0');
+  for (int i = sizeof(uint64_t) - 1; i >= 0; --i) {
+    key[i] = static_cast<char>(sequence_number & 0xFF);
+    sequence_number >>= 8;
+  }
+  return key;
+}
+
+bool ProvenanceRepository::decodeSequenceNumber(const rocksdb::Slice &key, uint64_t &sequence_number) {
+  if (key.size() != sizeof(uint64_t)) {
+    return false;
+  }
+  sequence_number = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    sequence_number = (sequence_number << 8) | static_cast<uint8_t>(key.data()[i]);
+  }
+  return true;
+}
+
+void ProvenanceRepository::loadCursor() {
+  uint64_t cursor = 0;
+  std::string value;
+  if (db_->Get(rocksdb::ReadOptions(), cursor_column_.get(), CURSOR_KEY, &value).ok() && !decodeSequenceNumber(value, cursor)) {
+    logger_->log_error("Invalid provenance reporting cursor, reporting starts from the oldest event");
+    cursor = 0;
+  }
+
+  // the first byte of sequence numbers is zero in practice, so their keys sort before the events that
+  // earlier versions stored under their id
+  uint64_t next_sequence_number = 0;
+  std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions()));
+  it->Seek(rocksdb::Slice("\x01", 1));
+  if (it->Valid()) {
+    it->Prev();
+  } else {
+    it->SeekToLast();
+  }
+  uint64_t last_sequence_number;
+  if (it->Valid() && decodeSequenceNumber(it->key(), last_sequence_number)) {
+    next_sequence_number = last_sequence_number + 1;
+  }
+
+  std::lock_guard<std::mutex> write_lock(write_mutex_);
+  std::lock_guard<std::mutex> cursor_lock(cursor_mutex_);
+  // the reported events may have expired since, new events must not be stored behind the cursor
+  next_sequence_number_ = (std::max)(next_sequence_number, cursor);
+  cursor_ = cursor;
+  pending_cursor_ = cursor;
+  pending_records_.clear();
+  logger_->log_debug("Provenance reporting cursor at %" PRIu64 ", next event is %" PRIu64, cursor_, next_sequence_number_);
+}
+
+bool ProvenanceRepository::DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &records, size_t &max_size,
+                                       std::function<std::shared_ptr<core::SerializableComponent>()> lambda) {
+  const size_t requested_batch = max_size;
+  max_size = 0;
+  std::lock_guard<std::mutex> lock(cursor_mutex_);
+  uint64_t next_cursor = cursor_;
+  uint64_t sequence_number;
+  pending_records_.clear();
+  std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions()));
+  for (it->Seek(encodeSequenceNumber(cursor_)); it->Valid() && max_size < requested_batch && decodeSequenceNumber(it->key(), sequence_number); it->Next()) {
+    next_cursor = sequence_number + 1;
+    std::shared_ptr<core::SerializableComponent> eventRead = lambda();
+    if (eventRead->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
+      max_size++;
+      records.push_back(eventRead);
+      pending_records_.emplace_back(eventRead, sequence_number);
+    }
+  }
+  pending_cursor_ = next_cursor;
+  return max_size > 0;
+}
+
+bool ProvenanceRepository::Delete(std::vector<std::shared_ptr<core::SerializableComponent>> &storedValues) {
+  if (storedValues.empty()) {
+    return true;
+  }
+  std::set<const core::SerializableComponent*> acknowledged;
+  for (const auto &record : storedValues) {
+    acknowledged.insert(record.get());
+  }
+  std::lock_guard<std::mutex> lock(cursor_mutex_);
+  // the cursor may only move past the events which are all acknowledged, events that could not be read are skipped
+  uint64_t next_cursor = pending_cursor_;
+  auto first_pending = pending_records_.begin();
+  for (; first_pending != pending_records_.end(); ++first_pending) {
+    if (acknowledged.find(first_pending->first.get()) == acknowledged.end()) {
+      next_cursor = first_pending->second;
+      break;
+    }
+  }
+  if (next_cursor <= cursor_) {
+    return true;
+  }
+  // the cursor must survive a crash, otherwise the events would be reported again
+  rocksdb::WriteOptions options;
+  options.sync = true;
+  if (!db_->Put(options, cursor_column_.get(), CURSOR_KEY, encodeSequenceNumber(next_cursor)).ok()) {
+    logger_->log_error("Could not persist the provenance reporting cursor");
+    return false;
+  }
+  cursor_ = next_cursor;
+  pending_records_.erase(pending_records_.begin(), first_pending);
+  return true;
+}
+
+bool ProvenanceRepository::Delete(std::string key) {
+  rocksdb::WriteBatch batch;
+  std::string sequence_key;
+  if (db_->Get(rocksdb::ReadOptions(), index_column_.get(), key, &sequence_key).ok()) {
+    batch.Delete(sequence_key);
+    batch.Delete(index_column_.get(), key);
+  } else {
+    // events stored by earlier versions are keyed by their id
+    std::string value;
+    if (!db_->Get(rocksdb::ReadOptions(), key, &value).ok()) {
+      return false;
+    }
+    batch.Delete(key);
+  }
+  return db_->Write(rocksdb::WriteOptions(), &batch).ok();
+}
+
+bool ProvenanceRepository::Get(const std::string &key, std::string &value) {
+  std::string sequence_key;
+  if (db_->Get(rocksdb::ReadOptions(), index_column_.get(), key, &sequence_key).ok()) {
+    // the event may have expired since
+    return db_->Get(rocksdb::ReadOptions(), sequence_key, &value).ok();
+  }
+  // events stored by earlier versions are keyed by their id
+  return db_->Get(rocksdb::ReadOptions(), key, &value).ok();
+}
+
 void ProvenanceRepository::printStats() {
   std::string key_count;
   db_->GetProperty("rocksdb.estimate-num-keys", &key_count);
@@ -17,9 +17,17 @@
 #ifndef LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEREPOSITORY_H_
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/write_batch.h"
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "provenance/Provenance.h"
@@ -35,6 +43,13 @@ namespace provenance {
 #define MAX_PROVENANCE_ENTRY_LIFE_TIME (60000) // 1 minute
 #define PROVENANCE_PURGE_PERIOD (2500) // 2500 msec
 
+/**
+ * Provenance repository backed by RocksDB.
+ *
+ * Events are stored under monotonically increasing sequence numbers, so the keys follow the order in
+ * which the events were committed. Readers of DeSerialize continue from a persisted reporting cursor,
+ * which is moved past the events returned by the last DeSerialize once they are passed to Delete.
+ */
 class ProvenanceRepository : public core::Repository, public std::enable_shared_from_this<ProvenanceRepository> {
  public:
   ProvenanceRepository(std::string name, utils::Identifier uuid)
@@ -106,45 +121,84 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     logger_->log_info("Max partition bytes: %llu", max_partition_bytes_);
     logger_->log_info("Ttl: %llu", options.compaction_options_fifo.ttl);
 
+    options.create_missing_column_families = true;
+
+    // FIFO compaction may drop any key of the events, so the reporting cursor lives in its own column family.
+    // The id index expires like the events it points to.
+    std::vector<rocksdb::ColumnFamilyDescriptor> column_families{
+      rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(options)),
+      rocksdb::ColumnFamilyDescriptor(CURSOR_COLUMN_FAMILY, rocksdb::ColumnFamilyOptions()),
+      rocksdb::ColumnFamilyDescriptor(INDEX_COLUMN_FAMILY, rocksdb::ColumnFamilyOptions(options))
+    };
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
     rocksdb::DB* db;
-    rocksdb::Status status = rocksdb::DB::Open(options, directory_, &db);
+    rocksdb::Status status = rocksdb::DB::Open(rocksdb::DBOptions(options), directory_, column_families, &handles, &db);
     if (status.ok()) {
       logger_->log_debug("MiNiFi Provenance Repository database open %s success", directory_);
       db_.reset(db);
+      // the handle of the default column family is not needed, the DB keeps its own
+      delete handles[0];
+      cursor_column_.reset(handles[1]);
+      index_column_.reset(handles[2]);
     } else {
       logger_->log_error("MiNiFi Provenance Repository database open %s failed: %s", directory_, status.ToString());
       return false;
     }
+    loadCursor();
 
     return true;
   }
-  // Put
+  // Put, the event is stored under the next sequence number, which is indexed by the given id
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
-    // persist to the DB
     rocksdb::Slice value((const char *) buf, bufLen);
-    return db_->Put(rocksdb::WriteOptions(), key, value).ok();
+    rocksdb::WriteBatch batch;
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const std::string sequence_key = encodeSequenceNumber(next_sequence_number_);
+    if (!batch.Put(sequence_key, value).ok() || !batch.Put(index_column_.get(), key, sequence_key).ok()) {
+      return false;
+    }
+    if (!db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
+      return false;
+    }
+    ++next_sequence_number_;
+    return true;
   }
 
   virtual bool MultiPut(const std::vector<std::pair<std::string, std::unique_ptr<minifi::io::DataStream>>>& data) {
     rocksdb::WriteBatch batch;
+    // keys are assigned under the lock so that they become visible in order and the cursor never skips an event
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    uint64_t sequence_number = next_sequence_number_;
     for (const auto &item: data) {
       rocksdb::Slice value((const char *) item.second->getBuffer(), item.second->getSize());
-      if (!batch.Put(item.first, value).ok()) {
+      const std::string sequence_key = encodeSequenceNumber(sequence_number++);
+      if (!batch.Put(sequence_key, value).ok() || !batch.Put(index_column_.get(), item.first, sequence_key).ok()) {
         return false;
       }
     }
-    return db_->Write(rocksdb::WriteOptions(), &batch).ok();
-  }
-
-  // Delete
-  virtual bool Delete(std::string key) {
-    // The repo is cleaned up by itself, there is no need to delete items.
+    if (!db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
+      return false;
+    }
+    next_sequence_number_ = sequence_number;
     return true;
   }
-  // Get
-  virtual bool Get(const std::string &key, std::string &value) {
-    return db_->Get(rocksdb::ReadOptions(), key, &value).ok();
-  }
+
+  /**
+   * Deletes the event with the given id.
+   * @return false if there is no such event or it could not be deleted
+   */
+  virtual bool Delete(std::string key);
+
+  /**
+   * Acknowledges events returned by the last DeSerialize: the reporting cursor is moved past them, up to the
+   * first returned event which is not among storedValues.
+   */
+  virtual bool Delete(std::vector<std::shared_ptr<core::SerializableComponent>> &storedValues);
+
+  /**
+   * Gets an event by its id.
+   */
+  virtual bool Get(const std::string &key, std::string &value);
 
   virtual bool Serialize(const std::string &key, const uint8_t *buffer, const size_t bufferSize) {
     return Put(key, buffer, bufferSize);
@@ -164,23 +218,11 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
     return true;
   }
 
-  virtual bool DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &records, size_t &max_size, std::function<std::shared_ptr<core::SerializableComponent>()> lambda) {
-    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions()));
-    size_t requested_batch = max_size;
-    max_size = 0;
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-
-      if (max_size >= requested_batch)
-        break;
-      std::shared_ptr<core::SerializableComponent> eventRead = lambda();
-      std::string key = it->key().ToString();
-      if (eventRead->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
-        max_size++;
-        records.push_back(eventRead);
-      }
-    }
-    return max_size > 0;
-  }
+  /**
+   * Reads at most max_size events following the reporting cursor. Until the events are acknowledged
+   * with Delete, the next call returns the same events.
+   */
+  virtual bool DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &records, size_t &max_size, std::function<std::shared_ptr<core::SerializableComponent>()> lambda);
 
   //! get record
   void getProvenanceRecord(std::vector<std::shared_ptr<ProvenanceEventRecord>> &records, int maxSize) {
@@ -214,11 +256,21 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
 
   // destroy
   void destroy() {
+    cursor_column_.reset();
+    index_column_.reset();
     db_.reset();
   }
   // Run function for the thread
   void run();
 
+  /**
+   * @return the sequence number of the first event that has not been acknowledged yet
+   */
+  uint64_t getCursor() {
+    std::lock_guard<std::mutex> lock(cursor_mutex_);
+    return cursor_;
+  }
+
   uint64_t getKeyCount() const {
     std::string key_count;
     db_->GetProperty("rocksdb.estimate-num-keys", &key_count);
@@ -232,7 +284,38 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   ProvenanceRepository &operator=(const ProvenanceRepository &parent) = delete;
 
  private:
+  static const char *CURSOR_COLUMN_FAMILY;
+
+  static const char *CURSOR_KEY;
+
+  static const char *INDEX_COLUMN_FAMILY;
+
+  // sequence numbers are stored big endian so that the keys sort by them
+  static std::string encodeSequenceNumber(uint64_t sequence_number);
+
+  static bool decodeSequenceNumber(const rocksdb::Slice &key, uint64_t &sequence_number);
+
+  // restores the reporting cursor and the next sequence number
+  void loadCursor();
+
   std::unique_ptr<rocksdb::DB> db_;
+
+  // column family of the reporting cursor, which is not compacted away like the events
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> cursor_column_;
+
+  // column family mapping the ids of the events to their sequence numbers, written in the batch of the event
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> index_column_;
+
+  std::mutex write_mutex_;
+  uint64_t next_sequence_number_ = 0;
+
+  std::mutex cursor_mutex_;
+  uint64_t cursor_ = 0;
+  // the cursor to commit once all the events returned by the last DeSerialize are acknowledged
+  uint64_t pending_cursor_ = 0;
+  // the events returned by the last DeSerialize with their sequence numbers, in order
+  std::vector<std::pair<std::shared_ptr<core::SerializableComponent>, uint64_t>> pending_records_;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
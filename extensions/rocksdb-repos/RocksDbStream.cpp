@@ -17,6 +17,8 @@
  */
 
 #include "RocksDbStream.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <utility>
 #include <vector>
@@ -30,22 +32,78 @@ namespace nifi {
 namespace minifi {
 namespace io {
 
-RocksDbStream::RocksDbStream(std::string path, rocksdb::DB *db, bool write_enable)
+namespace {
+
+void encodeUint64(uint64_t value, std::string &out) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t decodeUint64(const char *data) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | static_cast<uint8_t>(data[i]);
+  }
+  return value;
+}
+
+}  // namespace
+
+constexpr size_t RocksDbStream::DEFAULT_CHUNK_SIZE;
+constexpr size_t RocksDbStream::CHUNKS_PER_WRITE_BATCH;
+
+RocksDbStream::RocksDbStream(std::string path, rocksdb::DB *db, bool write_enable, size_t chunk_size)
     : BaseStream(),
       path_(std::move(path)),
       write_enable_(write_enable),
+      exists_(false),
+      offset_(0),
       db_(db),
+      size_(0),
+      committed_size_(0),
+      chunk_size_(chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE),
+      legacy_(false),
+      read_chunk_index_(-1),
+      write_chunk_index_(0),
+      batched_chunks_(0),
+      dirty_(false),
       logger_(logging::LoggerFactory<RocksDbStream>::getLogger()) {
-  exists_ = db_->Get(rocksdb::ReadOptions(), path_, &value_).ok();
-  offset_ = 0;
-  size_ = value_.size();
+  exists_ = readMetadata(db_, path_, committed_size_, chunk_size_);
+  if (!exists_) {
+    legacy_ = exists_ = db_->Get(rocksdb::ReadOptions(), path_, &legacy_value_).ok();
+    committed_size_ = legacy_value_.size();
+  }
+  size_ = committed_size_;
+  if (!write_enable_ || !exists_) {
+    return;
+  }
+  if (legacy_) {
+    // rewrite the single value as chunks once the stream is committed
+    uint64_t converted = 0;
+    for (; committed_size_ - converted >= chunk_size_; converted += chunk_size_) {
+      batch_.Put(getChunkKey(path_, write_chunk_index_++), rocksdb::Slice(legacy_value_.data() + converted, chunk_size_));
+    }
+    write_chunk_ = legacy_value_.substr(converted);
+    dirty_ = true;
+  } else {
+    // continue in the last, partially filled chunk
+    write_chunk_index_ = committed_size_ / chunk_size_;
+    if (committed_size_ % chunk_size_ != 0 && !db_->Get(rocksdb::ReadOptions(), getChunkKey(path_, write_chunk_index_), &write_chunk_).ok()) {
+      logger_->log_error("Could not read the last chunk of %s", path_);
+      write_enable_ = false;
+    }
+  }
 }
 
 void RocksDbStream::closeStream() {
+  if (write_enable_ && dirty_ && !commit()) {
+    logger_->log_error("Could not commit the content of %s", path_);
+  }
 }
 
 void RocksDbStream::seek(uint64_t offset) {
-  // noop
+  offset_ = (std::min)(offset, committed_size_);
 }
 
 int RocksDbStream::writeData(std::vector<uint8_t> &buf, int buflen) {
@@ -62,21 +120,131 @@ int RocksDbStream::writeData(std::vector<uint8_t> &buf, int buflen) {
 // data stream overrides
 
 int RocksDbStream::writeData(uint8_t *value, int size) {
-  if (!IsNullOrEmpty(value) && write_enable_) {
-    rocksdb::Slice slice_value((const char *) value, size);
-    rocksdb::Status status;
-    size_ += size;
-    rocksdb::WriteOptions opts;
-    opts.sync = true;
-    db_->Merge(opts, path_, slice_value);
-    if (status.ok()) {
-      return 0;
-    } else {
+  if (IsNullOrEmpty(value) || !write_enable_ || size < 0) {
+    return -1;
+  }
+  size_t written = 0;
+  while (written < static_cast<size_t>(size)) {
+    const size_t amount = (std::min)(static_cast<size_t>(size) - written, static_cast<size_t>(chunk_size_ - write_chunk_.size()));
+    write_chunk_.append(reinterpret_cast<const char *>(value) + written, amount);
+    written += amount;
+    if (write_chunk_.size() == chunk_size_ && !flushChunk()) {
       return -1;
     }
-  } else {
-    return -1;
   }
+  size_ += size;
+  dirty_ = true;
+  return size;
+}
+
+bool RocksDbStream::exists(rocksdb::DB *db, const std::string &path) {
+  uint64_t size = 0;
+  uint64_t chunk_size = 0;
+  std::string value;
+  return readMetadata(db, path, size, chunk_size) || db->Get(rocksdb::ReadOptions(), path, &value).ok();
+}
+
+bool RocksDbStream::remove(rocksdb::DB *db, const std::string &path) {
+  rocksdb::WriteBatch batch;
+  // chunks flushed by an interrupted commit are not covered by the metadata, so find them by their key prefix
+  const std::string chunk_prefix = getChunkKeyPrefix(path);
+  std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions()));
+  for (it->Seek(chunk_prefix); it->Valid() && it->key().starts_with(chunk_prefix); it->Next()) {
+    batch.Delete(it->key());
+  }
+  if (!it->status().ok()) {
+    return false;
+  }
+  batch.Delete(getMetadataKey(path));
+  batch.Delete(path);
+  return db->Write(rocksdb::WriteOptions(), &batch).ok();
+}
+
+std::string RocksDbStream::getMetadataKey(const std::string &path) {
+  return path + "#meta";
+}
+
+std::string RocksDbStream::getChunkKeyPrefix(const std::string &path) {
+  return path + "#chunk";
+}
+
+std::string RocksDbStream::getChunkKey(const std::string &path, uint64_t index) {
+  return getChunkKeyPrefix(path) + std::to_string(index);
+}
+
+bool RocksDbStream::readMetadata(rocksdb::DB *db, const std::string &path, uint64_t &size, uint64_t &chunk_size) {
+  std::string value;
+  if (!db->Get(rocksdb::ReadOptions(), getMetadataKey(path), &value).ok() || value.size() != 16) {
+    return false;
+  }
+  size = decodeUint64(value.data());
+  chunk_size = decodeUint64(value.data() + 8);
+  return chunk_size > 0;
+}
+
+bool RocksDbStream::flushChunk() {
+  batch_.Put(getChunkKey(path_, write_chunk_index_++), write_chunk_);
+  write_chunk_.clear();
+  if (++batched_chunks_ >= CHUNKS_PER_WRITE_BATCH) {
+    // chunks are not visible before the metadata is committed, there is no need to sync them
+    return writeBatch(false);
+  }
+  return true;
+}
+
+bool RocksDbStream::writeBatch(bool sync) {
+  if (batch_.Count() == 0) {
+    return true;
+  }
+  rocksdb::WriteOptions options;
+  options.sync = sync;
+  const rocksdb::Status status = db_->Write(options, &batch_);
+  batch_.Clear();
+  batched_chunks_ = 0;
+  if (!status.ok()) {
+    logger_->log_error("Could not write the chunks of %s: %s", path_, status.ToString());
+    return false;
+  }
+  return true;
+}
+
+bool RocksDbStream::commit() {
+  if (!write_chunk_.empty()) {
+    // the partial chunk stays in write_chunk_ so that later writes can keep filling it
+    batch_.Put(getChunkKey(path_, write_chunk_index_), write_chunk_);
+  }
+  std::string metadata;
+  encodeUint64(size_, metadata);
+  encodeUint64(chunk_size_, metadata);
+  batch_.Put(getMetadataKey(path_), metadata);
+  if (legacy_) {
+    batch_.Delete(path_);
+  }
+  // the FlowFile referring to the content may be persisted right after this, so make the metadata durable.
+  // Syncing the write ahead log also persists the chunks flushed before without syncing.
+  if (!writeBatch(true)) {
+    return false;
+  }
+  legacy_ = false;
+  legacy_value_.clear();
+  exists_ = true;
+  committed_size_ = size_;
+  read_chunk_index_ = -1;
+  dirty_ = false;
+  return true;
+}
+
+bool RocksDbStream::loadChunk(uint64_t index) {
+  if (read_chunk_index_ >= 0 && static_cast<uint64_t>(read_chunk_index_) == index) {
+    return true;
+  }
+  if (!db_->Get(rocksdb::ReadOptions(), getChunkKey(path_, index), &read_chunk_).ok()) {
+    logger_->log_error("Chunk %llu of %s is missing", index, path_);
+    read_chunk_index_ = -1;
+    return false;
+  }
+  read_chunk_index_ = index;
+  return true;
 }
 
 template<typename T>
@@ -102,20 +270,34 @@ int RocksDbStream::readData(std::vector<uint8_t> &buf, int buflen) {
 }
 
 int RocksDbStream::readData(uint8_t *buf, int buflen) {
-  if (!IsNullOrEmpty(buf) && exists_) {
-    int amtToRead = buflen;
-    if (offset_ >= value_.size()) {
-      return 0;
-    }
-    if (buflen > value_.size() - offset_) {
-      amtToRead = value_.size() - offset_;
-    }
-    std::memcpy(buf, value_.data() + offset_, amtToRead);
+  if (IsNullOrEmpty(buf) || !exists_ || buflen < 0) {
+    return -1;
+  }
+  if (offset_ >= committed_size_) {
+    return 0;
+  }
+  const size_t amtToRead = (std::min)(static_cast<uint64_t>(buflen), committed_size_ - offset_);
+  if (legacy_) {
+    std::memcpy(buf, legacy_value_.data() + offset_, amtToRead);
     offset_ += amtToRead;
     return amtToRead;
-  } else {
-    return -1;
   }
+  size_t read = 0;
+  while (read < amtToRead) {
+    if (!loadChunk(offset_ / chunk_size_)) {
+      return read > 0 ? read : -1;
+    }
+    const size_t chunk_offset = offset_ % chunk_size_;
+    if (chunk_offset >= read_chunk_.size()) {
+      logger_->log_error("Chunk %llu of %s is shorter than expected", offset_ / chunk_size_, path_);
+      return read > 0 ? read : -1;
+    }
+    const size_t amount = (std::min)(amtToRead - read, read_chunk_.size() - chunk_offset);
+    std::memcpy(buf + read, read_chunk_.data() + chunk_offset, amount);
+    read += amount;
+    offset_ += amount;
+  }
+  return read;
 }
 
 } /* namespace io */
@@ -19,9 +19,11 @@
 #define LIBMINIFI_INCLUDE_IO_TLS_RocksDbStream_H_
 
 #include "rocksdb/db.h"
+#include "rocksdb/write_batch.h"
 #include <iostream>
 #include <cstdint>
 #include <string>
+#include <vector>
 #include "io/EndianCheck.h"
 #include "io/BaseStream.h"
 #include "io/Serializable.h"
@@ -34,19 +36,28 @@ namespace minifi {
 namespace io {
 
 /**
- * Purpose: File Stream Base stream extension. This is intended to be a thread safe access to
- * read/write to the local file system.
+ * Purpose: RocksDB backed stream of a single content claim.
  *
- * Design: Simply extends BaseStream and overrides readData/writeData to allow a sink to the
- * fstream object.
+ * Design: The content is split into fixed size chunks stored under path#chunkN keys, next to a
+ * metadata key holding the committed size and the chunk size. Writes fill the current chunk and
+ * hand full chunks to non-synced write batches; the remaining partial chunk and the metadata are
+ * written when the stream is closed, so readers only ever see committed content. Reads fetch one
+ * chunk at a time, keeping the memory used by a stream bounded by the chunk size.
+ *
+ * Content written as a single value by earlier versions is still readable and is converted to
+ * chunks when appended to.
  */
 class RocksDbStream : public io::BaseStream {
  public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+  // Number of full chunks collected before they are written to the database
+  static constexpr size_t CHUNKS_PER_WRITE_BATCH = 16;
+
   /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
+   * Opens the content stored under path. Existing content is appended to by write enabled streams.
+   * @param chunk_size chunk size used for new content, existing content keeps its own
    */
-  explicit RocksDbStream(std::string path, rocksdb::DB *db, bool write_enable = false);
+  explicit RocksDbStream(std::string path, rocksdb::DB *db, bool write_enable = false, size_t chunk_size = DEFAULT_CHUNK_SIZE);
 
   ~RocksDbStream() override {
     closeStream();
@@ -139,6 +150,16 @@ class RocksDbStream : public io::BaseStream {
     throw std::runtime_error("Stream does not support this operation");
   }
 
+ /**
+   * @return true if there is committed content stored under path
+   */
+  static bool exists(rocksdb::DB *db, const std::string &path);
+
+  /**
+   * Removes the chunks and the metadata of the content stored under path.
+   */
+  static bool remove(rocksdb::DB *db, const std::string &path);
+
  protected:
 
   /**
@@ -150,19 +171,62 @@ class RocksDbStream : public io::BaseStream {
   template<typename T>
   int readBuffer(std::vector<uint8_t>&, const T&);
 
+  static std::string getMetadataKey(const std::string &path);
+
+  static std::string getChunkKeyPrefix(const std::string &path);
+
+  static std::string getChunkKey(const std::string &path, uint64_t index);
+
+  static bool readMetadata(rocksdb::DB *db, const std::string &path, uint64_t &size, uint64_t &chunk_size);
+
+  // moves the full pending chunk into the write batch
+  bool flushChunk();
+
+  bool writeBatch(bool sync);
+
+  // writes the partial chunk and the metadata, making the written content visible to readers
+  bool commit();
+
+  bool loadChunk(uint64_t index);
+
   std::string path_;
 
   bool write_enable_;
 
   bool exists_;
 
-  int64_t offset_;
-
-  std::string value_;
+  uint64_t offset_;
 
   rocksdb::DB *db_;
 
-  size_t size_;
+  // size including the not yet committed writes
+  uint64_t size_;
+
+  // size visible to readers
+  uint64_t committed_size_;
+
+  uint64_t chunk_size_;
+
+  // content stored as a single value by earlier versions
+  bool legacy_;
+
+  std::string legacy_value_;
+
+  // chunk currently being read
+  std::string read_chunk_;
+
+  int64_t read_chunk_index_;
+
+  // chunk currently being written
+  std::string write_chunk_;
+
+  uint64_t write_chunk_index_;
+
+  rocksdb::WriteBatch batch_;
+
+  size_t batched_chunks_;
+
+  bool dirty_;
 
  private:
 
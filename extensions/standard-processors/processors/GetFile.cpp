@@ -92,6 +92,18 @@ core::Property GetFile::Recurse(
 core::Property GetFile::FileFilter(
     core::PropertyBuilder::createProperty("File Filter")->withDescription("Only files whose names match the given regular expression will be picked up")->withDefaultValue("[^\\.].*")->build());
 
+core::Property GetFile::WatchDirectory(
+    core::PropertyBuilder::createProperty("Watch Input Directory")
+        ->withDescription("If true, new files are picked up as the file system reports them instead of listing the whole input directory on every poll. "
+                          "Only available on Linux, other platforms keep listing the directory")
+        ->withDefaultValue<bool>(false)->build());
+
+core::Property GetFile::ReconciliationInterval(
+    core::PropertyBuilder::createProperty("Reconciliation Interval")
+        ->withDescription("How often the whole input directory is listed while it is watched, to pick up the files whose events were lost "
+                          "or that were too young on their last change")
+        ->withDefaultValue<core::TimePeriodValue>("5 min")->build());
+
 core::Relationship GetFile::Success("success", "All files are routed to success");
 
 void GetFile::initialize() {
@@ -108,6 +120,8 @@ void GetFile::initialize() {
   properties.insert(PollInterval);
   properties.insert(Recurse);
   properties.insert(FileFilter);
+  properties.insert(WatchDirectory);
+  properties.insert(ReconciliationInterval);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -154,6 +168,32 @@ void GetFile::onSchedule(core::ProcessContext *context, core::ProcessSessionFact
     throw Exception(PROCESS_SCHEDULE_EXCEPTION, "Input Directory \"" + value + "\" is not a directory");
   }
   request_.inputDirectory = value;
+
+  if (context->getProperty(WatchDirectory.getName(), value)) {
+    org::apache::nifi::minifi::utils::StringUtils::StringToBool(value, request_.watchDirectory);
+  }
+  context->getProperty(ReconciliationInterval.getName(), request_.reconciliationInterval);
+
+  std::lock_guard<std::mutex> lock(watcher_mutex_);
+  watcher_.reset();
+  last_listing_time_ = 0;
+  listing_incomplete_ = false;
+  if (request_.watchDirectory) {
+    if (!utils::file::DirectoryWatcher::isSupported()) {
+      logger_->log_warn("Watching directories is not supported on this platform, %s is listed instead", request_.inputDirectory);
+      return;
+    }
+    watcher_ = std::unique_ptr<utils::file::DirectoryWatcher>(new utils::file::DirectoryWatcher(request_.recursive));
+    if (!watcher_->watch(request_.inputDirectory)) {
+      // subdirectories beyond the watch limit are covered by the reconciliation listings only
+      logger_->log_warn("Could not watch every directory in %s, some files are only picked up by the reconciliation listing", request_.inputDirectory);
+    }
+  }
+}
+
+void GetFile::onUnSchedule() {
+  std::lock_guard<std::mutex> lock(watcher_mutex_);
+  watcher_.reset();
 }
 
 void GetFile::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
@@ -161,10 +201,21 @@ void GetFile::onTrigger(core::ProcessContext *context, core::ProcessSession *ses
 
   metrics_->iterations_++;
 
+  bool watching = false;
+  {
+    std::unique_lock<std::mutex> lock(watcher_mutex_, std::try_to_lock);
+    if (lock.owns_lock() && watcher_) {
+      processEvents(request_);
+      watching = true;
+    }
+  }
+
   const bool isDirEmptyBeforePoll = isListingEmpty();
   logger_->log_debug("Is listing empty before polling directory %i", isDirEmptyBeforePoll);
   if (isDirEmptyBeforePoll) {
-    if (request_.pollInterval == 0 || (getTimeMillis() - last_listing_time_) > request_.pollInterval) {
+    const uint64_t listingInterval = watching && !listing_incomplete_ ? request_.reconciliationInterval : request_.pollInterval;
+    if (last_listing_time_ == 0 || listingInterval == 0 || (getTimeMillis() - last_listing_time_) > listingInterval) {
+      listing_incomplete_ = false;
       performListing(request_);
       last_listing_time_.store(getTimeMillis());
     }
@@ -213,7 +264,9 @@ void GetFile::putListing(std::string fileName) {
 
   std::lock_guard<std::mutex> lock(mutex_);
 
-  _dirList.push(fileName);
+  if (listed_files_.insert(fileName).second) {
+    _dirList.push(fileName);
+  }
 }
 
 void GetFile::pollListing(std::queue<std::string> &list, const GetFileRequest &request) {
@@ -221,20 +274,22 @@ void GetFile::pollListing(std::queue<std::string> &list, const GetFileRequest &r
 
   while (!_dirList.empty() && (request.batchSize == 0 || list.size() < request.batchSize)) {
     list.push(_dirList.front());
+    listed_files_.erase(_dirList.front());
     _dirList.pop();
   }
 }
 
-bool GetFile::acceptFile(std::string fullName, std::string name, const GetFileRequest &request) {
+bool GetFile::acceptFile(const std::string &fullName, const std::string &name, const GetFileRequest &request, utils::Regex &fileFilter) {
   logger_->log_trace("Checking file: %s", fullName);
 
   struct stat statbuf;
 
   if (stat(fullName.c_str(), &statbuf) == 0) {
-    if (request.minSize > 0 && statbuf.st_size < (int32_t) request.minSize)
+    const uint64_t fileSize = statbuf.st_size;
+    if (request.minSize > 0 && fileSize < request.minSize)
       return false;
 
-    if (request.maxSize > 0 && statbuf.st_size > (int32_t) request.maxSize)
+    if (request.maxSize > 0 && fileSize > request.maxSize)
       return false;
 
     uint64_t modifiedTime = ((uint64_t) (statbuf.st_mtime) * 1000);
@@ -253,8 +308,7 @@ bool GetFile::acceptFile(std::string fullName, std::string name, const GetFileRe
     if (request.keepSourceFile == false && access(fullName.c_str(), W_OK) != 0)
       return false;
 
-    utils::Regex rgx(request.fileFilter);
-    if (!rgx.match(name)) {
+    if (!fileFilter.match(name)) {
       return false;
     }
 
@@ -267,9 +321,10 @@ bool GetFile::acceptFile(std::string fullName, std::string name, const GetFileRe
 }
 
 void GetFile::performListing(const GetFileRequest &request) {
-  auto callback = [this, request](const std::string& dir, const std::string& filename) -> bool {
+  utils::Regex fileFilter(request.fileFilter);
+  auto callback = [this, &request, &fileFilter](const std::string& dir, const std::string& filename) -> bool {
     std::string fullpath = dir + utils::file::FileUtils::get_separator() + filename;
-    if (acceptFile(fullpath, filename, request)) {
+    if (acceptFile(fullpath, filename, request, fileFilter)) {
       putListing(fullpath);
     }
     return isRunning();
@@ -277,6 +332,26 @@ void GetFile::performListing(const GetFileRequest &request) {
   utils::file::FileUtils::list_dir(request.inputDirectory, callback, logger_, request.recursive);
 }
 
+void GetFile::processEvents(const GetFileRequest &request) {
+  std::vector<utils::file::DirectoryWatcher::Event> events;
+  if (!watcher_->poll(events)) {
+    listing_incomplete_ = true;
+  }
+  if (events.empty()) {
+    return;
+  }
+  utils::Regex fileFilter(request.fileFilter);
+  for (const auto &event : events) {
+    if (event.type != utils::file::DirectoryWatcher::EventType::WRITTEN) {
+      continue;
+    }
+    std::string fullpath = event.directory + utils::file::FileUtils::get_separator() + event.filename;
+    if (acceptFile(fullpath, event.filename, request, fileFilter)) {
+      putListing(fullpath);
+    }
+  }
+}
+
 int16_t GetFile::getMetricNodes(std::vector<std::shared_ptr<state::response::ResponseNode>> &metric_vector) {
   metric_vector.push_back(metrics_);
   return 0;
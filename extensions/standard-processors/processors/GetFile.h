@@ -21,6 +21,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <atomic>
 
@@ -31,6 +32,8 @@
 #include "core/Core.h"
 #include "core/Resource.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/RegexUtils.h"
+#include "utils/file/DirectoryWatcher.h"
 
 namespace org {
 namespace apache {
@@ -50,6 +53,8 @@ struct GetFileRequest {
   uint64_t batchSize = 10;
   std::string fileFilter = "[^\\.].*";
   std::string inputDirectory;
+  bool watchDirectory = false;
+  uint64_t reconciliationInterval = 300000;
 };
 
 class GetFileMetrics : public state::response::ResponseNode {
@@ -115,6 +120,7 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
       : Processor(name, uuid),
         metrics_(std::make_shared<GetFileMetrics>()),
         last_listing_time_(0),
+        listing_incomplete_(false),
         logger_(logging::LoggerFactory<GetFile>::getLogger()) {
   }
   // Destructor
@@ -134,6 +140,8 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
   static core::Property PollInterval;
   static core::Property BatchSize;
   static core::Property FileFilter;
+  static core::Property WatchDirectory;
+  static core::Property ReconciliationInterval;
   // Supported Relationships
   static core::Relationship Success;
 
@@ -152,6 +160,8 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
    */
   void onTrigger(core::ProcessContext *context, core::ProcessSession *session) override;
 
+  void onUnSchedule() override;
+
   // Initialize, over write by NiFi GetFile
   void initialize(void) override;
   /**
@@ -167,6 +177,8 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
 
   // Queue for store directory list
   std::queue<std::string> _dirList;
+  // Files in the directory listing, events may report a file that is already listed
+  std::unordered_set<std::string> listed_files_;
   // Whether the directory listing is empty
   bool isListingEmpty();
   // Put full path file name into directory listing
@@ -174,7 +186,9 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
   // Poll directory listing for files
   void pollListing(std::queue<std::string> &list, const GetFileRequest &request);
   // Check whether file can be added to the directory listing
-  bool acceptFile(std::string fullName, std::string name, const GetFileRequest &request);
+  bool acceptFile(const std::string &fullName, const std::string &name, const GetFileRequest &request, utils::Regex &fileFilter);
+  // Adds the files reported by the directory watcher to the listing
+  void processEvents(const GetFileRequest &request);
   // Get file request object.
   GetFileRequest request_;
   // Mutex for protection of the directory listing
@@ -185,6 +199,12 @@ class GetFile : public core::Processor, public state::response::MetricsNodeSourc
   // as the top level time.
   std::atomic<uint64_t> last_listing_time_;
 
+  // Watches the input directory if Watch Input Directory is set and inotify is available
+  std::unique_ptr<utils::file::DirectoryWatcher> watcher_;
+  std::mutex watcher_mutex_;
+  // Events were lost, the next listing should not wait for the reconciliation interval
+  std::atomic<bool> listing_incomplete_;
+
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -19,11 +19,20 @@
  */
 #include "ListenSyslog.h"
 #include <stdio.h>
+#ifndef WIN32
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#endif
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 #include <set>
-#include <queue>
 #include "utils/TimeUtil.h"
 #include "utils/StringUtils.h"
 #include "core/ProcessContext.h"
@@ -51,6 +60,11 @@ core::Property ListenSyslog::MaxConnections(
 core::Property ListenSyslog::MaxBatchSize(
     core::PropertyBuilder::createProperty("Max Batch Size")->withDescription("The maximum number of Syslog events to add to a single FlowFile.")->withDefaultValue<int>(1)->build());
 
+core::Property ListenSyslog::MaxQueueSize(
+    core::PropertyBuilder::createProperty("Max Size of Message Queue")->withDescription("The maximum number of Syslog events that can be held in memory before they are written to "
+                                                                                        "FlowFiles. Events received while the queue is full are dropped.")
+        ->withDefaultValue<int>(10000)->build());
+
 core::Property ListenSyslog::MessageDelimiter(
     core::PropertyBuilder::createProperty("Message Delimiter")->withDescription("Specifies the delimiter to place between Syslog messages when multiple "
                                                                                 "messages are bundled together (see <Max Batch Size> core::Property).")->withDefaultValue("\n")->build());
@@ -76,6 +90,7 @@ void ListenSyslog::initialize() {
   properties.insert(MaxSocketBufSize);
   properties.insert(MaxConnections);
   properties.insert(MaxBatchSize);
+  properties.insert(MaxQueueSize);
   properties.insert(MessageDelimiter);
   properties.insert(ParseMessages);
   properties.insert(Protocol);
@@ -89,13 +104,12 @@ void ListenSyslog::initialize() {
 }
 
 void ListenSyslog::startSocketThread() {
-  if (_thread != NULL)
+  if (_thread.joinable())
     return;
 
   logger_->log_trace("ListenSysLog Socket Thread Start");
   _serverTheadRunning = true;
-  _thread = new std::thread(run, this);
-  _thread->detach();
+  _thread = std::thread(run, this);
 }
 
 void ListenSyslog::run(ListenSyslog *process) {
@@ -103,149 +117,240 @@ void ListenSyslog::run(ListenSyslog *process) {
 }
 
 void ListenSyslog::runThread() {
+  std::vector<int> readySockets;
   while (_serverTheadRunning) {
     if (_resetServerSocket) {
       _resetServerSocket = false;
-      // need to reset the socket
-      std::vector<int>::iterator it;
-      for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-        int clientSocket = *it;
-        close(clientSocket);
-      }
-      _clientSockets.clear();
-      if (_serverSocket > 0) {
-        close(_serverSocket);
-        _serverSocket = 0;
-      }
+      closeSockets();
     }
 
-    if (_serverSocket <= 0) {
-      uint16_t portno = _port;
-      struct sockaddr_in serv_addr;
-      int sockfd;
-      if (_protocol == "TCP")
-        sockfd = socket(AF_INET, SOCK_STREAM, 0);
-      else
-        sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-      if (sockfd < 0) {
-        logger_->log_error("ListenSysLog Server socket creation failed");
-        break;
-      }
-      bzero(reinterpret_cast<char *>(&serv_addr), sizeof(serv_addr));
-      serv_addr.sin_family = AF_INET;
-      serv_addr.sin_addr.s_addr = INADDR_ANY;
-      serv_addr.sin_port = htons(portno);
-      if (bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
-        logger_->log_error("ListenSysLog Server socket bind failed");
-        break;
-      }
-      if (_protocol == "TCP")
-        listen(sockfd, 5);
-      _serverSocket = sockfd;
-      logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", _serverSocket, portno);
-    }
-    FD_ZERO(&_readfds);
-    FD_SET(_serverSocket, &_readfds);
-    _maxFds = _serverSocket;
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      if (clientSocket >= _maxFds)
-        _maxFds = clientSocket;
-      FD_SET(clientSocket, &_readfds);
-    }
-    fd_set fds;
-    struct timeval tv;
-    int retval;
-    fds = _readfds;
-    tv.tv_sec = 0;
-    // 100 msec
-    tv.tv_usec = 100000;
-    retval = select(_maxFds + 1, &fds, NULL, NULL, &tv);
-    if (retval < 0)
+    if (_serverSocket <= 0 && !openServerSocket()) {
       break;
-    if (retval == 0)
-      continue;
-    if (FD_ISSET(_serverSocket, &fds)) {
-      // server socket, either we have UDP datagram or TCP connection request
-      if (_protocol == "TCP") {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int newsockfd = accept(_serverSocket, reinterpret_cast<struct sockaddr *>(&cli_addr), &clilen);
-        if (newsockfd > 0) {
-          if (_clientSockets.size() < (uint64_t) _maxConnections) {
-            _clientSockets.push_back(newsockfd);
-            logger_->log_info("ListenSysLog new client socket %d connection", newsockfd);
-            continue;
-          } else {
-            close(newsockfd);
-          }
-        }
-      } else {
-        socklen_t clilen;
-        struct sockaddr_in cli_addr;
-        clilen = sizeof(cli_addr);
-        int recvlen = recvfrom(_serverSocket, _buffer, sizeof(_buffer), 0, (struct sockaddr *) &cli_addr, &clilen);
-        if (recvlen > 0 && (uint64_t) (recvlen + getEventQueueByteSize()) <= _recvBufSize) {
-          uint8_t *payload = new uint8_t[recvlen];
-          memcpy(payload, _buffer, recvlen);
-          putEvent(payload, recvlen);
-        }
-      }
     }
-    it = _clientSockets.begin();
-    while (it != _clientSockets.end()) {
-      int clientSocket = *it;
-      if (FD_ISSET(clientSocket, &fds)) {
-        int recvlen = readline(clientSocket, _buffer, sizeof(_buffer));
-        if (recvlen <= 0) {
-          close(clientSocket);
-          logger_->log_debug("ListenSysLog client socket %d close", clientSocket);
-          it = _clientSockets.erase(it);
-        } else {
-          if ((uint64_t) (recvlen + getEventQueueByteSize()) <= _recvBufSize) {
-            uint8_t *payload = new uint8_t[recvlen];
-            memcpy(payload, _buffer, recvlen);
-            putEvent(payload, recvlen);
-          }
-          ++it;
-        }
+
+    readySockets.clear();
+    if (!waitForSockets(readySockets))
+      break;
+    for (int socket : readySockets) {
+      if (socket == _serverSocket) {
+        // server socket, either we have UDP datagrams or TCP connection requests
+        if (_protocol == "TCP")
+          acceptClient();
+        else
+          receiveDatagrams();
+      } else if (!receiveStream(socket)) {
+        logger_->log_debug("ListenSysLog client socket %d close", socket);
+#ifdef __linux__
+        epoll_ctl(_pollFd, EPOLL_CTL_DEL, socket, nullptr);
+#endif
+        close(socket);
+        _clientSockets.erase(socket);
       }
     }
   }
   return;
 }
 
-int ListenSyslog::readline(int fd, char *bufptr, size_t len) {
-  char *bufx = bufptr;
-  static char *bp;
-  static int cnt = 0;
-  static char b[2048];
-  char c;
-
-  while (--len > 0) {
-    if (--cnt <= 0) {
-      cnt = recv(fd, b, sizeof(b), 0);
-      if (cnt < 0) {
-        if (errno == EINTR) {
-          len++; /* the while will decrement */
-          continue;
-        }
-        return -1;
+bool ListenSyslog::openServerSocket() {
+  uint16_t portno = _port;
+  struct sockaddr_in serv_addr;
+  int sockfd;
+  if (_protocol == "TCP")
+    sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  else
+    sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sockfd < 0) {
+    logger_->log_error("ListenSysLog Server socket creation failed");
+    return false;
+  }
+  if (_maxSocketBufSize > 0) {
+    int bufSize = static_cast<int>(_maxSocketBufSize);
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+  }
+  bzero(reinterpret_cast<char *>(&serv_addr), sizeof(serv_addr));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr = INADDR_ANY;
+  serv_addr.sin_port = htons(portno);
+  if (bind(sockfd, (struct sockaddr *) &serv_addr, sizeof(serv_addr)) < 0) {
+    logger_->log_error("ListenSysLog Server socket bind failed");
+    close(sockfd);
+    return false;
+  }
+  if (_protocol == "TCP")
+    listen(sockfd, 5);
+#ifdef __linux__
+  _pollFd = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = sockfd;
+  if (_pollFd < 0 || epoll_ctl(_pollFd, EPOLL_CTL_ADD, sockfd, &event) < 0) {
+    logger_->log_error("ListenSysLog could not poll the server socket: %s", strerror(errno));
+    close(sockfd);
+    return false;
+  }
+#endif
+  // UDP receives a batch of datagrams at once, TCP reads up to a whole buffer
+  _recvBuffer.resize(_protocol == "TCP" ? _recvBufSize : RECEIVE_BATCH_SIZE * _recvBufSize);
+  _serverSocket = sockfd;
+  logger_->log_info("ListenSysLog Server socket %d bind OK to port %d", _serverSocket, portno);
+  return true;
+}
+
+void ListenSyslog::closeSockets() {
+  for (const auto &client : _clientSockets) {
+    close(client.first);
+  }
+  _clientSockets.clear();
+  if (_pollFd >= 0) {
+    close(_pollFd);
+    _pollFd = -1;
+  }
+  if (_serverSocket > 0) {
+    logger_->log_debug("ListenSysLog Server socket %d close", _serverSocket);
+    close(_serverSocket);
+    _serverSocket = 0;
+  }
+}
+
+bool ListenSyslog::waitForSockets(std::vector<int> &readySockets) {
+  // 100 msec, so that the thread notices when it is stopped
+  const int timeout = 100;
+#ifdef __linux__
+  struct epoll_event events[64];
+  int retval = epoll_wait(_pollFd, events, 64, timeout);
+  if (retval < 0)
+    return errno == EINTR;
+  for (int i = 0; i < retval; ++i) {
+    readySockets.push_back(events[i].data.fd);
+  }
+#else
+  std::vector<struct pollfd> fds;
+  fds.push_back({_serverSocket, POLLIN, 0});
+  for (const auto &client : _clientSockets) {
+    fds.push_back({client.first, POLLIN, 0});
+  }
+  int retval = poll(fds.data(), fds.size(), timeout);
+  if (retval < 0)
+    return errno == EINTR;
+  for (const auto &fd : fds) {
+    if (fd.revents != 0)
+      readySockets.push_back(fd.fd);
+  }
+#endif
+  return true;
+}
+
+void ListenSyslog::acceptClient() {
+  socklen_t clilen;
+  struct sockaddr_in cli_addr;
+  clilen = sizeof(cli_addr);
+  int newsockfd = accept(_serverSocket, reinterpret_cast<struct sockaddr *>(&cli_addr), &clilen);
+  if (newsockfd < 0)
+    return;
+  if (_clientSockets.size() >= (uint64_t) _maxConnections) {
+    close(newsockfd);
+    return;
+  }
+#ifdef __linux__
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = newsockfd;
+  if (epoll_ctl(_pollFd, EPOLL_CTL_ADD, newsockfd, &event) < 0) {
+    close(newsockfd);
+    return;
+  }
+#endif
+  _clientSockets[newsockfd];
+  logger_->log_info("ListenSysLog new client socket %d connection", newsockfd);
+}
+
+void ListenSyslog::receiveDatagrams() {
+  // the buffer was sized when the socket was opened, Receive Buffer Size may have changed since
+  const size_t slot_size = _recvBuffer.size() / RECEIVE_BATCH_SIZE;
+#ifdef __linux__
+  struct mmsghdr messages[RECEIVE_BATCH_SIZE];
+  struct iovec iovecs[RECEIVE_BATCH_SIZE];
+  std::memset(messages, 0, sizeof(messages));
+  for (int i = 0; i < RECEIVE_BATCH_SIZE; ++i) {
+    iovecs[i].iov_base = _recvBuffer.data() + i * slot_size;
+    iovecs[i].iov_len = slot_size;
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  int received;
+  do {
+    received = recvmmsg(_serverSocket, messages, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    for (int i = 0; i < received; ++i) {
+      if (messages[i].msg_len > 0)
+        putEvent(reinterpret_cast<uint8_t *>(iovecs[i].iov_base), messages[i].msg_len);
+    }
+  } while (received == RECEIVE_BATCH_SIZE);
+#else
+  int recvlen;
+  while ((recvlen = recvfrom(_serverSocket, _recvBuffer.data(), slot_size, MSG_DONTWAIT, nullptr, nullptr)) > 0) {
+    putEvent(_recvBuffer.data(), recvlen);
+  }
+#endif
+}
+
+bool ListenSyslog::receiveStream(int clientSocket) {
+  int recvlen = recv(clientSocket, _recvBuffer.data(), _recvBuffer.size(), MSG_DONTWAIT);
+  if (recvlen == 0)
+    return false;
+  if (recvlen < 0)
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+
+  // messages are delimited by new lines, a message too long for the receive buffer is split
+  std::vector<uint8_t> &partial = _clientSockets[clientSocket];
+  const uint8_t *begin = _recvBuffer.data();
+  const uint8_t *end = begin + recvlen;
+  while (begin < end) {
+    const uint8_t *newline = static_cast<const uint8_t *>(std::memchr(begin, '\n', end - begin));
+    if (newline == nullptr) {
+      partial.insert(partial.end(), begin, end);
+      if (partial.size() >= (uint64_t) _recvBufSize) {
+        putEvent(partial.data(), partial.size());
+        partial.clear();
       }
-      if (cnt == 0)
-        return 0;
-      bp = b;
+      break;
     }
-    c = *bp++;
-    *bufptr++ = c;
-    if (c == '\n') {
-      *bufptr = '\n';
-      return bufptr - bufx + 1;
+    if (partial.empty()) {
+      putEvent(begin, newline - begin);
+    } else {
+      partial.insert(partial.end(), begin, newline);
+      putEvent(partial.data(), partial.size());
+      partial.clear();
     }
+    begin = newline + 1;
   }
-  return -1;
+  return true;
+}
+
+void ListenSyslog::putEvent(const uint8_t *payload, uint64_t len) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (_maxQueueSize > 0 && _eventQueue.size() >= (uint64_t) _maxQueueSize) {
+    if (_droppedEvents++ == 0)
+      logger_->log_warn("ListenSysLog event queue is full, dropping events");
+    return;
+  }
+  SysLogEvent event;
+  if (!_bufferPool.empty()) {
+    event.payload = std::move(_bufferPool.back());
+    _bufferPool.pop_back();
+  }
+  event.payload.assign(payload, payload + len);
+  _eventQueue.push_back(std::move(event));
+}
+
+void ListenSyslog::releaseEvents(std::vector<SysLogEvent> &events) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &event : events) {
+    // keep the pool as large as a full queue at most
+    if (_maxQueueSize <= 0 || _bufferPool.size() + _eventQueue.size() >= (uint64_t) _maxQueueSize)
+      break;
+    _bufferPool.push_back(std::move(event.payload));
+  }
+  events.clear();
 }
 
 void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
@@ -257,7 +362,10 @@ void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession
     _protocol = value;
   }
   if (context->getProperty(RecvBufSize.getName(), value)) {
+    int64_t oldRecvBufSize = _recvBufSize;
     core::Property::StringToInt(value, _recvBufSize);
+    if (_recvBufSize != oldRecvBufSize)
+      needResetServerSocket = true;
   }
   if (context->getProperty(MaxSocketBufSize.getName(), value)) {
     core::Property::StringToInt(value, _maxSocketBufSize);
@@ -280,42 +388,45 @@ void ListenSyslog::onTrigger(core::ProcessContext *context, core::ProcessSession
   if (context->getProperty(MaxBatchSize.getName(), value)) {
     core::Property::StringToInt(value, _maxBatchSize);
   }
+  if (context->getProperty(MaxQueueSize.getName(), value)) {
+    core::Property::StringToInt(value, _maxQueueSize);
+  }
 
   if (needResetServerSocket)
     _resetServerSocket = true;
 
   startSocketThread();
 
+  const uint64_t dropped = _droppedEvents.exchange(0);
+  if (dropped > 0) {
+    logger_->log_warn("ListenSysLog dropped %" PRIu64 " events since the event queue was full", dropped);
+  }
+
   // read from the event queue
   if (isEventQueueEmpty()) {
     context->yield();
     return;
   }
 
-  std::queue<SysLogEvent> eventQueue;
-  pollEvent(eventQueue, _maxBatchSize);
-  bool firstEvent = true;
-  std::shared_ptr<FlowFileRecord> flowFile = NULL;
-  while (!eventQueue.empty()) {
-    SysLogEvent event = eventQueue.front();
-    eventQueue.pop();
-    if (firstEvent) {
-      flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
-      if (!flowFile)
-        return;
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->write(flowFile, &callback);
-      delete[] event.payload;
-      firstEvent = false;
-    } else {
-      ListenSyslog::WriteCallback callback(event.payload, event.len);
-      session->append(flowFile, &callback);
-      delete[] event.payload;
-    }
+  // the events queued so far are written, the ones arriving meanwhile are left to the next trigger
+  uint64_t remaining = getEventQueueSize();
+  std::vector<SysLogEvent> events;
+  while (remaining > 0) {
+    pollEvent(events, _maxBatchSize);
+    if (events.empty())
+      break;
+    remaining -= (std::min)(remaining, static_cast<uint64_t>(events.size()));
+
+    std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
+    if (!flowFile)
+      return;
+    ListenSyslog::WriteCallback callback(events, _messageDelimiter);
+    session->write(flowFile, &callback);
+    flowFile->addAttribute("syslog.protocol", _protocol);
+    flowFile->addAttribute("syslog.port", std::to_string(_port));
+    session->transfer(flowFile, Success);
+    releaseEvents(events);
   }
-  flowFile->addAttribute("syslog.protocol", _protocol);
-  flowFile->addAttribute("syslog.port", std::to_string(_port));
-  session->transfer(flowFile, Success);
 }
 #endif
 } /* namespace processors */
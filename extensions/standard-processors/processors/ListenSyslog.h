@@ -23,15 +23,16 @@
 #include <stdio.h>
 #include <sys/types.h>
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
 #ifndef WIN32
 #include <arpa/inet.h>
 #include <netinet/in.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 
@@ -60,11 +61,10 @@ namespace minifi {
 namespace processors {
 
 
-// SyslogEvent
-typedef struct {
-  char *payload;
-  uint64_t len;
-} SysLogEvent;
+// SyslogEvent, the payload buffer is taken from and returned to the buffer pool of the processor
+struct SysLogEvent {
+  std::vector<uint8_t> payload;
+};
 
 // ListenSyslog Class
 class ListenSyslog : public core::Processor {
@@ -76,48 +76,38 @@ class ListenSyslog : public core::Processor {
   ListenSyslog(std::string name,  utils::Identifier uuid = utils::Identifier()) // NOLINT
       : Processor(name, uuid),
         logger_(logging::LoggerFactory<ListenSyslog>::getLogger()) {
-    _eventQueueByteSize = 0;
     _serverSocket = 0;
+    _pollFd = -1;
     _recvBufSize = 65507;
     _maxSocketBufSize = 1024 * 1024;
     _maxConnections = 2;
     _maxBatchSize = 1;
+    _maxQueueSize = 10000;
     _messageDelimiter = "\n";
     _protocol = "UDP";
     _port = 514;
     _parseMessages = false;
-    _serverSocket = 0;
-    _maxFds = 0;
-    FD_ZERO(&_readfds);
-    _thread = NULL;
+    _droppedEvents = 0;
     _resetServerSocket = false;
     _serverTheadRunning = false;
   }
   // Destructor
   virtual ~ListenSyslog() {
     _serverTheadRunning = false;
-    if (this->_thread)
-      delete this->_thread;
-    // need to reset the socket
-    std::vector<int>::iterator it;
-    for (it = _clientSockets.begin(); it != _clientSockets.end(); ++it) {
-      int clientSocket = *it;
-      close(clientSocket);
-    }
-    _clientSockets.clear();
-    if (_serverSocket > 0) {
-      logger_->log_debug("ListenSysLog Server socket %d close", _serverSocket);
-      close(_serverSocket);
-      _serverSocket = 0;
-    }
+    if (_thread.joinable())
+      _thread.join();
+    closeSockets();
   }
   // Processor Name
   static constexpr char const *ProcessorName = "ListenSyslog";
+  // Number of datagrams received with a single system call
+  static constexpr int RECEIVE_BATCH_SIZE = 32;
   // Supported Properties
   static core::Property RecvBufSize;
   static core::Property MaxSocketBufSize;
   static core::Property MaxConnections;
   static core::Property MaxBatchSize;
+  static core::Property MaxQueueSize;
   static core::Property MessageDelimiter;
   static core::Property ParseMessages;
   static core::Property Protocol;
@@ -128,16 +118,26 @@ class ListenSyslog : public core::Processor {
   // Nest Callback Class for write stream
   class WriteCallback : public OutputStreamCallback {
    public:
-    WriteCallback(char *data, uint64_t size)
-        : _data(reinterpret_cast<uint8_t*>(data)),
-          _dataSize(size) {
+    WriteCallback(const std::vector<SysLogEvent> &events, const std::string &delimiter)
+        : _events(events),
+          _delimiter(delimiter) {
     }
-    uint8_t *_data;
-    uint64_t _dataSize;
+    const std::vector<SysLogEvent> &_events;
+    const std::string &_delimiter;
     int64_t process(std::shared_ptr<io::BaseStream> stream) {
       int64_t ret = 0;
-      if (_data && _dataSize > 0)
-        ret = stream->write(_data, _dataSize);
+      for (const auto &event : _events) {
+        if (ret > 0 && !_delimiter.empty()) {
+          if (stream->write(reinterpret_cast<uint8_t*>(const_cast<char*>(_delimiter.data())), _delimiter.size()) < 0)
+            return -1;
+          ret += _delimiter.size();
+        }
+        if (!event.payload.empty()) {
+          if (stream->write(const_cast<uint8_t*>(event.payload.data()), event.payload.size()) < 0)
+            return -1;
+          ret += event.payload.size();
+        }
+      }
       return ret;
     }
   };
@@ -156,69 +156,72 @@ class ListenSyslog : public core::Processor {
   // Run Thread
   void runThread();
   // Queue for store syslog event
-  std::queue<SysLogEvent> _eventQueue;
-  // Size of Event queue in bytes
-  uint64_t _eventQueueByteSize;
+  std::deque<SysLogEvent> _eventQueue;
+  // Buffers of the events already written, reused for the next events
+  std::vector<std::vector<uint8_t>> _bufferPool;
   // Get event queue size
   uint64_t getEventQueueSize() {
     std::lock_guard<std::mutex> lock(mutex_);
     return _eventQueue.size();
   }
-  // Get event queue byte size
-  uint64_t getEventQueueByteSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return _eventQueueByteSize;
-  }
   // Whether the event queue  is empty
   bool isEventQueueEmpty() {
     std::lock_guard<std::mutex> lock(mutex_);
     return _eventQueue.empty();
   }
-  // Put event into directory listing
-  void putEvent(uint8_t *payload, uint64_t len) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    SysLogEvent event;
-    event.payload = reinterpret_cast<char*>(payload);
-    event.len = len;
-    _eventQueue.push(event);
-    _eventQueueByteSize += len;
-  }
-  // Read \n terminated line from TCP socket
-  int readline(int fd, char *bufptr, size_t len);
+  // Put event into the event queue, unless the queue is full
+  void putEvent(const uint8_t *payload, uint64_t len);
+  // Returns the payload buffers of the written events to the pool
+  void releaseEvents(std::vector<SysLogEvent> &events);
+  // open the server socket and register it for polling
+  bool openServerSocket();
+  // close the server and client sockets
+  void closeSockets();
+  // wait for sockets with data or connection requests
+  bool waitForSockets(std::vector<int> &readySockets);
+  // accept a TCP connection
+  void acceptClient();
+  // receive the pending UDP datagrams
+  void receiveDatagrams();
+  // receive the data of a TCP client and split it into messages, false if the client is gone
+  bool receiveStream(int clientSocket);
   // start server socket and handling client socket
   void startSocketThread();
   // Poll event
-  void pollEvent(std::queue<SysLogEvent> &list, int maxSize) {
+  void pollEvent(std::vector<SysLogEvent> &list, int maxSize) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     while (!_eventQueue.empty() && (maxSize == 0 || list.size() < maxSize)) {
-      SysLogEvent event = _eventQueue.front();
-      _eventQueue.pop();
-      _eventQueueByteSize -= event.len;
-      list.push(event);
+      list.push_back(std::move(_eventQueue.front()));
+      _eventQueue.pop_front();
     }
     return;
   }
-  // Mutex for protection of the directory listing
+  // Mutex for protection of the event queue and the buffer pool
   std::mutex mutex_;
   int64_t _recvBufSize;
   int64_t _maxSocketBufSize;
   int64_t _maxConnections;
   int64_t _maxBatchSize;
+  int64_t _maxQueueSize;
   std::string _messageDelimiter;
   std::string _protocol;
   int64_t _port;
   bool _parseMessages;
   int _serverSocket;
-  std::vector<int> _clientSockets;
-  int _maxFds;
-  fd_set _readfds;
+  // epoll instance of the server and client sockets
+  int _pollFd;
+  // client sockets with the partial message received from them
+  std::map<int, std::vector<uint8_t>> _clientSockets;
+  // buffer for read socket
+  std::vector<uint8_t> _recvBuffer;
+  // events dropped since the queue was full
+  std::atomic<uint64_t> _droppedEvents;
   // thread
-  std::thread *_thread;
+  std::thread _thread;
   // whether to reset the server socket
-  bool _resetServerSocket; bool _serverTheadRunning;
-  // buffer for read socket
-  char _buffer[2048];
+  std::atomic<bool> _resetServerSocket;
+  std::atomic<bool> _serverTheadRunning;
 };
 
 REGISTER_RESOURCE(ListenSyslog, "Listens for Syslog messages being sent to a given port over TCP or UDP. Incoming messages are checked against regular expressions for RFC5424 and RFC3164 formatted messages. " // NOLINT
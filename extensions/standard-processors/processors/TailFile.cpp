@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -31,6 +32,7 @@
 #include <utility>
 #include <vector>
 
+#include "io/BufferedFileStream.h"
 #include "io/CRCStream.h"
 #include "utils/file/FileUtils.h"
 #include "utils/file/PathUtils.h"
@@ -108,6 +110,22 @@ core::Property TailFile::RollingFilenamePattern(
         ->withDefaultValue<std::string>("${filename}.*")
         ->build());
 
+core::Property TailFile::LinesPerFlowFile(
+    core::PropertyBuilder::createProperty("Lines Per Flow File")
+        ->withDescription("The maximum number of delimited lines written into a single flow file, 0 means all the complete lines available. "
+        "Only used when an Input Delimiter is set.")
+        ->isRequired(false)
+        ->withDefaultValue<uint64_t>(1)
+        ->build());
+
+core::Property TailFile::WatchForChanges(
+    core::PropertyBuilder::createProperty("Watch For Changes")
+        ->withDescription("If true, only the files the file system reports as changed are read on a trigger, instead of checking every tailed file. "
+        "Only available on Linux, other platforms keep checking every file.")
+        ->isRequired(false)
+        ->withDefaultValue<bool>(false)
+        ->build());
+
 core::Relationship TailFile::Success("success", "All files are routed to success");
 
 const char *TailFile::CURRENT_STR = "CURRENT.";
@@ -172,68 +190,74 @@ struct TailStateWithMtime {
   TimePoint mtime_;
 };
 
-void openFile(const std::string &file_name, uint64_t offset, std::ifstream &input_stream, const std::shared_ptr<logging::Logger> &logger) {
+// tailed files are read in large chunks, which are scanned for delimiters in place
+constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+std::unique_ptr<io::BufferedFileStream> openFile(const std::string &file_name, uint64_t offset, const std::shared_ptr<logging::Logger> &logger) {
   logger->log_debug("Opening %s", file_name);
-  input_stream.open(file_name.c_str(), std::fstream::in | std::fstream::binary);
-  if (!input_stream.is_open() || !input_stream.good()) {
-    input_stream.close();
+  // the callbacks read into their own buffers, with a single byte buffer every read of the stream goes straight to the file
+  std::unique_ptr<io::BufferedFileStream> input_stream(new io::BufferedFileStream(file_name, offset, false, 1));
+  if (input_stream->getSize() == 0) {
     throw Exception(FILE_OPERATION_EXCEPTION, "Could not open file: " + file_name);
   }
-  if (offset != 0U) {
-    input_stream.seekg(offset, std::ifstream::beg);
-    if (!input_stream.good()) {
-      logger->log_error("Seeking to %" PRIu64 " failed for file %s (does file/filesystem support seeking?)", offset, file_name);
-      throw Exception(FILE_OPERATION_EXCEPTION, "Could not seek file " + file_name + " to offset " + std::to_string(offset));
-    }
-  }
+  return input_stream;
 }
 
-constexpr std::size_t BUFFER_SIZE = 4096;
-
 class FileReaderCallback : public OutputStreamCallback {
  public:
   FileReaderCallback(const std::string &file_name,
                      uint64_t offset,
                      char input_delimiter,
-                     uint64_t checksum)
+                     uint64_t checksum,
+                     uint64_t lines_per_flow_file)
     : input_delimiter_(input_delimiter),
       checksum_(checksum),
-      logger_(logging::LoggerFactory<TailFile>::getLogger()) {
-    openFile(file_name, offset, input_stream_, logger_);
+      lines_per_flow_file_(lines_per_flow_file),
+      logger_(logging::LoggerFactory<TailFile>::getLogger()),
+      buffer_(BUFFER_SIZE) {
+    input_stream_ = openFile(file_name, offset, logger_);
+    begin_ = end_ = buffer_.data();
   }
 
   int64_t process(std::shared_ptr<io::BaseStream> output_stream) override {
     io::CRCStream<io::BaseStream> crc_stream{output_stream.get(), checksum_};
 
     uint64_t num_bytes_written = 0;
-    bool found_delimiter = false;
-
-    while (hasMoreToRead() && !found_delimiter) {
-      if (begin_ == end_) {
-        input_stream_.read(reinterpret_cast<char *>(buffer_.data()), buffer_.size());
-
-        const auto num_bytes_read = input_stream_.gcount();
-        logger_->log_trace("Read %jd bytes of input", std::intmax_t{num_bytes_read});
-
-        begin_ = buffer_.data();
-        end_ = begin_ + num_bytes_read;
+    uint64_t num_lines = 0;
+
+    // only complete lines are written, except for a line longer than the buffer, which is written as it is read
+    while (lines_per_flow_file_ == 0 || num_lines < lines_per_flow_file_) {
+      const auto delimiter_pos = static_cast<char *>(std::memchr(begin_, input_delimiter_, end_ - begin_));
+      if (delimiter_pos != nullptr) {
+        const int len = gsl::narrow<int>(delimiter_pos + 1 - begin_);
+        crc_stream.write(reinterpret_cast<uint8_t*>(begin_), len);
+        num_bytes_written += len;
+        begin_ += len;
+        ++num_lines;
+        continue;
       }
 
-      char *delimiter_pos = std::find(begin_, end_, input_delimiter_);
-      found_delimiter = (delimiter_pos != end_);
-
-      ptrdiff_t zlen{std::distance(begin_, delimiter_pos)};
-      if (found_delimiter) {
-        zlen += 1;
+      if (end_of_file_) {
+        break;
       }
-      const int len = gsl::narrow<int>(zlen);
-
-      crc_stream.write(reinterpret_cast<uint8_t*>(begin_), len);
-      num_bytes_written += len;
-      begin_ += len;
+      if (begin_ == buffer_.data() && end_ == buffer_.data() + buffer_.size()) {
+        if (num_lines > 0) {
+          break;
+        }
+        const int len = gsl::narrow<int>(end_ - begin_);
+        crc_stream.write(reinterpret_cast<uint8_t*>(begin_), len);
+        num_bytes_written += len;
+        begin_ = end_ = buffer_.data();
+      } else if (begin_ != buffer_.data()) {
+        const std::size_t remaining = end_ - begin_;
+        std::memmove(buffer_.data(), begin_, remaining);
+        begin_ = buffer_.data();
+        end_ = begin_ + remaining;
+      }
+      read();
     }
 
-    if (found_delimiter) {
+    if (num_lines > 0) {
       checksum_ = crc_stream.getCRC();
     } else {
       latest_flow_file_ends_with_delimiter_ = false;
@@ -247,7 +271,7 @@ class FileReaderCallback : public OutputStreamCallback {
   }
 
   bool hasMoreToRead() const {
-    return begin_ != end_ || input_stream_.good();
+    return !end_of_file_ || std::memchr(begin_, input_delimiter_, end_ - begin_) != nullptr;
   }
 
   bool useLatestFlowFile() const {
@@ -255,14 +279,28 @@ class FileReaderCallback : public OutputStreamCallback {
   }
 
  private:
+  void read() {
+    const std::size_t requested = buffer_.data() + buffer_.size() - end_;
+    const int num_bytes_read = input_stream_->readData(reinterpret_cast<uint8_t*>(end_), gsl::narrow<int>(requested));
+    logger_->log_trace("Read %d bytes of input", num_bytes_read);
+    if (num_bytes_read < 0) {
+      throw Exception(FILE_OPERATION_EXCEPTION, "Could not read the tailed file");
+    }
+    end_ += num_bytes_read;
+    // the data written after this read is picked up on the next trigger
+    end_of_file_ = static_cast<std::size_t>(num_bytes_read) < requested;
+  }
+
   char input_delimiter_;
   uint64_t checksum_;
-  std::ifstream input_stream_;
+  uint64_t lines_per_flow_file_;
+  std::unique_ptr<io::BufferedFileStream> input_stream_;
   std::shared_ptr<logging::Logger> logger_;
 
-  std::array<char, BUFFER_SIZE> buffer_;
-  char *begin_ = buffer_.data();
-  char *end_ = buffer_.data();
+  std::vector<char> buffer_;
+  char *begin_;
+  char *end_;
+  bool end_of_file_ = false;
 
   bool latest_flow_file_ends_with_delimiter_ = true;
 };
@@ -274,7 +312,7 @@ class WholeFileReaderCallback : public OutputStreamCallback {
                           uint64_t checksum)
     : checksum_(checksum),
       logger_(logging::LoggerFactory<TailFile>::getLogger()) {
-    openFile(file_name, offset, input_stream_, logger_);
+    input_stream_ = openFile(file_name, offset, logger_);
   }
 
   uint64_t checksum() const {
@@ -282,22 +320,21 @@ class WholeFileReaderCallback : public OutputStreamCallback {
   }
 
   int64_t process(std::shared_ptr<io::BaseStream> output_stream) override {
-    std::array<char, BUFFER_SIZE> buffer;
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
 
     io::CRCStream<io::BaseStream> crc_stream{output_stream.get(), checksum_};
 
     uint64_t num_bytes_written = 0;
 
-    while (input_stream_.good()) {
-      input_stream_.read(buffer.data(), buffer.size());
-
-      const auto num_bytes_read = input_stream_.gcount();
-      logger_->log_trace("Read %jd bytes of input", std::intmax_t{num_bytes_read});
-
-      const int len = gsl::narrow<int>(num_bytes_read);
+    int num_bytes_read;
+    while ((num_bytes_read = input_stream_->readData(buffer.data(), gsl::narrow<int>(buffer.size()))) > 0) {
+      logger_->log_trace("Read %d bytes of input", num_bytes_read);
 
-      crc_stream.write(reinterpret_cast<uint8_t*>(buffer.data()), len);
-      num_bytes_written += len;
+      crc_stream.write(buffer.data(), num_bytes_read);
+      num_bytes_written += num_bytes_read;
+      if (static_cast<std::size_t>(num_bytes_read) < buffer.size()) {
+        break;
+      }
     }
 
     checksum_ = crc_stream.getCRC();
@@ -307,7 +344,7 @@ class WholeFileReaderCallback : public OutputStreamCallback {
 
  private:
   uint64_t checksum_;
-  std::ifstream input_stream_;
+  std::unique_ptr<io::BufferedFileStream> input_stream_;
   std::shared_ptr<logging::Logger> logger_;
 };
 }  // namespace
@@ -323,6 +360,8 @@ void TailFile::initialize() {
   properties.insert(RecursiveLookup);
   properties.insert(LookupFrequency);
   properties.insert(RollingFilenamePattern);
+  properties.insert(LinesPerFlowFile);
+  properties.insert(WatchForChanges);
   setSupportedProperties(properties);
   // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -384,7 +423,63 @@ void TailFile::onSchedule(const std::shared_ptr<core::ProcessContext> &context,
   context->getProperty(RollingFilenamePattern.getName(), rolling_filename_pattern_glob);
   rolling_filename_pattern_ = utils::file::PathUtils::globToRegex(rolling_filename_pattern_glob);
 
+  context->getProperty(LinesPerFlowFile.getName(), lines_per_flow_file_);
+
   recoverState(context);
+
+  bool watch_for_changes = false;
+  context->getProperty(WatchForChanges.getName(), watch_for_changes);
+  watcher_.reset();
+  changed_files_.clear();
+  check_all_files_ = true;
+  if (watch_for_changes) {
+    startWatching();
+  }
+}
+
+void TailFile::onUnSchedule() {
+  std::lock_guard<std::mutex> tail_lock(tail_file_mutex_);
+  watcher_.reset();
+}
+
+void TailFile::startWatching() {
+  if (!utils::file::DirectoryWatcher::isSupported()) {
+    logger_->log_warn("Watching for changes is not supported on this platform, every tailed file is checked on each trigger");
+    return;
+  }
+  std::set<std::string> directories;
+  if (tail_mode_ == Mode::MULTIPLE) {
+    directories.insert(base_dir_);
+  }
+  for (const auto &state : tail_states_) {
+    directories.insert(state.second.path_);
+  }
+  watcher_ = std::unique_ptr<utils::file::DirectoryWatcher>(new utils::file::DirectoryWatcher(tail_mode_ == Mode::MULTIPLE && recursive_lookup_, true));
+  for (const auto &directory : directories) {
+    if (!watcher_->watch(directory)) {
+      logger_->log_warn("Could not watch %s, every tailed file is checked on each trigger", directory);
+      watcher_.reset();
+      return;
+    }
+  }
+}
+
+void TailFile::processEvents() {
+  std::vector<utils::file::DirectoryWatcher::Event> events;
+  if (!watcher_->poll(events)) {
+    check_all_files_ = true;
+  }
+  for (const auto &event : events) {
+    std::string full_file_name = event.directory + utils::file::FileUtils::get_separator() + event.filename;
+    if (containsKey(tail_states_, full_file_name)) {
+      // removals are kept too, as they may be rotations
+      changed_files_.insert(std::move(full_file_name));
+    } else if (tail_mode_ == Mode::MULTIPLE && event.type != utils::file::DirectoryWatcher::EventType::REMOVED
+        && utils::Regex::matchesFullInput(file_to_tail_, event.filename)) {
+      tail_states_.emplace(full_file_name, TailState{event.directory, event.filename});
+      changed_files_.insert(std::move(full_file_name));
+    }
+  }
 }
 
 void TailFile::parseStateFileLine(char *buf, std::map<std::string, TailState> &state) const {
@@ -641,10 +736,25 @@ void TailFile::onTrigger(const std::shared_ptr<core::ProcessContext> &, const st
     }
   }
 
+  if (watcher_) {
+    processEvents();
+  }
+
   // iterate over file states. may modify them
-  for (auto &state : tail_states_) {
-    processFile(session, state.first, state.second);
+  if (!watcher_ || check_all_files_) {
+    for (auto &state : tail_states_) {
+      processFile(session, state.first, state.second);
+    }
+    check_all_files_ = false;
+  } else {
+    for (const auto &full_file_name : changed_files_) {
+      const auto state = tail_states_.find(full_file_name);
+      if (state != tail_states_.end()) {
+        processFile(session, state->first, state->second);
+      }
+    }
   }
+  changed_files_.clear();
 
   if (!session->existsFlowFileInRelationship(Success)) {
     yield();
@@ -690,7 +800,7 @@ void TailFile::processSingleFile(const std::shared_ptr<core::ProcessSession> &se
     logger_->log_trace("Looking for delimiter 0x%X", delim);
 
     std::size_t num_flow_files = 0;
-    FileReaderCallback file_reader{full_file_name, state.position_, delim, state.checksum_};
+    FileReaderCallback file_reader{full_file_name, state.position_, delim, state.checksum_, lines_per_flow_file_};
     TailState state_copy{state};
 
     while (file_reader.hasMoreToRead()) {
@@ -767,6 +877,7 @@ void TailFile::checkForNewFiles() {
     std::string full_file_name = path + utils::file::FileUtils::get_separator() + file_name;
     if (!containsKey(tail_states_, full_file_name) && utils::Regex::matchesFullInput(file_to_tail_, file_name)) {
       tail_states_.emplace(full_file_name, TailState{path, file_name});
+      changed_files_.insert(full_file_name);
     }
     return true;
   };
@@ -22,6 +22,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <utility>
 #include <string>
 #include <vector>
@@ -33,6 +34,7 @@
 #include "core/Core.h"
 #include "core/Resource.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/file/DirectoryWatcher.h"
 namespace org {
 namespace apache {
 namespace nifi {
@@ -91,6 +93,8 @@ class TailFile : public core::Processor {
   static core::Property RecursiveLookup;
   static core::Property LookupFrequency;
   static core::Property RollingFilenamePattern;
+  static core::Property LinesPerFlowFile;
+  static core::Property WatchForChanges;
   // Supported Relationships
   static core::Relationship Success;
 
@@ -108,6 +112,8 @@ class TailFile : public core::Processor {
    */
   void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession>  &session) override;
 
+  void onUnSchedule() override;
+
   void initialize() override;
 
   bool recoverState(const std::shared_ptr<core::ProcessContext>& context);
@@ -147,6 +153,17 @@ class TailFile : public core::Processor {
 
   std::string rolling_filename_pattern_;
 
+  uint64_t lines_per_flow_file_ = 1;
+
+  // Reports the changes in the directories of the tailed files if Watch For Changes is set
+  std::unique_ptr<utils::file::DirectoryWatcher> watcher_;
+
+  // Files reported as changed since they were last read
+  std::set<std::string> changed_files_;
+
+  // Every file has to be checked, e.g. since events were lost
+  bool check_all_files_ = true;
+
   std::shared_ptr<logging::Logger> logger_;
 
   void parseStateFileLine(char *buf, std::map<std::string, TailState> &state) const;
@@ -172,6 +189,10 @@ class TailFile : public core::Processor {
 
   void checkForNewFiles();
 
+  void startWatching();
+
+  void processEvents();
+
   void updateFlowFileAttributes(const std::string &full_file_name, const TailState &state, const std::string &fileName,
                                 const std::string &baseName, const std::string &extension,
                                 std::shared_ptr<FlowFileRecord> &flow_file) const;
@@ -102,3 +102,36 @@ TEST_CASE("GetFile: Directory", "[getFileDir]") {
   auto get_file = plan->addProcessor("GetFile", "Get");
   REQUIRE_THROWS_AS(plan->runNextProcessor(), minifi::Exception);
 }
+
+#ifdef __linux__
+TEST_CASE("GetFile: Watch Input Directory", "[getFileWatch]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::GetFile>();
+  auto plan = testController.createPlan();
+
+  char in_dir[] = "/tmp/gt.XXXXXX";
+  auto temp_path = testController.createTempDirectory(in_dir);
+  REQUIRE(!temp_path.empty());
+  const std::string existing_file = temp_path + utils::file::FileUtils::get_separator() + "existing";
+  std::ofstream(existing_file) << "listed on schedule";
+
+  auto get_file = plan->addProcessor("GetFile", "Get");
+  plan->setProperty(get_file, processors::GetFile::Directory.getName(), temp_path);
+  plan->setProperty(get_file, processors::GetFile::WatchDirectory.getName(), "true");
+
+  plan->runNextProcessor();  // Get
+  REQUIRE(LogTestController::getInstance().contains("GetFile process " + existing_file));
+
+  // files of new subdirectories are reported by the watcher, not by another listing
+  const std::string sub_dir = temp_path + utils::file::FileUtils::get_separator() + "sub";
+  REQUIRE(utils::file::FileUtils::create_dir(sub_dir) == 0);
+  const std::string new_file = sub_dir + utils::file::FileUtils::get_separator() + "new";
+  std::ofstream(new_file) << "reported by inotify";
+
+  plan->reset();
+  plan->runNextProcessor();  // Get
+  REQUIRE(LogTestController::getInstance().contains("GetFile process " + new_file));
+  REQUIRE(LogTestController::getInstance().countOccurrences("Performing file listing against") == 1);
+}
+#endif
@@ -0,0 +1,106 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "TestBase.h"
+#include "ListenSyslog.h"
+#include "LogAttribute.h"
+
+namespace {
+
+void sendDatagram(uint16_t port, const std::string &message) {
+  int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(sockfd >= 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  REQUIRE(sendto(sockfd, message.data(), message.size(), 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == static_cast<ssize_t>(message.size()));
+  close(sockfd);
+}
+
+void sendStream(uint16_t port, const std::string &data) {
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  REQUIRE(sockfd >= 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  REQUIRE(connect(sockfd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0);
+  REQUIRE(send(sockfd, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size()));
+  close(sockfd);
+}
+
+}  // namespace
+
+TEST_CASE("ListenSyslog writes a batch of messages into a flow file", "[listenSyslog]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::ListenSyslog>();
+  LogTestController::getInstance().setTrace<processors::LogAttribute>();
+
+  std::mt19937 gen(std::random_device{}());  // NOLINT
+  const uint16_t port = 20000 + gen() % 10000;
+
+  auto plan = testController.createPlan();
+  auto listen_syslog = plan->addProcessor("ListenSyslog", "ListenSyslog");
+  plan->setProperty(listen_syslog, processors::ListenSyslog::Port.getName(), std::to_string(port));
+  plan->setProperty(listen_syslog, processors::ListenSyslog::MaxBatchSize.getName(), "0");
+  plan->setProperty(listen_syslog, processors::ListenSyslog::MessageDelimiter.getName(), "|");
+  auto log_attribute = plan->addProcessor("LogAttribute", "Log", core::Relationship("success", "description"), true);
+  plan->setProperty(log_attribute, processors::LogAttribute::FlowFilesToLog.getName(), "0");
+  plan->setProperty(log_attribute, processors::LogAttribute::LogPayload.getName(), "true");
+
+  std::string expected;
+  SECTION("UDP") {
+    plan->setProperty(listen_syslog, processors::ListenSyslog::Protocol.getName(), "UDP");
+    // the first trigger starts listening
+    plan->runNextProcessor();
+    REQUIRE(LogTestController::getInstance().contains("bind OK to port " + std::to_string(port)));
+    for (const std::string message : {"<13>one", "<13>two", "<13>three"}) {
+      sendDatagram(port, message);
+    }
+    expected = "<13>one|<13>two|<13>three";
+  }
+  SECTION("TCP") {
+    plan->setProperty(listen_syslog, processors::ListenSyslog::Protocol.getName(), "TCP");
+    plan->runNextProcessor();
+    REQUIRE(LogTestController::getInstance().contains("bind OK to port " + std::to_string(port)));
+    sendStream(port, "<13>one\n<13>two\n<13>three\n");
+    expected = "<13>one|<13>two|<13>three";
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  plan->reset();
+  plan->runNextProcessor();  // ListenSyslog
+  plan->runNextProcessor();  // Log
+  REQUIRE(LogTestController::getInstance().contains("Logged 1 flow files"));
+  REQUIRE(LogTestController::getInstance().contains(expected));
+}
+#endif
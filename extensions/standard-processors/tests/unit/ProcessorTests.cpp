@@ -489,7 +489,7 @@ TEST_CASE("Test Find file", "[getfileCreate3]") {
         taskReport->getJsonReport(context, session, recordsReport, jsonStr);
         REQUIRE(recordsReport.size() == 1);
         REQUIRE(taskReport->getName() == std::string(org::apache::nifi::minifi::core::reporting::SiteToSiteProvenanceReportingTask::ReportTaskName));
-        REQUIRE(jsonStr.find("\"componentType\": \"getfileCreate2\"") != std::string::npos);
+        REQUIRE(jsonStr.find("\"componentType\":\"getfileCreate2\"") != std::string::npos);
       };
 
   testController.runSession(plan, false, verifyReporter);
@@ -1541,3 +1541,84 @@ TEST_CASE("TailFile interprets the lookup frequency property correctly", "[multi
     REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
   }
 }
+
+TEST_CASE("TailFile writes several lines into a flow file", "[simple]") {
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::TailFile>();
+  LogTestController::getInstance().setTrace<processors::LogAttribute>();
+
+  char format[] = "/tmp/gt.XXXXXX";
+  auto temp_directory = testController.createTempDirectory(format);
+  std::string full_file_name = createTempFile(temp_directory, "test.log", "one\ntwo\nthree\nfour\nfive");
+
+  auto plan = testController.createPlan();
+
+  auto tail_file = plan->addProcessor("TailFile", "Tail");
+  plan->setProperty(tail_file, processors::TailFile::Delimiter.getName(), "\\n");
+  plan->setProperty(tail_file, processors::TailFile::FileName.getName(), full_file_name);
+
+  auto log_attribute = plan->addProcessor("LogAttribute", "Log", core::Relationship("success", "description"), true);
+  plan->setProperty(log_attribute, processors::LogAttribute::FlowFilesToLog.getName(), "0");
+
+  SECTION("Lines Per Flow File set to 3") {
+    plan->setProperty(tail_file, processors::TailFile::LinesPerFlowFile.getName(), "3");
+
+    testController.runSession(plan, true);
+
+    REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+    REQUIRE(LogTestController::getInstance().contains("key:filename value:test.0-13.log"));
+    REQUIRE(LogTestController::getInstance().contains("key:filename value:test.14-18.log"));
+  }
+
+  SECTION("Lines Per Flow File set to 0") {
+    plan->setProperty(tail_file, processors::TailFile::LinesPerFlowFile.getName(), "0");
+
+    testController.runSession(plan, true);
+
+    REQUIRE(LogTestController::getInstance().contains("Logged 1 flow file"));
+    REQUIRE(LogTestController::getInstance().contains("key:filename value:test.0-18.log"));
+  }
+}
+
+#ifdef __linux__
+TEST_CASE("TailFile only reads the files reported as changed", "[multiple_file]") {
+  TestController testController;
+
+  LogTestController::getInstance().setTrace<TestPlan>();
+  LogTestController::getInstance().setTrace<processors::TailFile>();
+  LogTestController::getInstance().setTrace<processors::LogAttribute>();
+
+  char format[] = "/tmp/gt.XXXXXX";
+  auto temp_directory = testController.createTempDirectory(format);
+  const std::string unchanged_file = createTempFile(temp_directory, "unchanged.log", "one\n");
+  createTempFile(temp_directory, "changed.log", "two\n");
+
+  auto plan = testController.createPlan();
+
+  auto tail_file = plan->addProcessor("TailFile", "Tail");
+  plan->setProperty(tail_file, processors::TailFile::Delimiter.getName(), "\\n");
+  plan->setProperty(tail_file, processors::TailFile::TailMode.getName(), "Multiple file");
+  plan->setProperty(tail_file, processors::TailFile::FileName.getName(), ".*\\.log");
+  plan->setProperty(tail_file, processors::TailFile::BaseDirectory.getName(), temp_directory);
+  plan->setProperty(tail_file, processors::TailFile::WatchForChanges.getName(), "true");
+
+  auto log_attribute = plan->addProcessor("LogAttribute", "Log", core::Relationship("success", "description"), true);
+  plan->setProperty(log_attribute, processors::LogAttribute::FlowFilesToLog.getName(), "0");
+
+  testController.runSession(plan, true);
+  REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+
+  plan->reset();
+  LogTestController::getInstance().resetStream(LogTestController::getInstance().log_output);
+
+  appendTempFile(temp_directory, "changed.log", "three\n");
+  // new files are reported as well, without waiting for the next lookup
+  createTempFile(temp_directory, "new.log", "four\n");
+
+  testController.runSession(plan, true);
+  REQUIRE(LogTestController::getInstance().contains("Logged 2 flow files"));
+  REQUIRE_FALSE(LogTestController::getInstance().contains("Tailing file " + unchanged_file, std::chrono::seconds(0)));
+}
+#endif
@@ -18,6 +18,8 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include "core/repository/VolatileContentRepository.h"
 #include "core/RepositoryFactory.h"
 #include "core/yaml/YamlConfiguration.h"
@@ -505,6 +507,89 @@ Processors:
                                                     "Dynamic Property with value Bad"));
 }
 
+TEST_CASE("Test YAML Connection Prioritizers", "[YamlConfigurationPrioritizers]") {
+  TestController test_controller;
+
+  std::shared_ptr<core::Repository> testProvRepo = core::createRepository("provenancerepository", true);
+  std::shared_ptr<core::Repository> testFlowFileRepo = core::createRepository("flowfilerepository", true);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<minifi::io::StreamFactory> streamFactory = minifi::io::StreamFactory::getInstance(configuration);
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  core::YamlConfiguration yamlConfig(testProvRepo, testFlowFileRepo, content_repo, streamFactory, configuration);
+
+  static const std::string TEST_CONFIG_YAML = R"(
+Flow Controller:
+  name: Prioritized
+Processors:
+- name: GenerateFlowFile
+  class: GenerateFlowFile
+- name: LogAttribute
+  class: LogAttribute
+Connections:
+- name: Prioritized
+  source name: GenerateFlowFile
+  source relationship name: success
+  destination name: LogAttribute
+  prioritizers:
+  - PriorityAttributePrioritizer
+  - org.apache.nifi.prioritizer.OldestFlowFileFirstPrioritizer
+- name: SinglePrioritizer
+  source name: LogAttribute
+  source relationship name: success
+  destination name: LogAttribute
+  prioritizers: SmallestFlowFileFirstPrioritizer
+- name: InsertionOrder
+  source name: GenerateFlowFile
+  source relationship name: success
+  destination name: LogAttribute
+      )";
+  std::istringstream configYamlStream(TEST_CONFIG_YAML);
+  std::unique_ptr<core::ProcessGroup> rootFlowConfig = yamlConfig.getYamlRoot(configYamlStream);
+  REQUIRE(rootFlowConfig);
+
+  std::map<std::string, std::shared_ptr<minifi::Connection>> connectionMap;
+  rootFlowConfig->getConnections(connectionMap);
+  std::map<std::string, std::vector<std::string>> prioritizer_names;
+  for (const auto &connection : connectionMap) {
+    for (const auto &prioritizer : connection.second->getPrioritizers()) {
+      prioritizer_names[connection.second->getName()].push_back(prioritizer->getName());
+    }
+  }
+  REQUIRE(prioritizer_names["Prioritized"] == (std::vector<std::string>{"PriorityAttributePrioritizer", "OldestFlowFileFirstPrioritizer"}));
+  REQUIRE(prioritizer_names["SinglePrioritizer"] == std::vector<std::string>{"SmallestFlowFileFirstPrioritizer"});
+  REQUIRE(prioritizer_names["InsertionOrder"].empty());
+}
+
+TEST_CASE("Test YAML Unknown Connection Prioritizer", "[YamlConfigurationPrioritizers]") {
+  TestController test_controller;
+
+  std::shared_ptr<core::Repository> testProvRepo = core::createRepository("provenancerepository", true);
+  std::shared_ptr<core::Repository> testFlowFileRepo = core::createRepository("flowfilerepository", true);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<minifi::io::StreamFactory> streamFactory = minifi::io::StreamFactory::getInstance(configuration);
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  core::YamlConfiguration yamlConfig(testProvRepo, testFlowFileRepo, content_repo, streamFactory, configuration);
+
+  static const std::string TEST_CONFIG_YAML = R"(
+Flow Controller:
+  name: Prioritized
+Processors:
+- name: GenerateFlowFile
+  class: GenerateFlowFile
+- name: LogAttribute
+  class: LogAttribute
+Connections:
+- name: Prioritized
+  source name: GenerateFlowFile
+  source relationship name: success
+  destination name: LogAttribute
+  prioritizers:
+  - FirstInFirstOutPrioritizer
+      )";
+  std::istringstream configYamlStream(TEST_CONFIG_YAML);
+  REQUIRE_THROWS_WITH(yamlConfig.getYamlRoot(configYamlStream), "Unknown prioritizer FirstInFirstOutPrioritizer for connection Prioritized");
+}
+
 TEST_CASE("Test Required Property", "[YamlConfigurationRequiredProperty]") {
   TestController test_controller;
 
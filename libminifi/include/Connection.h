@@ -34,7 +34,10 @@
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "core/FlowFile.h"
+#include "core/FlowFilePrioritizer.h"
 #include "core/Repository.h"
+#include "utils/FlowFileQueue.h"
+#include "concurrentqueue.h"
 
 namespace org {
 namespace apache {
@@ -140,14 +143,35 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
     return drop_empty_;
   }
 
-  // Check whether the queue is empty
-  bool isEmpty();
+  // Set the prioritizers deciding the order in which queued flow files are polled, FIFO if empty
+  void setPrioritizers(std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers);
+  // Get the prioritizers of the connection
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> getPrioritizers();
+
+  /**
+   * Enables lock free ingest: producers hand flow files over through a lock free queue
+   * and the consumer moves them into the connection queue when polling. Flow files put
+   * by different producers may be interleaved in a different order than they were put.
+   */
+  void setLockFreeIngest(bool lock_free) {
+    lock_free_ingest_ = lock_free;
+  }
+
+  bool isLockFreeIngest() const {
+    return lock_free_ingest_;
+  }
+
+  // Check whether the queue is empty, penalized flow files included
+  bool isEmpty() {
+    return queued_count_ == 0;
+  }
+  // Check whether the queue holds at least one flow file which is not penalized
+  bool hasReadyFlowFiles();
   // Check whether the queue is full to apply back pressure
   bool isFull();
   // Get queue size
   uint64_t getQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return queued_count_;
   }
   // Get queue data size
   uint64_t getQueueDataSize() {
@@ -167,13 +191,20 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   void multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows);
   // Poll the flow file from queue, the expired flow file record also being returned
   std::shared_ptr<core::FlowFile> poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
+  /**
+   * Polls up to max_count flow files from the queue under a single lock acquisition,
+   * the expired flow file records also being returned.
+   * @param max_count maximum number of flow files to return
+   * @param max_bytes stop once the returned flow files reach this total size, 0 for no limit
+   */
+  std::vector<std::shared_ptr<core::FlowFile>> pollBatch(size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Drain the flow records
   void drain(bool delete_permanently);
 
   void yield() override {}
 
   bool isWorkAvailable() override {
-    return !isEmpty();
+    return hasReadyFlowFiles();
   }
 
   bool isRunning() override {
@@ -204,15 +235,32 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
 
  private:
   bool drop_empty_;
+  // Prioritizers of the queue
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers_;
   // Mutex for protection
   std::mutex mutex_;
   // Queued data size
   std::atomic<uint64_t> queued_data_size_;
-  // Queue for the Flow File
-  std::queue<std::shared_ptr<core::FlowFile>> queue_;
+  // Number of queued flow files, including the ones still in the ingest queue
+  std::atomic<uint64_t> queued_count_;
+  // Queue for the Flow File, penalized flow files are kept apart from the ready ones
+  utils::FlowFileQueue queue_;
+  // Whether producers use the ingest queue instead of locking the connection queue
+  std::atomic<bool> lock_free_ingest_;
+  // Flow files put but not yet moved into queue_
+  moodycamel::ConcurrentQueue<std::shared_ptr<core::FlowFile>> ingest_queue_;
+  // Number of flow files in the ingest queue
+  std::atomic<uint64_t> ingest_count_;
   // flow repository
   // Logger
   std::shared_ptr<logging::Logger> logger_;
+  // Adds flow files to the queue, the caller must not hold mutex_
+  void enqueue(const std::vector<std::shared_ptr<core::FlowFile>> &flows);
+  void enqueue(const std::shared_ptr<core::FlowFile> &flow);
+  // Moves the flow files from the ingest queue to queue_, the caller must hold mutex_
+  void drainIngestQueue();
+  // Pops the next ready, not expired flow file, the caller must hold mutex_
+  std::shared_ptr<core::FlowFile> pollLocked(uint64_t now, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   Connection(const Connection &parent);
@@ -31,6 +31,7 @@
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
+#include "sitetosite/PeerSelector.h"
 #include "sitetosite/SiteToSiteClient.h"
 #include "io/StreamFactory.h"
 #include "controllers/SSLContextService.h"
@@ -95,7 +96,7 @@ class RemoteProcessorGroupPort : public core::Processor {
     stream_factory_ = stream_factory;
     protocol_uuid_ = uuid;
     site2site_secure_ = false;
-    peer_index_ = -1;
+    last_peer_refresh_ = 0;
     // REST API port and host
     setURL(url);
   }
@@ -110,6 +111,7 @@ class RemoteProcessorGroupPort : public core::Processor {
   static core::Property port;
   static core::Property portUUID;
   static core::Property idleTimeout;
+  static core::Property useCompression;
   // Supported Relationships
   static core::Relationship relation;
 
@@ -123,6 +125,7 @@ class RemoteProcessorGroupPort : public core::Processor {
   // Set Direction
   void setDirection(sitetosite::TransferDirection direction) {
     direction_ = direction;
+    peer_selector_.setDirection(direction);
     if (direction_ == sitetosite::RECEIVE)
       this->setTriggerWhenEmpty(true);
   }
@@ -196,10 +199,21 @@ class RemoteProcessorGroupPort : public core::Processor {
   }
 
   std::shared_ptr<io::StreamFactory> stream_factory_;
+  /**
+   * Provides a client for a new transaction, connected to the least loaded peer.
+   * Every client obtained is handed back with returnProtocol or penalizeProtocol.
+   */
   std::unique_ptr<sitetosite::SiteToSiteClient> getNextProtocol(bool create);
   void returnProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> protocol);
+  /**
+   * Drops a client whose transaction failed and avoids its peer for a while.
+   */
+  void penalizeProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> protocol);
+
+  // the peer list is refreshed this often, so that the transactions follow the load of the remote cluster
+  static constexpr uint64_t PEER_REFRESH_PERIOD_MILLIS = 60000;
 
-  moodycamel::ConcurrentQueue<std::unique_ptr<sitetosite::SiteToSiteClient>> available_protocols_;
+  sitetosite::PeerSelector peer_selector_;
 
   std::shared_ptr<Configure> configure_;
   // Transaction Direction
@@ -215,6 +229,8 @@ class RemoteProcessorGroupPort : public core::Processor {
 
   std::chrono::milliseconds idle_timeout_{15000};
 
+  bool use_compression_{false};
+
   // rest API end point info
   std::vector<struct RPG> nifi_instances_;
 
@@ -229,7 +245,7 @@ class RemoteProcessorGroupPort : public core::Processor {
   // Remote Site2Site Info
   bool site2site_secure_;
   std::vector<sitetosite::PeerStatus> peers_;
-  std::atomic<int> peer_index_;
+  std::atomic<uint64_t> last_peer_refresh_;
   std::mutex peer_mutex_;
   std::string rest_user_name_;
   std::string rest_password_;
@@ -56,6 +56,17 @@ class ContentRepository : public StreamManager<minifi::ResourceClaim> {
    */
   virtual void stop() = 0;
 
+  /**
+   * Stores the content of a file starting at offset as the claim, without passing it through a stream.
+   * Repositories that keep their content in files move or copy the file directly.
+   * @param keep_source if false the source file is removed once its content has been imported
+   * @param size set to the size of the imported content
+   * @return false if the repository cannot import files directly, in which case the source is left untouched
+   */
+  virtual bool importFile(const std::shared_ptr<minifi::ResourceClaim>& /*claim*/, const std::string& /*source*/, uint64_t /*offset*/, bool /*keep_source*/, uint64_t& /*size*/) {
+    return false;
+  }
+
   /**
    * Removes an item if it was orphan
    */
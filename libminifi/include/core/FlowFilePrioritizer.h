@@ -0,0 +1,150 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+
+#include <memory>
+#include <string>
+
+#include "core/FlowFile.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * The "priority" attribute of a FlowFile, parsed once when the FlowFile is queued.
+ */
+struct FlowFilePriority {
+  static FlowFilePriority parse(const FlowFile &flow_file);
+
+  bool present = false;
+  bool numeric = false;
+  long long value = 0;  // NOLINT
+  std::string text;
+};
+
+/**
+ * Purpose: Decides the order in which the FlowFiles of a connection are handed out.
+ *
+ * Prioritizers mirror the NiFi prioritizers of the same name. A connection may be configured
+ * with several of them, in which case the later ones only break the ties of the earlier ones.
+ * FlowFiles which compare equal under every prioritizer are handed out in insertion order.
+ */
+class FlowFilePrioritizer {
+ public:
+  virtual ~FlowFilePrioritizer() = default;
+
+  /**
+   * Compares two FlowFiles.
+   * @return negative if lhs should be handed out before rhs, positive if after, zero if indifferent
+   */
+  virtual int compare(const FlowFile &lhs, const FlowFile &rhs) const = 0;
+
+  /**
+   * Compares two queued FlowFiles along with their priorities parsed when they were queued.
+   * The priorities are only parsed if a prioritizer of the queue uses them.
+   */
+  virtual int compare(const FlowFile &lhs, const FlowFilePriority &lhs_priority, const FlowFile &rhs, const FlowFilePriority &rhs_priority) const {
+    return compare(lhs, rhs);
+  }
+
+  /**
+   * @return whether compare needs the parsed priorities of the FlowFiles
+   */
+  virtual bool usesPriority() const {
+    return false;
+  }
+
+  virtual std::string getName() const = 0;
+
+  /**
+   * Creates a prioritizer either from its simple name (e.g. OldestFlowFileFirstPrioritizer)
+   * or from the fully qualified NiFi class name.
+   * @return the prioritizer or nullptr if the name is not known
+   */
+  static std::shared_ptr<FlowFilePrioritizer> create(const std::string &name);
+};
+
+/**
+ * Hands out the FlowFiles which entered the flow earliest first.
+ */
+class OldestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  int compare(const FlowFile &lhs, const FlowFile &rhs) const override;
+
+  std::string getName() const override {
+    return "OldestFlowFileFirstPrioritizer";
+  }
+};
+
+/**
+ * Hands out the FlowFiles which entered the flow most recently first.
+ */
+class NewestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  int compare(const FlowFile &lhs, const FlowFile &rhs) const override;
+
+  std::string getName() const override {
+    return "NewestFlowFileFirstPrioritizer";
+  }
+};
+
+/**
+ * Orders FlowFiles by their "priority" attribute. Numeric values are compared numerically and take
+ * precedence over non-numeric ones, which are compared lexicographically. The lower the value the
+ * sooner the FlowFile is handed out. FlowFiles without the attribute come last.
+ */
+class PriorityAttributePrioritizer : public FlowFilePrioritizer {
+ public:
+  static constexpr const char* PRIORITY_ATTRIBUTE = "priority";
+
+  int compare(const FlowFile &lhs, const FlowFile &rhs) const override;
+
+  int compare(const FlowFile &lhs, const FlowFilePriority &lhs_priority, const FlowFile &rhs, const FlowFilePriority &rhs_priority) const override;
+
+  bool usesPriority() const override {
+    return true;
+  }
+
+  std::string getName() const override {
+    return "PriorityAttributePrioritizer";
+  }
+};
+
+/**
+ * Hands out the FlowFiles with the smallest content first.
+ */
+class SmallestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  int compare(const FlowFile &lhs, const FlowFile &rhs) const override;
+
+  std::string getName() const override {
+    return "SmallestFlowFileFirstPrioritizer";
+  }
+};
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
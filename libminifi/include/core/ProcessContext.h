@@ -46,6 +46,9 @@ namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
+namespace provenance {
+class ProvenancePolicy;
+}  // namespace provenance
 namespace core {
 
 // ProcessContext Class
@@ -147,6 +150,11 @@ class ProcessContext : public controller::ControllerServiceLookup, public core::
     return repo_;
   }
 
+  /**
+   * Returns how the provenance events of the processor are recorded, the policy is created on first use.
+   */
+  std::shared_ptr<provenance::ProvenancePolicy> getProvenancePolicy();
+
   /**
    * Returns a reference to the content repository for the running instance.
    * @return content repository shared pointer.
@@ -346,6 +354,9 @@ class ProcessContext : public controller::ControllerServiceLookup, public core::
   std::shared_ptr<logging::Logger> logger_;
   std::shared_ptr<Configure> configure_;
 
+  std::mutex provenance_policy_mutex_;
+  std::shared_ptr<provenance::ProvenancePolicy> provenance_policy_;
+
   bool initialized_;
 };
 
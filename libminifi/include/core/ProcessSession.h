@@ -56,7 +56,8 @@ class ProcessSession : public ReferenceContainer {
         logger_(logging::LoggerFactory<ProcessSession>::getLogger()) {
     logger_->log_trace("ProcessSession created for %s", process_context_->getProcessorNode()->getName());
     auto repo = process_context_->getProvenanceRepository();
-    provenance_report_ = std::make_shared<provenance::ProvenanceReporter>(repo, process_context_->getProcessorNode()->getName(), process_context_->getProcessorNode()->getName());
+    provenance_report_ = std::make_shared<provenance::ProvenanceReporter>(repo, process_context_->getProcessorNode()->getName(), process_context_->getProcessorNode()->getName(),
+                                                                          process_context_->getProvenancePolicy());
   }
 
 // Destructor
@@ -73,6 +74,8 @@ class ProcessSession : public ReferenceContainer {
   //
   // Get the FlowFile from the highest priority queue
   virtual std::shared_ptr<core::FlowFile> get();
+  // Get up to max_count FlowFiles, stopping once they reach max_bytes in total (0 for no limit)
+  virtual std::vector<std::shared_ptr<core::FlowFile>> get(size_t max_count, uint64_t max_bytes = 0);
   // Create a new UUID FlowFile with no content resource claim and without parent
   std::shared_ptr<core::FlowFile> create();
   // Create a new UUID FlowFile with no content resource claim and inherit all attributes from parent
@@ -153,8 +156,25 @@ class ProcessSession : public ReferenceContainer {
   // FlowFiles being cloned for multiple connections per relationship
   std::map<std::string, std::shared_ptr<core::FlowFile> > _clonedFlowFiles;
 
+  // State of a FlowFile as it was when it was polled into the session
+  struct FlowFileSnapshot {
+    std::map<std::string, std::string> attributes;
+    std::shared_ptr<ResourceClaim> claim;
+    uint64_t size;
+    uint64_t offset;
+    uint64_t penalty_expiration;
+  };
+  // Snapshots of the original FlowFiles, only taken once the session is about to modify them
+  std::map<std::string, FlowFileSnapshot> _flowFileSnapshots;
+
  private:
-// Clone the flow file during transfer to multiple connections for a relationship
+  // Capture the original state of a polled FlowFile before its first modification
+  void snapshot(const std::shared_ptr<core::FlowFile> &flow);
+  // Revert a FlowFile to its snapshot
+  void revertToSnapshot(const std::shared_ptr<core::FlowFile> &flow, FlowFileSnapshot &snapshot);
+  // Report the expired FlowFiles polled from a connection
+  void expire(const std::set<std::shared_ptr<core::FlowFile>> &expired);
+  // Clone the flow file during transfer to multiple connections for a relationship
   std::shared_ptr<core::FlowFile> cloneDuringTransfer(std::shared_ptr<core::FlowFile> &parent);
   // ProcessContext
   std::shared_ptr<ProcessContext> process_context_;
@@ -23,6 +23,8 @@
 #include <mutex>
 #include <memory>
 #include <stack>
+#include <string>
+#include <vector>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -56,11 +58,22 @@ class SiteToSiteProvenanceReportingTask : public minifi::RemoteProcessorGroupPor
   static constexpr char const* ReportTaskName = "SiteToSiteProvenanceReportingTask";
   static const char *ProvenanceAppStr;
 
+  //! Report encodings
+  enum class ReportFormat {
+    //! JSON array of the events, as expected by NiFi
+    JSON,
+    //! the serialized events, each preceded by its length
+    BINARY
+  };
+
  public:
-  //! Get provenance json report
+  //! Get provenance json report, written with a streaming writer
   void getJsonReport(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, std::vector<std::shared_ptr<core::SerializableComponent>> &records, std::string &report); // NOLINT
 
 
+  //! Get provenance binary report
+  void getBinaryReport(std::vector<std::shared_ptr<core::SerializableComponent>> &records, std::string &report);
+
   void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
   //! OnTrigger method, implemented by NiFi SiteToSiteProvenanceReportingTask
   void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
@@ -85,8 +98,16 @@ class SiteToSiteProvenanceReportingTask : public minifi::RemoteProcessorGroupPor
     port_uuid = protocol_uuid_;
   }
 
+  //! Set Report Format, "json" or "binary"
+  bool setReportFormat(const std::string &format);
+
+  ReportFormat getReportFormat() const {
+    return report_format_;
+  }
+
  private:
   int batch_size_;
+  ReportFormat report_format_ = ReportFormat::JSON;
 
   std::shared_ptr<logging::Logger> logger_;
 };
@@ -0,0 +1,305 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_CLAIMCONTAINER_H_
+#define LIBMINIFI_INCLUDE_CORE_REPOSITORY_CLAIMCONTAINER_H_
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "io/BaseStream.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+/**
+ * Append-only file holding the content of many resource claims back to back.
+ *
+ * Next to the data file an index file records every claim stored in the container as
+ * "+ <offset> <length> <claim>" and every removed claim as "- <offset> <claim>", which allows the
+ * claim locations to be restored after a restart.
+ */
+class ClaimContainer {
+ public:
+  ClaimContainer(uint64_t id, std::string path, uint64_t size = 0);
+
+  ~ClaimContainer();
+
+  uint64_t getId() const {
+    return id_;
+  }
+
+  const std::string &getPath() const {
+    return path_;
+  }
+
+  std::string getIndexPath() const {
+    return path_ + ".index";
+  }
+
+  uint64_t getSize() const {
+    return size_;
+  }
+
+  /**
+   * Opens the data file for appending.
+   */
+  bool openForAppend();
+
+  bool append(const uint8_t *data, size_t length);
+
+  /**
+   * Makes the appended data visible to readers.
+   */
+  bool flush();
+
+  void recordClaim(const std::string &claim, uint64_t offset, uint64_t length);
+
+  void recordRemoval(const std::string &claim, uint64_t offset);
+
+  void close();
+
+  /**
+   * Closes and deletes the data and the index file.
+   */
+  void destroy();
+
+  /**
+   * Counts a claim stored in this container.
+   */
+  void addClaim() {
+    ++live_claims_;
+  }
+
+  /**
+   * Stops counting a claim stored in this container, once it was removed or relocated.
+   */
+  void removeClaim() {
+    if (live_claims_ > 0) {
+      --live_claims_;
+    }
+  }
+
+  uint32_t getLiveClaimCount() const {
+    return live_claims_;
+  }
+
+  /**
+   * Stops appending to this container, it is deleted once its last claim is removed.
+   */
+  void seal() {
+    sealed_ = true;
+  }
+
+  bool isSealed() const {
+    return sealed_;
+  }
+
+ private:
+  bool openIndex();
+
+  // number of claims stored in this container which were not removed yet
+  uint32_t live_claims_;
+
+  // sealed containers are not appended to anymore and are deleted once their last claim is removed
+  bool sealed_;
+
+  uint64_t id_;
+  std::string path_;
+  uint64_t size_;
+  std::ofstream data_;
+  std::ofstream index_;
+};
+
+/**
+ * Keeps track of the claim containers of a content repository: which container and range holds
+ * each claim, which containers can be appended to and when a container can be deleted.
+ */
+class ClaimContainerManager : public std::enable_shared_from_this<ClaimContainerManager> {
+ public:
+  struct ClaimLocation {
+    std::shared_ptr<ClaimContainer> container;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  ClaimContainerManager(std::string directory, uint64_t max_container_size);
+
+  /**
+   * Restores the claim locations from the indexes of the containers found in the directory.
+   * Containers from earlier runs are sealed, the ones without any claims are deleted.
+   */
+  bool initialize();
+
+  /**
+   * Closes every container, claims appended to afterwards are appended to new containers.
+   */
+  void stop();
+
+  /**
+   * Opens a stream appending the content of claim to a container. The claim is stored in the
+   * container when the stream is closed, replacing its previous location.
+   * @param append whether the previous content of the claim should be kept
+   */
+  std::shared_ptr<io::BaseStream> write(const std::string &claim, bool append);
+
+  /**
+   * @return stream reading the content of the claim or nullptr if it is not stored in a container
+   */
+  std::shared_ptr<io::BaseStream> read(const std::string &claim);
+
+  bool exists(const std::string &claim);
+
+  /**
+   * Removes the claim, deleting its container if it is sealed and this was its last claim.
+   * @return false if the claim is not stored in a container
+   */
+  bool remove(const std::string &claim);
+
+  size_t getContainerCount();
+
+ private:
+  friend class ClaimContainerWriteStream;
+
+  std::shared_ptr<ClaimContainer> acquire();
+
+  /**
+   * Hands the container back once the write stream of a claim is closed.
+   */
+  void release(const std::shared_ptr<ClaimContainer> &container, const std::string &claim, uint64_t offset, uint64_t length, bool success);
+
+  void removeLocation(std::map<std::string, ClaimLocation>::iterator location);
+
+  void destroyIfUnused(const std::shared_ptr<ClaimContainer> &container);
+
+  std::string getContainerPath(uint64_t id) const;
+
+  std::string directory_;
+  uint64_t max_container_size_;
+
+  std::mutex mutex_;
+  std::map<std::string, ClaimLocation> locations_;
+  std::map<uint64_t, std::shared_ptr<ClaimContainer>> containers_;
+  // containers which are neither sealed nor being appended to
+  std::vector<std::shared_ptr<ClaimContainer>> available_;
+  uint64_t next_container_id_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+/**
+ * Reads the range of a container holding a single claim.
+ */
+class ClaimContainerReadStream : public io::BaseStream {
+ public:
+  ClaimContainerReadStream(const std::string &path, uint64_t offset, uint64_t length);
+
+  ~ClaimContainerReadStream() override {
+    closeStream();
+  }
+
+  void closeStream() override;
+
+  void seek(uint64_t offset) override;
+
+  const uint64_t getSize() const override {
+    return length_;
+  }
+
+  int readData(std::vector<uint8_t> &buf, int buflen) override;
+
+  int readData(uint8_t *buf, int buflen) override;
+
+  int writeData(uint8_t *value, int size) override {
+    return -1;
+  }
+
+  const uint8_t *getBuffer() const {
+    throw std::runtime_error("Stream does not support this operation");
+  }
+
+ private:
+  std::ifstream file_;
+  uint64_t start_;
+  uint64_t length_;
+  uint64_t offset_;
+};
+
+/**
+ * Appends the content of a single claim to a container it has exclusive access to.
+ */
+class ClaimContainerWriteStream : public io::BaseStream {
+ public:
+  ClaimContainerWriteStream(std::shared_ptr<ClaimContainerManager> manager, std::shared_ptr<ClaimContainer> container, std::string claim);
+
+  ~ClaimContainerWriteStream() override {
+    closeStream();
+  }
+
+  void closeStream() override;
+
+  /**
+   * Container streams only append, seeking is a no-op.
+   */
+  void seek(uint64_t offset) override {
+  }
+
+  const uint64_t getSize() const override {
+    return length_;
+  }
+
+  int readData(std::vector<uint8_t> &buf, int buflen) override {
+    return -1;
+  }
+
+  int readData(uint8_t *buf, int buflen) override {
+    return -1;
+  }
+
+  int writeData(uint8_t *value, int size) override;
+
+  const uint8_t *getBuffer() const {
+    throw std::runtime_error("Stream does not support this operation");
+  }
+
+ private:
+  std::shared_ptr<ClaimContainerManager> manager_;
+  std::shared_ptr<ClaimContainer> container_;
+  std::string claim_;
+  uint64_t offset_;
+  uint64_t length_;
+  bool success_;
+  bool closed_;
+};
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_CORE_REPOSITORY_CLAIMCONTAINER_H_
@@ -23,6 +23,7 @@
 
 #include "core/Core.h"
 #include "../ContentRepository.h"
+#include "ClaimContainer.h"
 #include "properties/Configure.h"
 #include "core/logging/LoggerConfiguration.h"
 namespace org {
@@ -32,8 +33,14 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+#define DEFAULT_CLAIM_CONTAINER_MAX_SIZE (1024 * 1024)
+
 /**
  * FileSystemRepository is a content repository that stores data onto the local file system.
+ *
+ * By default every claim is stored in a file of its own. With claim containers enabled the claims are
+ * appended to shared container files instead, saving a file creation and deletion per claim. A container
+ * is deleted once it is full and all of its claims have been removed.
  */
 class FileSystemRepository : public core::ContentRepository, public core::CoreComponent {
  public:
@@ -59,7 +66,21 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual bool remove(const std::shared_ptr<minifi::ResourceClaim> &claim);
 
+  /**
+   * Renames the source into the repository if it is not kept and lives on the same file system,
+   * otherwise copies it with the kernel. Imported claims are always stored in files of their own.
+   */
+  virtual bool importFile(const std::shared_ptr<minifi::ResourceClaim> &claim, const std::string &source, uint64_t offset, bool keep_source, uint64_t &size);
+
+  /**
+   * @return the claim containers or nullptr if claims are stored in files of their own
+   */
+  std::shared_ptr<ClaimContainerManager> getClaimContainers() const {
+    return claim_containers_;
+  }
+
  private:
+  std::shared_ptr<ClaimContainerManager> claim_containers_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
@@ -0,0 +1,168 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_IO_BUFFEREDFILESTREAM_H_
+#define LIBMINIFI_INCLUDE_IO_BUFFEREDFILESTREAM_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BaseStream.h"
+#include "EndianCheck.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Purpose: High throughput file stream for streams owned by a single thread, such as the
+ * content streams of a session.
+ *
+ * Design: Reads and writes go through a user space buffer and reach the file with positional
+ * reads and writes on a raw descriptor, so there is neither a flush nor a seek per call. The
+ * written data is handed to the operating system once the buffer is full, on flush() and when
+ * the stream is closed; sync() additionally waits for it to reach the disk.
+ * The stream is not synchronized.
+ */
+class BufferedFileStream : public io::BaseStream {
+ public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 128 * 1024;
+
+  /**
+   * Opens an existing file for reading, and for writing if write_enable is set.
+   * @param offset position of the first read or write
+   */
+  explicit BufferedFileStream(const std::string &path, uint64_t offset, bool write_enable = false, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  /**
+   * Opens the file for writing, creating it if needed.
+   * @param append if set writes go to the end of the file, otherwise the file is truncated
+   */
+  explicit BufferedFileStream(const std::string &path, bool append = false, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  ~BufferedFileStream() override {
+    closeStream();
+  }
+
+  /**
+   * Flushes the pending writes and closes the file.
+   */
+  void closeStream() override;
+
+  /**
+   * Skip to the specified offset.
+   * @param offset offset to which we will skip
+   */
+  void seek(uint64_t offset) override;
+
+  const uint64_t getSize() const override {
+    return length_;
+  }
+
+  /**
+   * Hands the buffered writes to the operating system.
+   * @return false if they could not be written
+   */
+  bool flush();
+
+  /**
+   * Flushes the buffered writes and waits until they reach the disk.
+   */
+  bool sync();
+
+  using BaseStream::read;
+
+  int read(uint16_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE) override;
+
+  int read(uint32_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE) override;
+
+  int read(uint64_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE) override;
+
+  // data stream extensions
+  /**
+   * Reads data and places it into buf
+   * @param buf buffer in which we extract data
+   * @param buflen
+   */
+  int readData(std::vector<uint8_t> &buf, int buflen) override;
+  /**
+   * Reads data and places it into buf
+   * @param buf buffer in which we extract data
+   * @param buflen
+   */
+  int readData(uint8_t *buf, int buflen) override;
+
+  /**
+   * Write value to the stream using std::vector
+   * @param buf incoming buffer
+   * @param buflen buffer to write
+   *
+   */
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen);
+
+  /**
+   * writes value to stream
+   * @param value value to write
+   * @param size size of value
+   */
+  int writeData(uint8_t *value, int size) override;
+
+  /**
+   * Returns the underlying buffer
+   * @return vector's array
+   **/
+  const uint8_t *getBuffer() const {
+    throw std::runtime_error("Stream does not support this operation");
+  }
+
+ private:
+  void open(int flags);
+
+  // moves the buffer to the given file position, flushing pending writes
+  bool resetBuffer(uint64_t position);
+
+  bool fill();
+
+  int fd_;
+  std::string path_;
+  bool write_enable_;
+  bool append_;
+  // position of the next read or write
+  uint64_t offset_;
+  uint64_t length_;
+
+  std::vector<uint8_t> buffer_;
+  size_t buffer_size_;
+  // file position of the first byte of the buffer
+  uint64_t buffer_position_;
+  // the buffer holds pending writes instead of data read ahead
+  bool buffer_dirty_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_IO_BUFFEREDFILESTREAM_H_
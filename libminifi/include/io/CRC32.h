@@ -0,0 +1,49 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_IO_CRC32_H_
+#define LIBMINIFI_INCLUDE_IO_CRC32_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Updates a CRC-32 checksum, as computed by zlib's crc32, with the given data.
+ * On x86 processors supporting carry-less multiplication the bulk of the data is folded with
+ * PCLMULQDQ, which is several times faster than the table driven implementation.
+ * The SSE 4.2 crc32 instruction cannot be used, as it computes the CRC-32C checksum.
+ */
+uint32_t updateCRC32(uint32_t crc, const uint8_t *buffer, size_t length);
+
+/**
+ * @return true if updateCRC32 uses carry-less multiplication on this processor
+ */
+bool isHardwareCRC32Supported();
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_IO_CRC32_H_
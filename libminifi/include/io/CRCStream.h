@@ -33,6 +33,7 @@
 
 #endif
 #include "BaseStream.h"
+#include "CRC32.h"
 #include "Exception.h"
 #include "Serializable.h"
 
@@ -224,7 +225,7 @@ template<typename T>
 int CRCStream<T>::readData(uint8_t *buf, int buflen) {
   int ret = child_stream_->read(buf, buflen);
   if (ret > 0) {
-    crc_ = crc32(crc_, buf, ret);
+    crc_ = updateCRC32(static_cast<uint32_t>(crc_), buf, ret);
   }
   return ret;
 }
@@ -244,7 +245,7 @@ template<typename T>
 int CRCStream<T>::writeData(uint8_t *value, int size) {
   int ret = child_stream_->write(value, size);
   if (ret > 0) {
-    crc_ = crc32(crc_, value, ret);
+    crc_ = updateCRC32(static_cast<uint32_t>(crc_), value, ret);
   }
   return ret;
 }
@@ -254,7 +255,7 @@ void CRCStream<T>::reset() {
 }
 template<typename T>
 void CRCStream<T>::updateCRC(uint8_t *buffer, uint32_t length) {
-  crc_ = crc32(crc_, buffer, length);
+  crc_ = updateCRC32(static_cast<uint32_t>(crc_), buffer, length);
 }
 
 template<typename T>
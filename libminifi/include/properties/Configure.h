@@ -69,6 +69,8 @@ class Configure : public Properties {
   static const char *nifi_configuration_class_name;
   static const char *nifi_flow_repository_class_name;
   static const char *nifi_content_repository_class_name;
+  static const char *nifi_content_repository_container_enabled;
+  static const char *nifi_content_repository_container_max_size;
   static const char *nifi_volatile_repository_options;
   static const char *nifi_provenance_repository_class_name;
   static const char *nifi_server_port;
@@ -76,12 +78,18 @@ class Configure : public Properties {
   static const char *nifi_provenance_repository_max_storage_time;
   static const char *nifi_provenance_repository_max_storage_size;
   static const char *nifi_provenance_repository_directory_default;
+  static const char *nifi_provenance_mode;
+  static const char *nifi_provenance_sampling_rate;
+  static const char *nifi_provenance_aggregation_interval;
   static const char *nifi_provenance_repository_enable;
   static const char *nifi_flowfile_repository_max_storage_time;
   static const char *nifi_dbcontent_repository_directory_default;
+  static const char *nifi_dbcontent_repository_chunk_size;
   static const char *nifi_flowfile_repository_max_storage_size;
   static const char *nifi_flowfile_repository_directory_default;
   static const char *nifi_flowfile_repository_enable;
+  static const char *nifi_flowfile_repository_group_commit_max_latency;
+  static const char *nifi_flowfile_repository_durability;
   static const char *nifi_remote_input_secure;
   static const char *nifi_remote_input_http;
   static const char *nifi_security_need_ClientAuth;
@@ -24,6 +24,7 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -179,7 +180,7 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     setUUIDStr(id);
   }
   // Get Attributes
-  std::map<std::string, std::string> getAttributes() {
+  const std::map<std::string, std::string>& getAttributes() {
     return _attributes;
   }
   // Get Size
@@ -210,6 +211,14 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   void setEventDuration(uint64_t duration) {
     _eventDuration = duration;
   }
+  // Set Size
+  void setFileSize(uint64_t size) {
+    _size = size;
+  }
+  // Set Attribute
+  void setAttribute(const std::string &key, const std::string &value) {
+    _attributes[key] = value;
+  }
   // ! Get Event Type
   ProvenanceEventType getEventType() {
     return _eventType;
@@ -259,7 +268,7 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     _sourceSystemFlowFileIdentifier = identifier;
   }
   // Get Parent UUIDs
-  std::vector<std::string> getParentUuids() {
+  const std::vector<std::string>& getParentUuids() {
     return _parentUuids;
   }
   // Add Parent UUID
@@ -284,7 +293,7 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     return;
   }
   // Get Children UUIDs
-  std::vector<std::string> getChildrenUuids() {
+  const std::vector<std::string>& getChildrenUuids() {
     return _childrenUuids;
   }
   // Add Child UUID
@@ -332,13 +341,15 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   void setSourceQueueIdentifier(std::string identifier) {
     _sourceQueueIdentifier = identifier;
   }
-  // fromFlowFile
-  void fromFlowFile(std::shared_ptr<core::FlowFile> &flow) {
+  // fromFlowFile, the attributes and lineage identifiers are copied only if requested
+  void fromFlowFile(std::shared_ptr<core::FlowFile> &flow, bool copyAttributes = true) {
     _entryDate = flow->getEntryDate();
     _lineageStartDate = flow->getlineageStartDate();
-    _lineageIdentifiers = flow->getlineageIdentifiers();
     flow_uuid_ = flow->getUUIDStr();
-    _attributes = flow->getAttributes();
+    if (copyAttributes) {
+      _lineageIdentifiers = flow->getlineageIdentifiers();
+      _attributes = flow->getAttributes();
+    }
     _size = flow->getSize();
     _offset = flow->getOffset();
     if (flow->getOriginalConnection())
@@ -443,6 +454,84 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   static std::shared_ptr<utils::IdGenerator> id_generator_;
 };
 
+// Number of events and bytes of an event type
+struct ProvenanceEventCount {
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+};
+
+/**
+ * Decides how the provenance events of a component are recorded. It is shared by the sessions of a
+ * processor and configured in minifi.properties, where the mode and the sampling rate can be overridden
+ * per processor by appending its name to the property.
+ */
+class ProvenancePolicy {
+ public:
+  enum class Mode {
+    //! every event carries the attributes and lineage identifiers of its FlowFile
+    FULL,
+    //! events carry neither attributes nor lineage identifiers
+    LIGHTWEIGHT,
+    //! no events are recorded, only the number of events and bytes per event type in every interval
+    AGGREGATE
+  };
+
+  static constexpr uint64_t DEFAULT_AGGREGATION_INTERVAL_MILLIS = 60000;
+
+  ProvenancePolicy(const std::shared_ptr<Configure> &configure, std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType);
+
+  // writes the counts of the last interval
+  ~ProvenancePolicy();
+
+  Mode getMode() const {
+    return mode_;
+  }
+
+  bool includeAttributes() const {
+    return mode_ == Mode::FULL;
+  }
+
+  /**
+   * @return true if the next event is to be recorded, which is the case for one in every 1 / sampling rate events
+   */
+  bool sample() {
+    if (sampling_interval_ <= 1) {
+      return sampling_interval_ == 1;
+    }
+    return sample_counter_++ % sampling_interval_ == 0;
+  }
+
+  /**
+   * Adds the counts of a committed session, writing the aggregated events once the interval has elapsed.
+   */
+  void aggregate(const std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceEventCount> &counts);
+
+  /**
+   * Writes an event per event type with the counts collected since the last flush.
+   */
+  void flush();
+
+ private:
+  // reads the per processor value of the property or else the global one
+  static bool getProperty(const std::shared_ptr<Configure> &configure, const std::string &property, const std::string &componentType, std::string &value);
+
+  Mode mode_;
+  // every sampling_interval_ th event is recorded, none if it is 0
+  uint64_t sampling_interval_;
+  std::atomic<uint64_t> sample_counter_;
+
+  std::shared_ptr<core::Repository> repo_;
+  std::string componentId_;
+  std::string componentType_;
+
+  std::mutex aggregation_mutex_;
+  uint64_t aggregation_interval_;
+  uint64_t aggregation_start_;
+  std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceEventCount> counts_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
 // Provenance Reporter
 class ProvenanceReporter {
  public:
@@ -450,11 +539,12 @@ class ProvenanceReporter {
   /*!
    * Create a new provenance reporter associated with the process session
    */
-  ProvenanceReporter(std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType)
+  ProvenanceReporter(std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType, std::shared_ptr<ProvenancePolicy> policy = nullptr)
       : logger_(logging::LoggerFactory<ProvenanceReporter>::getLogger()) {
     _componentId = componentId;
     _componentType = componentType;
     repo_ = repo;
+    policy_ = std::move(policy);
   }
 
   // Destructor
@@ -479,6 +569,7 @@ class ProvenanceReporter {
   // clear
   void clear() {
     _events.clear();
+    pending_counts_.clear();
   }
   // commit
   void commit();
@@ -508,15 +599,26 @@ class ProvenanceReporter {
   void receive(std::shared_ptr<core::FlowFile> flow, std::string transitUri, std::string sourceSystemFlowFileIdentifier, std::string detail, uint64_t processingDuration);
 
  protected:
-  // allocate
+  // allocate, returns nullptr if the event is not to be recorded
   std::shared_ptr<ProvenanceEventRecord> allocate(ProvenanceEventRecord::ProvenanceEventType eventType, std::shared_ptr<core::FlowFile> flow) {
     if (repo_->isNoop()) {
       return nullptr;
     }
+    if (policy_) {
+      if (policy_->getMode() == ProvenancePolicy::Mode::AGGREGATE) {
+        auto &count = pending_counts_[eventType];
+        count.events++;
+        count.bytes += flow->getSize();
+        return nullptr;
+      }
+      if (!policy_->sample()) {
+        return nullptr;
+      }
+    }
 
     auto event = std::make_shared<ProvenanceEventRecord>(eventType, _componentId, _componentType);
     if (event)
-      event->fromFlowFile(flow);
+      event->fromFlowFile(flow, policy_ == nullptr || policy_->includeAttributes());
 
     return event;
   }
@@ -532,6 +634,9 @@ class ProvenanceReporter {
   std::set<std::shared_ptr<ProvenanceEventRecord>> _events;
   // provenance repository.
   std::shared_ptr<core::Repository> repo_;
+  std::shared_ptr<ProvenancePolicy> policy_;
+  // counts of the aggregation mode, handed to the policy on commit
+  std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceEventCount> pending_counts_;
 
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
@@ -0,0 +1,106 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_SITETOSITE_COMPRESSIONSTREAM_H_
+#define LIBMINIFI_INCLUDE_SITETOSITE_COMPRESSIONSTREAM_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "io/DataStream.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+/**
+ * Purpose: Compresses the data packets of a site-to-site transaction once the peers negotiated compression.
+ *
+ * Design: Follows NiFi's CompressionOutputStream. The data is collected in chunks, each of which is
+ * deflated on its own and written as "SYNC", the original and the compressed length as 32 bit big endian
+ * integers and the compressed bytes. A 1 precedes every further chunk and a 0 ends the compressed data,
+ * after which the stream can be reused for the next packet.
+ */
+class CompressionOutputStream : public io::DataStream {
+ public:
+  static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+  static constexpr int DEFAULT_COMPRESSION_LEVEL = 1;
+
+  explicit CompressionOutputStream(io::DataStream *output, int level = DEFAULT_COMPRESSION_LEVEL, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+  int writeData(uint8_t *value, int size) override;
+
+  /**
+   * Writes the buffered data and the end of the compressed data.
+   * @return false if they could not be written
+   */
+  bool finish();
+
+ private:
+  bool compressAndWrite();
+
+  io::DataStream *output_;
+  int level_;
+  size_t buffer_size_;
+  std::vector<uint8_t> buffer_;
+  std::vector<uint8_t> compressed_;
+  bool data_written_;
+};
+
+/**
+ * Purpose: Reads the data compressed by a CompressionOutputStream.
+ *
+ * Design: A chunk is read and inflated once the previous one is consumed, together with the byte that
+ * tells whether another chunk follows, so nothing past the compressed data is read from the input.
+ */
+class CompressionInputStream : public io::DataStream {
+ public:
+  explicit CompressionInputStream(io::DataStream *input);
+
+  int readData(std::vector<uint8_t> &buf, int buflen) override;
+
+  int readData(uint8_t *buf, int buflen) override;
+
+  /**
+   * @return true once the compressed data has been read completely
+   */
+  bool isFinished() const {
+    return all_data_read_ && index_ >= buffer_.size();
+  }
+
+ private:
+  bool readChunk();
+
+  io::DataStream *input_;
+  std::vector<uint8_t> buffer_;
+  size_t index_;
+  std::vector<uint8_t> compressed_;
+  bool all_data_read_;
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+}  // namespace sitetosite
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_SITETOSITE_COMPRESSIONSTREAM_H_
@@ -35,6 +35,7 @@
 #include "io/DataStream.h"
 #include "io/EndianCheck.h"
 #include "properties/Configure.h"
+#include "sitetosite/CompressionStream.h"
 #include "utils/HTTPClient.h"
 #include "utils/TimeUtil.h"
 
@@ -117,7 +118,7 @@ class PeerStatus {
     return peer_;
   }
 
-  uint32_t getFlowFileCount() {
+  uint32_t getFlowFileCount() const {
     return flow_file_count_;
   }
 
@@ -165,6 +166,7 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
 
   explicit SiteToSitePeer(SiteToSitePeer &&ss)
       : stream_(ss.stream_.release()),
+        write_buffer_size_(ss.write_buffer_size_),
         host_(std::move(ss.host_)),
         port_(std::move(ss.port_)),
         local_network_interface_(std::move(ss.local_network_interface_)),
@@ -290,51 +292,102 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
     return stream_.get();
   }
 
+  /**
+   * Collects the writes in a buffer of the given size, which is handed to the stream once it is full
+   * and before anything is read from the peer, so a message made of many small fields is sent at once.
+   * A size of 0 disables the buffering.
+   */
+  void setWriteBufferSize(size_t size) {
+    write_buffer_size_ = size;
+  }
+
+  /**
+   * Writes the buffered data to the stream.
+   * @return false if the data could not be written
+   */
+  bool flush();
+
+  /**
+   * Compresses the data written from now on, as negotiated for the data packets of a transaction,
+   * until finishCompression is called.
+   */
+  void startCompression();
+
+  /**
+   * Writes the remaining compressed data and the end of it.
+   * @return false if the data could not be written
+   */
+  bool finishCompression();
+
+  /**
+   * Drops the compressor without writing the remaining compressed data, after a failed write.
+   */
+  void discardCompression() {
+    compressor_ = nullptr;
+  }
+
+  /**
+   * Decompresses the data read from now on until the end of the compressed data is reached.
+   */
+  void startDecompression();
+
   int write(uint8_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, output()));
   }
   int write(char value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, output()));
   }
   int write(uint32_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, output()));
   }
   int write(uint16_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
-  }
-  int write(uint8_t *value, int len) {
-    return Serializable::write(value, len, stream_.get());
+    return buffered(Serializable::write(value, output()));
   }
+  int write(uint8_t *value, int len);
   int write(uint64_t value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::write(value, stream_.get());
+    return buffered(Serializable::write(value, output()));
   }
   int write(bool value) {
     uint8_t temp = value;
-    return Serializable::write(temp, stream_.get());
+    return buffered(Serializable::write(temp, output()));
   }
   int writeUTF(std::string str, bool widen = false) {
-    return Serializable::writeUTF(str, stream_.get(), widen);
+    return buffered(Serializable::writeUTF(str, output(), widen));
   }
   int read(uint8_t &value) {
-    return Serializable::read(value, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, input());
   }
   int read(uint16_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::read(value, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, input());
   }
   int read(char &value) {
-    return Serializable::read(value, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, input());
   }
   int read(uint8_t *value, int len) {
-    return Serializable::read(value, len, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, len, input());
   }
   int read(uint32_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::read(value, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, input());
   }
   int read(uint64_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
-    return Serializable::read(value, stream_.get());
+    if (!flush())
+      return -1;
+    return Serializable::read(value, input());
   }
   int readUTF(std::string &str, bool widen = false) {
-    return org::apache::nifi::minifi::io::Serializable::readUTF(str, stream_.get(), widen);
+    if (!flush())
+      return -1;
+    return org::apache::nifi::minifi::io::Serializable::readUTF(str, input(), widen);
   }
   // open connection to the peer
   bool Open();
@@ -346,6 +399,7 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
    */
   SiteToSitePeer& operator=(SiteToSitePeer&& other) {
     stream_ = std::unique_ptr<org::apache::nifi::minifi::io::DataStream>(other.stream_.release());
+    write_buffer_size_ = other.write_buffer_size_;
     host_ = std::move(other.host_);
     port_ = std::move(other.port_);
     local_network_interface_ = std::move(other.local_network_interface_);
@@ -360,8 +414,35 @@ class SiteToSitePeer : public org::apache::nifi::minifi::io::BaseStream {
   SiteToSitePeer &operator=(const SiteToSitePeer &parent) = delete;
 
  private:
+  org::apache::nifi::minifi::io::DataStream *rawOutput() {
+    return write_buffer_size_ > 0 ? &write_buffer_ : stream_.get();
+  }
+
+  org::apache::nifi::minifi::io::DataStream *output() {
+    return compressor_ != nullptr ? compressor_.get() : rawOutput();
+  }
+
+  org::apache::nifi::minifi::io::DataStream *input() {
+    if (decompressor_ != nullptr && decompressor_->isFinished())
+      decompressor_ = nullptr;
+    return decompressor_ != nullptr ? decompressor_.get() : stream_.get();
+  }
+
+  // flushes the write buffer once it is full
+  int buffered(int ret) {
+    if (ret > 0 && write_buffer_.getSize() >= write_buffer_size_ && !flush())
+      return -1;
+    return ret;
+  }
+
   std::unique_ptr<org::apache::nifi::minifi::io::DataStream> stream_;
 
+  size_t write_buffer_size_ = 0;
+  org::apache::nifi::minifi::io::DataStream write_buffer_;
+
+  std::unique_ptr<CompressionOutputStream> compressor_;
+  std::unique_ptr<CompressionInputStream> decompressor_;
+
   std::string host_;
 
   uint16_t port_;
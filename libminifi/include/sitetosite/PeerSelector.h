@@ -0,0 +1,120 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_
+#define LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sitetosite/Peer.h"
+#include "sitetosite/SiteToSite.h"
+#include "sitetosite/SiteToSiteClient.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+/**
+ * Purpose: Spreads the concurrent transactions of a remote port across the peers of the remote cluster.
+ *
+ * Design: Every peer is weighted by the flow file count it reported, so that flow files are sent to the
+ * peers with the fewest queued flow files and received from those with the most, as NiFi's PeerSelector does.
+ * A transaction goes to the peer with the fewest active transactions relative to its weight, so a slow peer,
+ * whose transactions stay active longer, gets fewer of them. Peers are penalized for a while after a failed
+ * transaction and the idle clients are pooled per peer, keeping their connections for later transactions.
+ */
+class PeerSelector {
+ public:
+  static constexpr uint64_t DEFAULT_PENALIZATION_MILLIS = 30000;
+
+  explicit PeerSelector(TransferDirection direction = SEND, size_t max_idle_clients = 1, uint64_t penalization_millis = DEFAULT_PENALIZATION_MILLIS);
+
+  void setDirection(TransferDirection direction);
+
+  /**
+   * Sets the number of idle clients kept per peer.
+   */
+  void setMaxIdleClients(size_t max_idle_clients);
+
+  /**
+   * Replaces the peers and their weights. The active transactions, penalties and idle clients
+   * of the peers that remain are kept.
+   */
+  void setPeers(const std::vector<PeerStatus> &peers);
+
+  size_t getPeerCount() const;
+
+  /**
+   * Chooses the peer of a new transaction and counts the transaction as active.
+   * @param client set to an idle client of the peer, if there is one
+   * @return the peer, or nullptr if there is no peer that is not penalized
+   */
+  std::shared_ptr<Peer> acquire(std::unique_ptr<SiteToSiteClient> &client);
+
+  /**
+   * Ends a transaction with the peer, keeping the client for the next transactions.
+   * @param client client to keep, may be nullptr
+   */
+  void release(const std::string &address, std::unique_ptr<SiteToSiteClient> client);
+
+  /**
+   * Ends a failed transaction with the peer, which is not chosen again until its penalty expires.
+   */
+  void penalize(const std::string &address);
+
+  /**
+   * Drops the idle clients.
+   */
+  void clear();
+
+  static std::string getAddress(const Peer &peer) {
+    return peer.getHost() + ":" + std::to_string(peer.getPort());
+  }
+
+ private:
+  struct PeerState {
+    std::shared_ptr<Peer> peer;
+    std::string address;
+    double weight;
+    size_t active_transactions;
+    uint64_t penalized_until;
+    std::vector<std::unique_ptr<SiteToSiteClient>> idle_clients;
+  };
+
+  PeerState *find(const std::string &address);
+
+  mutable std::mutex mutex_;
+  TransferDirection direction_;
+  size_t max_idle_clients_;
+  uint64_t penalization_millis_;
+  std::vector<PeerState> peers_;
+  // rotates the choice among equally loaded peers
+  size_t next_index_;
+};
+
+}  // namespace sitetosite
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_
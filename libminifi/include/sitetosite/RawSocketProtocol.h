@@ -66,6 +66,8 @@ class RawSiteToSiteClient : public sitetosite::SiteToSiteClient {
  public:
   // HandShakeProperty Str
   static const char *HandShakePropertyStr[MAX_HANDSHAKE_PROPERTY];
+  // the small fields of a message, and the content of small flow files, are coalesced into writes of this size
+  static constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
 
   // Constructor
   /*!
@@ -74,6 +76,8 @@ class RawSiteToSiteClient : public sitetosite::SiteToSiteClient {
   RawSiteToSiteClient(std::unique_ptr<SiteToSitePeer> peer) // NOLINT
       : logger_(logging::LoggerFactory<RawSiteToSiteClient>::getLogger()) {
     peer_ = std::move(peer);
+    if (peer_)
+      peer_->setWriteBufferSize(WRITE_BUFFER_SIZE);
     _batchSize = 0;
     _batchCount = 0;
     _batchDuration = 0;
@@ -371,6 +371,14 @@ class SiteToSiteClientConfiguration {
     return idle_timeout_;
   }
 
+  void setUseCompression(bool use_compression) {
+    use_compression_ = use_compression;
+  }
+
+  bool getUseCompression() const {
+    return use_compression_;
+  }
+
   // setInterface
   void setInterface(std::string &ifc) {
     local_network_interface_ = ifc;
@@ -396,6 +404,8 @@ class SiteToSiteClientConfiguration {
 
   std::chrono::milliseconds idle_timeout_{15000};
 
+  bool use_compression_{false};
+
   // secore comms
 
   std::shared_ptr<controllers::SSLContextService> ssl_service_;
@@ -158,6 +158,17 @@ class SiteToSiteClient : public core::Connectable {
      idle_timeout_ = timeout;
   }
 
+  /**
+   * Sets whether the data packets are compressed, which is negotiated when the transactions are created.
+   */
+  void setUseCompression(bool use_compression) {
+    use_compression_ = use_compression;
+  }
+
+  bool getUseCompression() const {
+    return use_compression_;
+  }
+
   /**
    * Sets the base peer for this interface.
    */
@@ -165,6 +176,17 @@ class SiteToSiteClient : public core::Connectable {
     peer_ = std::move(peer);
   }
 
+  /**
+   * Provides the "host:port" address of the peer
+   * @returns peer address, empty without a peer
+   */
+  std::string getPeerAddress() const {
+    if (peer_ == nullptr) {
+      return "";
+    }
+    return peer_->getHostName() + ":" + std::to_string(peer_->getPort());
+  }
+
   /**
    * Provides a reference to the port identifier
    * @returns port identifier
@@ -255,6 +277,9 @@ class SiteToSiteClient : public core::Connectable {
   // idleTimeout
   std::chrono::milliseconds idle_timeout_{15000};
 
+  // compress the data packets
+  bool use_compression_{false};
+
   // Peer Connection
   std::unique_ptr<SiteToSitePeer> peer_;
 
@@ -0,0 +1,122 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBMINIFI_INCLUDE_UTILS_FLOWFILEQUEUE_H_
+#define LIBMINIFI_INCLUDE_UTILS_FLOWFILEQUEUE_H_
+
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "core/FlowFile.h"
+#include "core/FlowFilePrioritizer.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Queue of FlowFiles which keeps penalized FlowFiles out of the way of ready ones.
+ *
+ * Ready FlowFiles are kept in insertion order, or in a heap ordered by the configured prioritizers.
+ * Penalized FlowFiles are kept in a min-heap keyed on their penalty expiration and are moved over
+ * to the ready FlowFiles once their penalty expires.
+ * The queue is not synchronized, the owner (usually a Connection) has to guard it.
+ */
+class FlowFileQueue {
+ public:
+  using value_type = std::shared_ptr<core::FlowFile>;
+
+  /**
+   * Sets the prioritizers deciding the order of ready FlowFiles, the earlier ones taking precedence.
+   * An empty list restores insertion order. Already queued FlowFiles are reordered.
+   */
+  void setPrioritizers(std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers);
+
+  /**
+   * Removes and returns the first ready FlowFile, or nullptr if every queued FlowFile is penalized.
+   */
+  value_type pop();
+
+  void push(const value_type& element);
+  void push(value_type&& element);
+
+  /**
+   * Removes and returns every queued FlowFile, penalized or not.
+   */
+  std::vector<value_type> clear();
+
+  /**
+   * @return true if there is at least one FlowFile which is not penalized
+   */
+  bool isWorkAvailable() const;
+
+  /**
+   * @return true if there are no FlowFiles queued at all
+   */
+  bool empty() const;
+
+  /**
+   * @return number of queued FlowFiles including the penalized ones
+   */
+  size_t size() const;
+
+ private:
+  struct FlowFilePenaltyExpirationComparator {
+    bool operator()(const value_type& left, const value_type& right) const {
+      // std::priority_queue is a max-heap, invert the comparison to have the earliest expiration on top
+      return left->getPenaltyExpiration() > right->getPenaltyExpiration();
+    }
+  };
+
+  struct PrioritizedFlowFile {
+    value_type flow_file;
+    uint64_t sequence;
+    // parsed on push, so that the heap comparisons do not parse the attribute again
+    core::FlowFilePriority priority;
+  };
+
+  // Heap comparator, true if lhs should be handed out after rhs
+  bool isHandedOutAfter(const PrioritizedFlowFile& lhs, const PrioritizedFlowFile& rhs) const;
+
+  void pushReady(value_type&& element);
+  value_type popReady();
+  void releaseExpiredPenalties();
+
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers_;
+  // whether any of the prioritizers compares the parsed priorities
+  bool parse_priorities_ = false;
+  // Ready FlowFiles in insertion order, used when there are no prioritizers
+  std::deque<value_type> ready_;
+  // Heap of ready FlowFiles, used when there are prioritizers
+  std::vector<PrioritizedFlowFile> prioritized_;
+  // Insertion counter breaking the ties of the prioritizers
+  uint64_t sequence_ = 0;
+  std::priority_queue<value_type, std::vector<value_type>, FlowFilePenaltyExpirationComparator> penalized_;
+};
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_UTILS_FLOWFILEQUEUE_H_
@@ -149,6 +149,12 @@ class StringUtils {
     return std::equal(endString.rbegin(), endString.rend(), value.rbegin());
   }
 
+  inline static bool startsWith(const std::string &value, const std::string & startString) {
+    if (startString.size() > value.size())
+      return false;
+    return std::equal(startString.begin(), startString.end(), value.begin());
+  }
+
   inline static std::string hex_ascii(const std::string& in) {
     int len = in.length();
     std::string newString;
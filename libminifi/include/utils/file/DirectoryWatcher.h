@@ -0,0 +1,114 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_UTILS_FILE_DIRECTORYWATCHER_H_
+#define LIBMINIFI_INCLUDE_UTILS_FILE_DIRECTORYWATCHER_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+namespace file {
+
+/**
+ * Purpose: Reports the changes of the files in a directory, so that processors do not need to list
+ * large directories to find out what changed.
+ *
+ * Design: Backed by inotify, the watcher is not available on other platforms. Subdirectories are
+ * watched as they appear when recursive, files found in a new subdirectory are reported as written
+ * since they may have been created before the watch was in place. The kernel drops events once its
+ * queue is full, in that case poll() returns false and the caller has to list the directory
+ * instead. Events may be reported more than once, consumers are expected to tolerate that.
+ * The watcher is not synchronized.
+ */
+class DirectoryWatcher {
+ public:
+  enum class EventType {
+    // the file was closed after writing or moved into the directory
+    WRITTEN,
+    // the file was written, only reported if modifications are watched
+    MODIFIED,
+    // the file was deleted or moved out of the directory
+    REMOVED
+  };
+
+  struct Event {
+    std::string directory;
+    std::string filename;
+    EventType type;
+  };
+
+  explicit DirectoryWatcher(bool recursive = false, bool watch_modifications = false);
+
+  ~DirectoryWatcher();
+
+  DirectoryWatcher(const DirectoryWatcher&) = delete;
+  DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+  /**
+   * @return whether watching is supported on this platform
+   */
+  static bool isSupported();
+
+  /**
+   * Starts watching the directory, and its subdirectories if recursive.
+   * @return false if the directory cannot be watched, e.g. if the platform has no support or the
+   * limit of watches is reached
+   */
+  bool watch(const std::string &directory);
+
+  /**
+   * Collects the pending events, waiting at most timeout for the first one.
+   * @return false if events were lost since the last call or the watcher failed, the caller should
+   * list the directories to reconcile its state
+   */
+  bool poll(std::vector<Event> &events, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+  /**
+   * Stops watching all directories.
+   */
+  void close();
+
+ private:
+  bool addWatch(const std::string &directory, std::vector<Event> *found_files);
+
+  bool recursive_;
+  bool watch_modifications_;
+  int fd_;
+  // watched directories by watch descriptor
+  std::map<int, std::string> directories_;
+
+  std::shared_ptr<core::logging::Logger> logger_;
+};
+
+}  // namespace file
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
+
+#endif  // LIBMINIFI_INCLUDE_UTILS_FILE_DIRECTORYWATCHER_H_
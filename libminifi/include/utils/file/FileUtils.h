@@ -723,6 +723,15 @@ class FileUtils {
 #endif /* WIN32 */
 
   static uint64_t computeChecksum(const std::string &file_name, uint64_t up_to_position);
+
+  /**
+   * Copies the content of source starting at offset to destination, which is created or truncated.
+   * On Linux regular files are cloned or copied by the kernel (FICLONE, copy_file_range, sendfile),
+   * without passing the data through user space.
+   * @param copied set to the number of bytes copied
+   * @return false if the files could not be opened or the copy failed
+   */
+  static bool copy_file_contents(const std::string &source, uint64_t offset, const std::string &destination, uint64_t &copied);
 }; // NOLINT
 
 }  // namespace file
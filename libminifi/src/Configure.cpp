@@ -39,6 +39,8 @@ const char *Configure::nifi_server_name = "nifi.server.name";
 const char *Configure::nifi_configuration_class_name = "nifi.flow.configuration.class.name";
 const char *Configure::nifi_flow_repository_class_name = "nifi.flowfile.repository.class.name";
 const char *Configure::nifi_content_repository_class_name = "nifi.content.repository.class.name";
+const char *Configure::nifi_content_repository_container_enabled = "nifi.content.repository.container.enabled";
+const char *Configure::nifi_content_repository_container_max_size = "nifi.content.repository.container.max.size";
 const char *Configure::nifi_volatile_repository_options = "nifi.volatile.repository.options.";
 const char *Configure::nifi_provenance_repository_class_name = "nifi.provenance.repository.class.name";
 const char *Configure::nifi_server_port = "nifi.server.port";
@@ -46,10 +48,16 @@ const char *Configure::nifi_server_report_interval = "nifi.server.report.interva
 const char *Configure::nifi_provenance_repository_max_storage_size = "nifi.provenance.repository.max.storage.size";
 const char *Configure::nifi_provenance_repository_max_storage_time = "nifi.provenance.repository.max.storage.time";
 const char *Configure::nifi_provenance_repository_directory_default = "nifi.provenance.repository.directory.default";
+const char *Configure::nifi_provenance_mode = "nifi.provenance.mode";
+const char *Configure::nifi_provenance_sampling_rate = "nifi.provenance.sampling.rate";
+const char *Configure::nifi_provenance_aggregation_interval = "nifi.provenance.aggregation.interval";
 const char *Configure::nifi_flowfile_repository_max_storage_size = "nifi.flowfile.repository.max.storage.size";
 const char *Configure::nifi_flowfile_repository_max_storage_time = "nifi.flowfile.repository.max.storage.time";
 const char *Configure::nifi_flowfile_repository_directory_default = "nifi.flowfile.repository.directory.default";
+const char *Configure::nifi_flowfile_repository_group_commit_max_latency = "nifi.flowfile.repository.group.commit.max.latency";
+const char *Configure::nifi_flowfile_repository_durability = "nifi.flowfile.repository.durability";
 const char *Configure::nifi_dbcontent_repository_directory_default = "nifi.database.content.repository.directory.default";
+const char *Configure::nifi_dbcontent_repository_chunk_size = "nifi.database.content.repository.chunk.size";
 const char *Configure::nifi_remote_input_secure = "nifi.remote.input.secure";
 const char *Configure::nifi_remote_input_http = "nifi.remote.input.http.enabled";
 const char *Configure::nifi_security_need_ClientAuth = "nifi.security.need.ClientAuth";
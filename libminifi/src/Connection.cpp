@@ -49,6 +49,9 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  lock_free_ingest_ = false;
+  ingest_count_ = 0;
   drop_empty_ = false;
 
   logger_->log_debug("Connection %s created", name_);
@@ -65,6 +68,9 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  lock_free_ingest_ = false;
+  ingest_count_ = 0;
   drop_empty_ = false;
 
   logger_->log_debug("Connection %s created", name_);
@@ -85,6 +91,9 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  lock_free_ingest_ = false;
+  ingest_count_ = 0;
   drop_empty_ = false;
 
   logger_->log_debug("Connection %s created", name_);
@@ -106,25 +115,44 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  lock_free_ingest_ = false;
+  ingest_count_ = 0;
   drop_empty_ = false;
 
   logger_->log_debug("Connection %s created", name_);
 }
 
-bool Connection::isEmpty() {
+void Connection::setPrioritizers(std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers) {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  return queue_.empty();
+  prioritizers_ = prioritizers;
+  queue_.setPrioritizers(std::move(prioritizers));
 }
 
-bool Connection::isFull() {
+std::vector<std::shared_ptr<core::FlowFilePrioritizer>> Connection::getPrioritizers() {
   std::lock_guard<std::mutex> lock(mutex_);
 
+  return prioritizers_;
+}
+
+bool Connection::hasReadyFlowFiles() {
+  if (queued_count_ == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the ingested flow files may all be penalized
+  drainIngestQueue();
+
+  return queue_.isWorkAvailable();
+}
+
+bool Connection::isFull() {
   if (max_queue_size_ <= 0 && max_data_queue_size_ <= 0)
     // No back pressure setting
     return false;
 
-  if (max_queue_size_ > 0 && queue_.size() >= max_queue_size_)
+  if (max_queue_size_ > 0 && queued_count_ >= max_queue_size_)
     return true;
 
   if (max_data_queue_size_ > 0 && queued_data_size_ >= max_data_queue_size_)
@@ -133,21 +161,63 @@ bool Connection::isFull() {
   return false;
 }
 
-void Connection::put(std::shared_ptr<core::FlowFile> flow) {
-  if (drop_empty_ && flow->getSize() == 0) {
-    logger_->log_info("Dropping empty flow file: %s", flow->getUUIDStr());
+void Connection::enqueue(const std::vector<std::shared_ptr<core::FlowFile>> &flows) {
+  for (const auto &ff : flows) {
+    queued_data_size_ += ff->getSize();
+    logger_->log_debug("Enqueue flow file UUID %s to connection %s", ff->getUUIDStr(), name_);
+  }
+  queued_count_ += flows.size();
+
+  if (lock_free_ingest_) {
+    ingest_count_ += flows.size();
+    ingest_queue_.enqueue_bulk(flows.begin(), flows.size());
     return;
   }
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
 
-    queue_.push(flow);
+  std::lock_guard<std::mutex> lock(mutex_);
 
-    queued_data_size_ += flow->getSize();
+  for (const auto &ff : flows) {
+    queue_.push(ff);
+  }
+}
 
-    logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+void Connection::enqueue(const std::shared_ptr<core::FlowFile> &flow) {
+  queued_data_size_ += flow->getSize();
+  logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+  ++queued_count_;
+
+  if (lock_free_ingest_) {
+    ++ingest_count_;
+    ingest_queue_.enqueue(flow);
+    return;
   }
 
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  queue_.push(flow);
+}
+
+void Connection::drainIngestQueue() {
+  if (ingest_count_ == 0) {
+    return;
+  }
+  std::vector<std::shared_ptr<core::FlowFile>> items(64);
+  size_t count;
+  while ((count = ingest_queue_.try_dequeue_bulk(items.begin(), items.size())) > 0) {
+    ingest_count_ -= count;
+    for (size_t i = 0; i < count; ++i) {
+      queue_.push(std::move(items[i]));
+    }
+  }
+}
+
+void Connection::put(std::shared_ptr<core::FlowFile> flow) {
+  if (drop_empty_ && flow->getSize() == 0) {
+    logger_->log_info("Dropping empty flow file: %s", flow->getUUIDStr());
+    return;
+  }
+  enqueue(flow);
+
   if (!flow->isStored()) {
     // Save to the flowfile repo
     FlowFileRecord event(flow_repository_, content_repo_, flow, this->uuidStr_);
@@ -168,33 +238,30 @@ void Connection::put(std::shared_ptr<core::FlowFile> flow) {
 
 void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
   std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> flowData;
+  std::vector<std::shared_ptr<core::FlowFile>> queued;
+  queued.reserve(flows.size());
 
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    for (auto &ff : flows) {
-      if (drop_empty_ && ff->getSize() == 0) {
-        logger_->log_info("Dropping empty flow file: %s", ff->getUUIDStr());
-        continue;
-      }
-
-      queue_.push(ff);
-      queued_data_size_ += ff->getSize();
+  for (auto &ff : flows) {
+    if (drop_empty_ && ff->getSize() == 0) {
+      logger_->log_info("Dropping empty flow file: %s", ff->getUUIDStr());
+      continue;
+    }
 
-      logger_->log_debug("Enqueue flow file UUID %s to connection %s", ff->getUUIDStr(), name_);
+    queued.push_back(ff);
 
-      if (!ff->isStored()) {
-        // Save to the flowfile repo
-        FlowFileRecord event(flow_repository_, content_repo_, ff, this->uuidStr_);
+    if (!ff->isStored()) {
+      // Save to the flowfile repo
+      FlowFileRecord event(flow_repository_, content_repo_, ff, this->uuidStr_);
 
-        std::unique_ptr<io::DataStream> stramptr(new io::DataStream());
-        event.Serialize(*stramptr.get());
+      std::unique_ptr<io::DataStream> stramptr(new io::DataStream());
+      event.Serialize(*stramptr.get());
 
-        flowData.emplace_back(event.getUUIDStr(), std::move(stramptr));
-      }
+      flowData.emplace_back(event.getUUIDStr(), std::move(stramptr));
     }
   }
 
+  enqueue(queued);
+
   if (!flow_repository_->MultiPut(flowData)) {
     logger_->log_error("Failed execute multiput on FF repo!");
     throw Exception(PROCESS_SESSION_EXCEPTION, "Failed to put flowfiles to repository");
@@ -214,60 +281,72 @@ void Connection::multiPut(std::vector<std::shared_ptr<core::FlowFile>>& flows) {
   }
 }
 
-std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
+std::shared_ptr<core::FlowFile> Connection::pollLocked(uint64_t now, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  drainIngestQueue();
+  // Penalized flow files are held back by the queue itself, so they never block the ready ones
+  while (std::shared_ptr<core::FlowFile> item = queue_.pop()) {
     queued_data_size_ -= item->getSize();
+    --queued_count_;
 
-    if (expired_duration_ > 0) {
-      // We need to check for flow expiration
-      if (getTimeMillis() > (item->getEntryDate() + expired_duration_)) {
-        // Flow record expired
-        expiredFlowRecords.insert(item);
-        logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
-        if (flow_repository_->Delete(item->getUUIDStr())) {
-          item->setStoredToRepository(false);
-        }
-      } else {
-        // Flow record not expired
-        if (item->isPenalized()) {
-          // Flow record was penalized
-          queue_.push(item);
-          queued_data_size_ += item->getSize();
-          break;
-        }
-        std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-        item->setOriginalConnection(connectable);
-        logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-        return item;
-      }
-    } else {
-      // Flow record not expired
-      if (item->isPenalized()) {
-        // Flow record was penalized
-        queue_.push(item);
-        queued_data_size_ += item->getSize();
-        break;
+    if (expired_duration_ > 0 && now > (item->getEntryDate() + expired_duration_)) {
+      // Flow record expired
+      expiredFlowRecords.insert(item);
+      logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+      if (flow_repository_->Delete(item->getUUIDStr())) {
+        item->setStoredToRepository(false);
       }
-      std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-      item->setOriginalConnection(connectable);
-      logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-      return item;
+      continue;
     }
+
+    logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
+    return item;
   }
 
-  return NULL;
+  return nullptr;
+}
+
+std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::shared_ptr<core::FlowFile> item = pollLocked(getTimeMillis(), expiredFlowRecords);
+  if (item) {
+    std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+    item->setOriginalConnection(connectable);
+  }
+  return item;
+}
+
+std::vector<std::shared_ptr<core::FlowFile>> Connection::pollBatch(size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  std::vector<std::shared_ptr<core::FlowFile>> items;
+  if (max_count == 0) {
+    return items;
+  }
+  std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+  const uint64_t now = getTimeMillis();
+  uint64_t polled_bytes = 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  items.reserve(std::min<size_t>(max_count, queue_.size()));
+  while (items.size() < max_count && (max_bytes == 0 || polled_bytes < max_bytes)) {
+    std::shared_ptr<core::FlowFile> item = pollLocked(now, expiredFlowRecords);
+    if (!item) {
+      break;
+    }
+    item->setOriginalConnection(connectable);
+    polled_bytes += item->getSize();
+    items.push_back(std::move(item));
+  }
+  return items;
 }
 
 void Connection::drain(bool delete_permanently) {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
+  drainIngestQueue();
+  for (const auto& item : queue_.clear()) {
+    queued_data_size_ -= item->getSize();
+    --queued_count_;
     logger_->log_debug("Delete flow file UUID %s from connection %s", item->getUUIDStr(), name_);
     if (delete_permanently) {
       if (flow_repository_->Delete(item->getUUIDStr())) {
@@ -275,7 +354,6 @@ void Connection::drain(bool delete_permanently) {
       }
     }
   }
-  queued_data_size_ = 0;
   logger_->log_debug("Drain connection %s", name_);
 }
 
@@ -45,6 +45,7 @@
 #include "core/Property.h"
 #include "core/Relationship.h"
 #include "utils/HTTPClient.h"
+#include "utils/TimeUtil.h"
 
 namespace org {
 namespace apache {
@@ -61,61 +62,56 @@ core::Property RemoteProcessorGroupPort::portUUID("Port UUID", "Specifies remote
 core::Property RemoteProcessorGroupPort::idleTimeout(
             core::PropertyBuilder::createProperty("Idle Timeout")->withDescription("Max idle time for remote service")->isRequired(false)
                     ->withDefaultValue<core::TimePeriodValue>("15 s")->build());
+core::Property RemoteProcessorGroupPort::useCompression(
+            core::PropertyBuilder::createProperty("Use Compression")->withDescription("Whether the data sent to and received from the remote port is compressed")
+                    ->isRequired(false)->withDefaultValue<bool>(false)->build());
 core::Relationship RemoteProcessorGroupPort::relation;
 
+constexpr uint64_t RemoteProcessorGroupPort::PEER_REFRESH_PERIOD_MILLIS;
+
 std::unique_ptr<sitetosite::SiteToSiteClient> RemoteProcessorGroupPort::getNextProtocol(bool create = true) {
+  if (create && !bypass_rest_api_ && (peer_selector_.getPeerCount() == 0 || getTimeMillis() - last_peer_refresh_ >= PEER_REFRESH_PERIOD_MILLIS)) {
+    // a single thread refreshes, the others carry on with the current peers
+    std::unique_lock<std::mutex> lock(peer_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      logger_->log_debug("Refreshing the peer list");
+      refreshPeerList();
+    }
+  }
   std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-  if (!available_protocols_.try_dequeue(nextProtocol)) {
-    if (create) {
-      // create
-      if (bypass_rest_api_) {
-        if (nifi_instances_.size() > 0) {
-          auto rpg = nifi_instances_.front();
-          auto host = rpg.host_;
-#ifdef WIN32
-          if ("localhost" == host) {
-            host = org::apache::nifi::minifi::io::Socket::getMyHostName();
-          }
-#endif
-          sitetosite::SiteToSiteClientConfiguration config(stream_factory_, std::make_shared<sitetosite::Peer>(protocol_uuid_, host, rpg.port_, ssl_service != nullptr), this->getInterface(),
-                                                           client_type_);
-          config.setHTTPProxy(this->proxy_);
-          config.setIdleTimeout(idle_timeout_);
-          nextProtocol = sitetosite::createClient(config);
-        }
-      } else if (peer_index_ >= 0) {
-        std::lock_guard<std::mutex> lock(peer_mutex_);
-        logger_->log_debug("Creating client from peer %d", peer_index_.load());
-        sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), local_network_interface_, client_type_);
-        config.setSecurityContext(ssl_service);
-        peer_index_++;
-        if (peer_index_ >= static_cast<int>(peers_.size())) {
-          peer_index_ = 0;
-        }
-        config.setHTTPProxy(this->proxy_);
-        config.setIdleTimeout(idle_timeout_);
-        nextProtocol = sitetosite::createClient(config);
-      } else {
-        logger_->log_debug("Refreshing the peer list since there are none configured.");
-        refreshPeerList();
-      }
+  auto peer = peer_selector_.acquire(nextProtocol);
+  if (peer == nullptr) {
+    logger_->log_debug("No peer is available for %s", getUUIDStr());
+    return nullptr;
+  }
+  if (nextProtocol == nullptr && create) {
+    logger_->log_debug("Creating client for peer %s:%d", peer->getHost(), peer->getPort());
+    sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peer, local_network_interface_, client_type_);
+    if (!bypass_rest_api_) {
+      config.setSecurityContext(ssl_service);
     }
+    config.setHTTPProxy(this->proxy_);
+    config.setIdleTimeout(idle_timeout_);
+    config.setUseCompression(use_compression_);
+    nextProtocol = sitetosite::createClient(config);
+  }
+  if (nextProtocol == nullptr) {
+    peer_selector_.release(sitetosite::PeerSelector::getAddress(*peer), nullptr);
+    return nullptr;
   }
-  logger_->log_debug("Obtained protocol from available_protocols_");
+  logger_->log_debug("Obtained protocol for peer %s", nextProtocol->getPeerAddress());
   return nextProtocol;
 }
 
 void RemoteProcessorGroupPort::returnProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> return_protocol) {
-  auto count = peers_.size();
-  if (max_concurrent_tasks_ > count)
-    count = max_concurrent_tasks_;
-  if (available_protocols_.size_approx() >= count) {
-    logger_->log_debug("not enqueueing protocol %s", getUUIDStr());
-    // let the memory be freed
-    return;
-  }
-  logger_->log_debug("enqueueing protocol %s, have a total of %lu", getUUIDStr(), available_protocols_.size_approx());
-  available_protocols_.enqueue(std::move(return_protocol));
+  const auto address = return_protocol->getPeerAddress();
+  peer_selector_.release(address, std::move(return_protocol));
+}
+
+void RemoteProcessorGroupPort::penalizeProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> protocol) {
+  const auto address = protocol->getPeerAddress();
+  logger_->log_debug("Penalizing peer %s of %s", address, getUUIDStr());
+  peer_selector_.penalize(address);
 }
 
 void RemoteProcessorGroupPort::initialize() {
@@ -126,6 +122,7 @@ void RemoteProcessorGroupPort::initialize() {
   properties.insert(SSLContext);
   properties.insert(portUUID);
   properties.insert(idleTimeout);
+  properties.insert(useCompression);
   setSupportedProperties(properties);
 // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -179,12 +176,15 @@ void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessCon
     }
     idle_timeout_ = std::chrono::milliseconds(idleTimeoutVal);
   }
+  context->getProperty(useCompression.getName(), use_compression_);
+
+  // every concurrent task runs its own transaction, so a client is kept for each of them
+  peer_selector_.setDirection(direction_);
+  peer_selector_.setMaxIdleClients((std::max)(max_concurrent_tasks_, static_cast<uint8_t>(1)));
 
   std::lock_guard<std::mutex> lock(peer_mutex_);
   if (!nifi_instances_.empty()) {
     refreshPeerList();
-    if (peers_.size() > 0)
-      peer_index_ = 0;
   }
   /**
    * If at this point we have no peers and HTTP support is disabled this means
@@ -199,33 +199,21 @@ void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessCon
     if (!host.empty() && !portStr.empty() && !portStr.empty() && core::Property::StringToInt(portStr, configured_port)) {
       nifi_instances_.push_back({ host, configured_port, "" });
       bypass_rest_api_ = true;
+#ifdef WIN32
+      if ("localhost" == host) {
+        host = org::apache::nifi::minifi::io::Socket::getMyHostName();
+      }
+#endif
+      std::vector<sitetosite::PeerStatus> peers;
+      peers.push_back(sitetosite::PeerStatus(std::make_shared<sitetosite::Peer>(protocol_uuid_, host, configured_port, ssl_service != nullptr), 0, false));
+      peer_selector_.setPeers(peers);
     } else {
       // we cannot proceed, so log error and throw an exception
       logger_->log_error("%s/%s/%d -- configuration values after eval of configuration options", host, portStr, configured_port);
       throw(Exception(SITE2SITE_EXCEPTION, "HTTPClient not resolvable. No peers configured or any port specific hostname and port -- cannot schedule"));
     }
   }
-  // populate the site2site protocol for load balancing between them
-  if (peers_.size() > 0) {
-    auto count = peers_.size();
-    if (max_concurrent_tasks_ > count)
-      count = max_concurrent_tasks_;
-    for (uint32_t i = 0; i < count; i++) {
-      std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-      sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), this->getInterface(), client_type_);
-      config.setSecurityContext(ssl_service);
-      peer_index_++;
-      if (peer_index_ >= static_cast<int>(peers_.size())) {
-        peer_index_ = 0;
-      }
-      logger_->log_trace("Creating client");
-      config.setHTTPProxy(this->proxy_);
-      config.setIdleTimeout(idle_timeout_);
-      nextProtocol = sitetosite::createClient(config);
-      logger_->log_trace("Created client, moving into available protocols");
-      returnProtocol(std::move(nextProtocol));
-    }
-  } else {
+  if (peer_selector_.getPeerCount() == 0) {
     // we don't have any peers
     logger_->log_error("No peers selected during scheduling");
   }
@@ -237,10 +225,7 @@ void RemoteProcessorGroupPort::notifyStop() {
   // we use the latch
   while (count.getCount() > 0) {
   }
-  std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-  while (available_protocols_.try_dequeue(nextProtocol)) {
-    // clear all protocols now
-  }
+  peer_selector_.clear();
 }
 
 void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
@@ -280,6 +265,9 @@ void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessCont
     context->yield();
     session->rollback();
   }
+  if (protocol_) {
+    penalizeProtocol(std::move(protocol_));
+  }
 }
 
 std::pair<std::string, int> RemoteProcessorGroupPort::refreshRemoteSite2SiteInfo() {
@@ -394,6 +382,7 @@ std::pair<std::string, int> RemoteProcessorGroupPort::refreshRemoteSite2SiteInfo
 }
 
 void RemoteProcessorGroupPort::refreshPeerList() {
+  last_peer_refresh_ = getTimeMillis();
   auto connection = refreshRemoteSite2SiteInfo();
   if (connection.second == -1) {
     logger_->log_debug("No port configured");
@@ -415,8 +404,7 @@ void RemoteProcessorGroupPort::refreshPeerList() {
 
   logging::LOG_INFO(logger_) << "Have " << peers_.size() << " peers";
 
-  if (peers_.size() > 0)
-    peer_index_ = 0;
+  peer_selector_.setPeers(peers_);
 }
 
 } /* namespace minifi */
@@ -0,0 +1,105 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/FlowFilePrioritizer.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+namespace {
+
+template<typename T>
+int compareValues(const T &lhs, const T &rhs) {
+  if (lhs < rhs) {
+    return -1;
+  }
+  return rhs < lhs ? 1 : 0;
+}
+
+}  // namespace
+
+constexpr const char* PriorityAttributePrioritizer::PRIORITY_ATTRIBUTE;
+
+FlowFilePriority FlowFilePriority::parse(const FlowFile &flow_file) {
+  FlowFilePriority priority;
+  priority.present = flow_file.getAttribute(PriorityAttributePrioritizer::PRIORITY_ATTRIBUTE, priority.text);
+  if (priority.present && !priority.text.empty()) {
+    char *end = nullptr;
+    errno = 0;
+    priority.value = std::strtoll(priority.text.c_str(), &end, 10);
+    priority.numeric = errno == 0 && end != nullptr && *end == '\0';
+  }
+  return priority;
+}
+
+std::shared_ptr<FlowFilePrioritizer> FlowFilePrioritizer::create(const std::string &name) {
+  const auto simple_name = name.substr(name.find_last_of('.') + 1);
+  if (simple_name == "OldestFlowFileFirstPrioritizer") {
+    return std::make_shared<OldestFlowFileFirstPrioritizer>();
+  } else if (simple_name == "NewestFlowFileFirstPrioritizer") {
+    return std::make_shared<NewestFlowFileFirstPrioritizer>();
+  } else if (simple_name == "PriorityAttributePrioritizer") {
+    return std::make_shared<PriorityAttributePrioritizer>();
+  } else if (simple_name == "SmallestFlowFileFirstPrioritizer") {
+    return std::make_shared<SmallestFlowFileFirstPrioritizer>();
+  }
+  return nullptr;
+}
+
+int OldestFlowFileFirstPrioritizer::compare(const FlowFile &lhs, const FlowFile &rhs) const {
+  return compareValues(lhs.getEntryDate(), rhs.getEntryDate());
+}
+
+int NewestFlowFileFirstPrioritizer::compare(const FlowFile &lhs, const FlowFile &rhs) const {
+  return compareValues(rhs.getEntryDate(), lhs.getEntryDate());
+}
+
+int PriorityAttributePrioritizer::compare(const FlowFile &lhs, const FlowFile &rhs) const {
+  return compare(lhs, FlowFilePriority::parse(lhs), rhs, FlowFilePriority::parse(rhs));
+}
+
+int PriorityAttributePrioritizer::compare(const FlowFile&, const FlowFilePriority &lhs_priority, const FlowFile&, const FlowFilePriority &rhs_priority) const {
+  if (!lhs_priority.present || !rhs_priority.present) {
+    // FlowFiles having a priority come first
+    return compareValues(!lhs_priority.present, !rhs_priority.present);
+  }
+  if (lhs_priority.numeric && rhs_priority.numeric) {
+    return compareValues(lhs_priority.value, rhs_priority.value);
+  } else if (lhs_priority.numeric || rhs_priority.numeric) {
+    // numeric priorities come before textual ones
+    return lhs_priority.numeric ? -1 : 1;
+  }
+  return compareValues(lhs_priority.text, rhs_priority.text);
+}
+
+int SmallestFlowFileFirstPrioritizer::compare(const FlowFile &lhs, const FlowFile &rhs) const {
+  return compareValues(lhs.getSize(), rhs.getSize());
+}
+
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
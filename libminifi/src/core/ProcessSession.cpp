@@ -226,6 +226,7 @@ void ProcessSession::remove(const std::shared_ptr<core::FlowFile> &flow) {
 }
 
 void ProcessSession::putAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key, std::string value) {
+  snapshot(flow);
   flow->setAttribute(key, value);
   std::stringstream details;
   details << process_context_->getProcessorNode()->getName() << " modify flow record " << flow->getUUIDStr() << " attribute " << key << ":" << value;
@@ -233,6 +234,7 @@ void ProcessSession::putAttribute(const std::shared_ptr<core::FlowFile> &flow, s
 }
 
 void ProcessSession::removeAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key) {
+  snapshot(flow);
   flow->removeAttribute(key);
   std::stringstream details;
   details << process_context_->getProcessorNode()->getName() << " remove flow record " << flow->getUUIDStr() << " attribute " + key;
@@ -240,6 +242,7 @@ void ProcessSession::removeAttribute(const std::shared_ptr<core::FlowFile> &flow
 }
 
 void ProcessSession::penalize(const std::shared_ptr<core::FlowFile> &flow) {
+  snapshot(flow);
   uint64_t penalization_period = process_context_->getProcessorNode()->getPenalizationPeriodMsec();
   logging::LOG_INFO(logger_) << "Penalizing " << flow->getUUIDStr() << " for " << penalization_period << "ms at " << process_context_->getProcessorNode()->getName();
   flow->setPenaltyExpiration(getTimeMillis() + penalization_period);
@@ -269,6 +272,7 @@ void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputSt
       return;
     }
 
+    snapshot(flow);
     flow->setSize(stream->getSize());
     flow->setOffset(0);
     std::shared_ptr<ResourceClaim> flow_claim = flow->getResourceClaim();
@@ -327,6 +331,7 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
       rollback();
       return;
     }
+    snapshot(flow);
     flow->setSize(stream->getSize());
 
     std::stringstream details;
@@ -412,6 +417,7 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
     }
     // Open the source file and stream to the flow file
 
+    snapshot(flow);
     flow->setSize(content_stream->getSize());
     flow->setOffset(0);
     if (flow->getResourceClaim() != nullptr) {
@@ -448,6 +454,30 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
 
 void ProcessSession::import(std::string source, const std::shared_ptr<core::FlowFile> &flow, bool keepSource, uint64_t offset) {
   std::shared_ptr<ResourceClaim> claim = std::make_shared<ResourceClaim>(process_context_->getContentRepository());
+
+  // file based repositories move or copy the file without streaming it
+  auto importStartTime = getTimeMillis();
+  uint64_t importedSize = 0;
+  if (process_context_->getContentRepository()->importFile(claim, source, offset, keepSource, importedSize)) {
+    claim->increaseFlowFileRecordOwnedCount();
+    snapshot(flow);
+    flow->setSize(importedSize);
+    flow->setOffset(0);
+    if (flow->getResourceClaim() != nullptr) {
+      // Remove the old claim
+      flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
+      flow->clearResourceClaim();
+    }
+    flow->setResourceClaim(claim);
+
+    logger_->log_debug("Import offset %" PRIu64 " length %" PRIu64 " into content %s for FlowFile UUID %s", offset, flow->getSize(), claim->getContentFullPath(), flow->getUUIDStr());
+
+    std::stringstream details;
+    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
+    provenance_report_->modifyContent(flow, details.str(), getTimeMillis() - importStartTime);
+    return;
+  }
+
   size_t size = getpagesize();
   std::vector<uint8_t> charBuffer(size);
 
@@ -488,6 +518,7 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
       }
 
       if (!invalidWrite) {
+        snapshot(flow);
         flow->setSize(stream->getSize());
         flow->setOffset(0);
         if (flow->getResourceClaim() != nullptr) {
@@ -879,6 +910,7 @@ void ProcessSession::commit() {
     _clonedFlowFiles.clear();
     _deletedFlowFiles.clear();
     _originalFlowFiles.clear();
+    _flowFileSnapshots.clear();
 
     _transferRelationship.clear();
     // persistent the provenance report
@@ -903,8 +935,10 @@ void ProcessSession::rollback() {
       std::shared_ptr<core::FlowFile> record = it.second;
       connection = std::static_pointer_cast<Connection>(record->getOriginalConnection());
       if ((connection) != nullptr) {
-        std::shared_ptr<FlowFileRecord> flowf = std::static_pointer_cast<FlowFileRecord>(record);
-        flowf->setSnapShot(false);
+        auto snapshot = _flowFileSnapshots.find(it.first);
+        if (snapshot != _flowFileSnapshots.end()) {
+          revertToSnapshot(record, snapshot->second);
+        }
         logger_->log_debug("ProcessSession rollback for %s, record %s, to connection %s", process_context_->getProcessorNode()->getName(), record->getUUIDStr(), connection->getName());
         connectionQueues[connection].push_back(record);
       }
@@ -915,6 +949,7 @@ void ProcessSession::rollback() {
     }
 
     _originalFlowFiles.clear();
+    _flowFileSnapshots.clear();
 
     _clonedFlowFiles.clear();
     _addedFlowFiles.clear();
@@ -943,30 +978,13 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   do {
     std::set<std::shared_ptr<core::FlowFile> > expired;
     std::shared_ptr<core::FlowFile> ret = current->poll(expired);
-    if (!expired.empty()) {
-      // Remove expired flow record
-      for (const auto& record : expired) {
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
-        provenance_report_->expire(record, details.str());
-      }
-    }
+    expire(expired);
     if (ret) {
       // add the flow record to the current process session update map
       ret->setDeleted(false);
       _updatedFlowFiles[ret->getUUIDStr()] = ret;
-      std::map<std::string, std::string> empty;
-      std::shared_ptr<core::FlowFile> snapshot = std::make_shared<FlowFileRecord>(process_context_->getFlowFileRepository(), process_context_->getContentRepository(), empty);
-      auto flow_version = process_context_->getProcessorNode()->getFlowIdentifier();
-      if (flow_version != nullptr) {
-        auto flow_id = flow_version->getFlowId();
-        std::string attr = FlowAttributeKey(FLOW_ID);
-        snapshot->setAttribute(attr, flow_version->getFlowId());
-      }
-      logger_->log_debug("Create Snapshot FlowFile with UUID %s", snapshot->getUUIDStr());
-      snapshot = ret;
-      // save a snapshot
-      _originalFlowFiles[snapshot->getUUIDStr()] = snapshot;
+      // remember the original, its state is only copied once the session modifies it
+      _originalFlowFiles[ret->getUUIDStr()] = ret;
       return ret;
     }
     current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->pickIncomingConnection());
@@ -975,6 +993,86 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   return nullptr;
 }
 
+std::vector<std::shared_ptr<core::FlowFile>> ProcessSession::get(size_t max_count, uint64_t max_bytes) {
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->pickIncomingConnection();
+
+  if (first == nullptr || max_count == 0) {
+    logger_->log_trace("Get is null for %s", process_context_->getProcessorNode()->getName());
+    return flow_files;
+  }
+
+  std::shared_ptr<Connection> current = std::static_pointer_cast<Connection>(first);
+  uint64_t polled_bytes = 0;
+
+  do {
+    std::set<std::shared_ptr<core::FlowFile> > expired;
+    auto polled = current->pollBatch(max_count - flow_files.size(), max_bytes == 0 ? 0 : max_bytes - polled_bytes, expired);
+    expire(expired);
+    for (auto& flow_file : polled) {
+      // add the flow record to the current process session update map and remember the original
+      flow_file->setDeleted(false);
+      _updatedFlowFiles[flow_file->getUUIDStr()] = flow_file;
+      _originalFlowFiles[flow_file->getUUIDStr()] = flow_file;
+      polled_bytes += flow_file->getSize();
+      flow_files.push_back(std::move(flow_file));
+    }
+    if (flow_files.size() >= max_count || (max_bytes != 0 && polled_bytes >= max_bytes)) {
+      break;
+    }
+    current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->pickIncomingConnection());
+  } while (current != nullptr && current != first);
+
+  logger_->log_debug("Got %zu flow files with a total size of %" PRIu64 " bytes for %s", flow_files.size(), polled_bytes, process_context_->getProcessorNode()->getName());
+  return flow_files;
+}
+
+void ProcessSession::snapshot(const std::shared_ptr<core::FlowFile> &flow) {
+  const std::string &uuid = flow->getUUIDStr();
+  if (_originalFlowFiles.find(uuid) == _originalFlowFiles.end() || _flowFileSnapshots.find(uuid) != _flowFileSnapshots.end()) {
+    // created by this session or already captured
+    return;
+  }
+  FlowFileSnapshot &snapshot = _flowFileSnapshots[uuid];
+  snapshot.attributes = flow->getAttributes();
+  snapshot.claim = flow->getResourceClaim();
+  snapshot.size = flow->getSize();
+  snapshot.offset = flow->getOffset();
+  snapshot.penalty_expiration = flow->getPenaltyExpiration();
+  logger_->log_trace("Captured snapshot of FlowFile %s", uuid);
+}
+
+void ProcessSession::revertToSnapshot(const std::shared_ptr<core::FlowFile> &flow, FlowFileSnapshot &snapshot) {
+  *flow->getAttributesPtr() = std::move(snapshot.attributes);
+  flow->setSize(snapshot.size);
+  flow->setOffset(snapshot.offset);
+  flow->setPenaltyExpiration(snapshot.penalty_expiration);
+  std::shared_ptr<ResourceClaim> claim = flow->getResourceClaim();
+  if (claim != snapshot.claim) {
+    // hand the ownership back to the original content
+    if (claim != nullptr) {
+      claim->decreaseFlowFileRecordOwnedCount();
+      // nothing else collects the content written during the session
+      process_context_->getContentRepository()->removeIfOrphaned(claim);
+    }
+    if (snapshot.claim != nullptr) {
+      snapshot.claim->increaseFlowFileRecordOwnedCount();
+      flow->setResourceClaim(snapshot.claim);
+    } else {
+      flow->clearResourceClaim();
+    }
+  }
+}
+
+void ProcessSession::expire(const std::set<std::shared_ptr<core::FlowFile>> &expired) {
+  // Remove expired flow record
+  for (const auto& record : expired) {
+    std::stringstream details;
+    details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
+    provenance_report_->expire(record, details.str());
+  }
+}
+
 bool ProcessSession::outgoingConnectionsFull(const std::string& relationship) {
   std::set<std::shared_ptr<Connectable>> connections = process_context_->getProcessorNode()->getOutGoingConnections(relationship);
   Connection * connection = nullptr;
@@ -290,7 +290,7 @@ bool Processor::isWorkAvailable() {
   try {
     for (const auto &conn : _incomingConnections) {
       std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(conn);
-      if (connection->getQueueSize() > 0) {
+      if (connection->isWorkAvailable()) {
         hasWork = true;
         break;
       }
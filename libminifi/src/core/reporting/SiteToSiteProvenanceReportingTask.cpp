@@ -37,10 +37,10 @@
 #include "provenance/Provenance.h"
 #include "FlowController.h"
 
-#include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
-#include "rapidjson/prettywriter.h"
+#include "utils/gsl.h"
+#include "utils/StringUtils.h"
 
 
 namespace org {
@@ -56,92 +56,119 @@ void SiteToSiteProvenanceReportingTask::initialize() {
   RemoteProcessorGroupPort::initialize();
 }
 
-void setJsonStr(const std::string& key, const std::string& value, rapidjson::Value& parent, rapidjson::Document::AllocatorType& alloc) { // NOLINT
-  rapidjson::Value keyVal;
-  rapidjson::Value valueVal;
-  const char* c_key = key.c_str();
-  const char* c_val = value.c_str();
+namespace {
 
-  keyVal.SetString(c_key, key.length(), alloc);
-  valueVal.SetString(c_val, value.length(), alloc);
+using JsonWriter = rapidjson::Writer<rapidjson::StringBuffer>;
 
-  parent.AddMember(keyVal, valueVal, alloc);
+void writeString(JsonWriter &writer, const std::string &value) {
+  writer.String(value.c_str(), gsl::narrow<rapidjson::SizeType>(value.length()));
 }
 
-rapidjson::Value getStringValue(const std::string& value, rapidjson::Document::AllocatorType& alloc) { // NOLINT
-  rapidjson::Value Val;
-  Val.SetString(value.c_str(), value.length(), alloc);
-  return Val;
+void writeMember(JsonWriter &writer, const char *key, const std::string &value) {
+  writer.Key(key);
+  writeString(writer, value);
 }
 
-void appendJsonStr(const std::string& value, rapidjson::Value& parent, rapidjson::Document::AllocatorType& alloc) { // NOLINT
-  rapidjson::Value valueVal;
-  const char* c_val = value.c_str();
-  valueVal.SetString(c_val, value.length(), alloc);
-  parent.PushBack(valueVal, alloc);
+void writeMember(JsonWriter &writer, const char *key, uint64_t value) {
+  writer.Key(key);
+  writer.Uint64(value);
+}
+
+}  // namespace
+
+bool SiteToSiteProvenanceReportingTask::setReportFormat(const std::string &format) {
+  if (utils::StringUtils::equalsIgnoreCase(format, "json")) {
+    report_format_ = ReportFormat::JSON;
+  } else if (utils::StringUtils::equalsIgnoreCase(format, "binary")) {
+    report_format_ = ReportFormat::BINARY;
+  } else {
+    return false;
+  }
+  return true;
 }
 
 void SiteToSiteProvenanceReportingTask::getJsonReport(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session,
                                                       std::vector<std::shared_ptr<core::SerializableComponent>> &records, std::string &report) {
-  rapidjson::Document array(rapidjson::kArrayType);
-  rapidjson::Document::AllocatorType &alloc = array.GetAllocator();
+  rapidjson::StringBuffer buffer;
+  JsonWriter writer(buffer);
 
-  for (auto sercomp : records) {
+  writer.StartArray();
+  for (const auto &sercomp : records) {
     std::shared_ptr<provenance::ProvenanceEventRecord> record = std::dynamic_pointer_cast<provenance::ProvenanceEventRecord>(sercomp);
     if (nullptr == record) {
       break;
     }
 
-    rapidjson::Value recordJson(rapidjson::kObjectType);
-    rapidjson::Value updatedAttributesJson(rapidjson::kObjectType);
-    rapidjson::Value parentUuidJson(rapidjson::kArrayType);
-    rapidjson::Value childUuidJson(rapidjson::kArrayType);
-
-    recordJson.AddMember("timestampMillis", record->getEventTime(), alloc);
-    recordJson.AddMember("durationMillis", record->getEventDuration(), alloc);
-    recordJson.AddMember("lineageStart", record->getlineageStartDate(), alloc);
-    recordJson.AddMember("entitySize", record->getFileSize(), alloc);
-    recordJson.AddMember("entityOffset", record->getFileOffset(), alloc);
-
-    recordJson.AddMember("entityType", "org.apache.nifi.flowfile.FlowFile", alloc);
-
-    recordJson.AddMember("eventId", getStringValue(record->getEventId(), alloc), alloc);
-    recordJson.AddMember("eventType", getStringValue(provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[record->getEventType()], alloc), alloc);
-    recordJson.AddMember("details", getStringValue(record->getDetails(), alloc), alloc);
-    recordJson.AddMember("componentId", getStringValue(record->getComponentId(), alloc), alloc);
-    recordJson.AddMember("componentType", getStringValue(record->getComponentType(), alloc), alloc);
-    recordJson.AddMember("entityId", getStringValue(record->getFlowFileUuid(), alloc), alloc);
-    recordJson.AddMember("transitUri", getStringValue(record->getTransitUri(), alloc), alloc);
-    recordJson.AddMember("remoteIdentifier", getStringValue(record->getSourceSystemFlowFileIdentifier(), alloc), alloc);
-    recordJson.AddMember("alternateIdentifier", getStringValue(record->getAlternateIdentifierUri(), alloc), alloc);
-
-    for (auto attr : record->getAttributes()) {
-      setJsonStr(attr.first, attr.second, updatedAttributesJson, alloc);
+    writer.StartObject();
+    writeMember(writer, "timestampMillis", record->getEventTime());
+    writeMember(writer, "durationMillis", record->getEventDuration());
+    writeMember(writer, "lineageStart", record->getlineageStartDate());
+    writeMember(writer, "entitySize", record->getFileSize());
+    writeMember(writer, "entityOffset", record->getFileOffset());
+
+    writer.Key("entityType");
+    writer.String("org.apache.nifi.flowfile.FlowFile");
+
+    writeMember(writer, "eventId", record->getEventId());
+    writer.Key("eventType");
+    writer.String(provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[record->getEventType()]);
+    writeMember(writer, "details", record->getDetails());
+    writeMember(writer, "componentId", record->getComponentId());
+    writeMember(writer, "componentType", record->getComponentType());
+    writeMember(writer, "entityId", record->getFlowFileUuid());
+    writeMember(writer, "transitUri", record->getTransitUri());
+    writeMember(writer, "remoteIdentifier", record->getSourceSystemFlowFileIdentifier());
+    writeMember(writer, "alternateIdentifier", record->getAlternateIdentifierUri());
+
+    writer.Key("updatedAttributes");
+    writer.StartObject();
+    for (const auto &attr : record->getAttributes()) {
+      writeMember(writer, attr.first.c_str(), attr.second);
     }
-    recordJson.AddMember("updatedAttributes", updatedAttributesJson, alloc);
+    writer.EndObject();
 
-    for (auto parentUUID : record->getParentUuids()) {
-      appendJsonStr(parentUUID, parentUuidJson, alloc);
+    writer.Key("parentIds");
+    writer.StartArray();
+    for (const auto &parentUUID : record->getParentUuids()) {
+      writeString(writer, parentUUID);
     }
-    recordJson.AddMember("parentIds", parentUuidJson, alloc);
+    writer.EndArray();
 
-    for (auto childUUID : record->getChildrenUuids()) {
-      appendJsonStr(childUUID, childUuidJson, alloc);
+    writer.Key("childIds");
+    writer.StartArray();
+    for (const auto &childUUID : record->getChildrenUuids()) {
+      writeString(writer, childUUID);
     }
-    recordJson.AddMember("childIds", childUuidJson, alloc);
-
-    rapidjson::Value applicationVal;
-    applicationVal.SetString(ProvenanceAppStr, std::strlen(ProvenanceAppStr));
-    recordJson.AddMember("application", applicationVal, alloc);
+    writer.EndArray();
 
-    array.PushBack(recordJson, alloc);
+    writer.Key("application");
+    writer.String(ProvenanceAppStr);
+    writer.EndObject();
   }
+  writer.EndArray();
 
-  rapidjson::StringBuffer buffer;
-  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-  array.Accept(writer);
+  report.assign(buffer.GetString(), buffer.GetSize());
+}
 
-  report = buffer.GetString();
+void SiteToSiteProvenanceReportingTask::getBinaryReport(std::vector<std::shared_ptr<core::SerializableComponent>> &records, std::string &report) {
+  report.clear();
+  for (const auto &sercomp : records) {
+    std::shared_ptr<provenance::ProvenanceEventRecord> record = std::dynamic_pointer_cast<provenance::ProvenanceEventRecord>(sercomp);
+    if (nullptr == record) {
+      break;
+    }
+    io::DataStream stream;
+    if (!record->Serialize(stream)) {
+      logger_->log_error("Could not serialize provenance event %s", record->getEventId());
+      continue;
+    }
+    // every event is preceded by its length as a big endian 32 bit integer
+    const uint32_t length = gsl::narrow<uint32_t>(stream.getSize());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      report.push_back(static_cast<char>((length >> shift) & 0xFF));
+    }
+    report.append(reinterpret_cast<const char*>(stream.getBuffer()), stream.getSize());
+  }
 }
 
 void SiteToSiteProvenanceReportingTask::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
@@ -158,9 +185,16 @@ void SiteToSiteProvenanceReportingTask::onTrigger(const std::shared_ptr<core::Pr
     return;
   }
   logging::LOG_DEBUG(logger_) << "Captured " << deserialized << " records";
-  std::string jsonStr;
-  this->getJsonReport(context, session, records, jsonStr);
-  if (jsonStr.length() <= 0) {
+  std::string report;
+  std::map<std::string, std::string> attributes;
+  if (report_format_ == ReportFormat::BINARY) {
+    getBinaryReport(records, report);
+    attributes["mime.type"] = "application/octet-stream";
+  } else {
+    getJsonReport(context, session, records, report);
+    attributes["mime.type"] = "application/json";
+  }
+  if (report.length() <= 0) {
     return;
   }
 
@@ -172,16 +206,19 @@ void SiteToSiteProvenanceReportingTask::onTrigger(const std::shared_ptr<core::Pr
   }
 
   try {
-    std::map<std::string, std::string> attributes;
-    if (!protocol_->transmitPayload(context, session, jsonStr, attributes)) {
+    if (!protocol_->transmitPayload(context, session, report, attributes)) {
+      // the records are not acknowledged, the next trigger sends them again
       context->yield();
+      returnProtocol(std::move(protocol_));
+      return;
     }
   } catch (...) {
     // if transfer bytes failed, return instead of purge the provenance records
+    penalizeProtocol(std::move(protocol_));
     return;
   }
 
-  // we transfer the record, purge the record from DB
+  // we transfer the record, acknowledge them so that the next trigger continues after them
   repo->Delete(records);
   returnProtocol(std::move(protocol_));
 }
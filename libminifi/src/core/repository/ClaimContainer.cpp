@@ -0,0 +1,404 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/repository/ClaimContainer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Exception.h"
+#include "io/validation.h"
+#include "utils/StringUtils.h"
+#include "utils/file/FileUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace repository {
+
+namespace {
+
+const char *CONTAINER_PREFIX = "container-";
+const char *INDEX_SUFFIX = ".index";
+
+}  // namespace
+
+ClaimContainer::ClaimContainer(uint64_t id, std::string path, uint64_t size)
+    : live_claims_(0),
+      sealed_(false),
+      id_(id),
+      path_(std::move(path)),
+      size_(size) {
+}
+
+ClaimContainer::~ClaimContainer() {
+  close();
+}
+
+bool ClaimContainer::openForAppend() {
+  if (!data_.is_open()) {
+    data_.open(path_, std::ios::out | std::ios::binary | std::ios::app);
+  }
+  return data_.good() && openIndex();
+}
+
+bool ClaimContainer::openIndex() {
+  if (!index_.is_open()) {
+    index_.open(getIndexPath(), std::ios::out | std::ios::app);
+  }
+  return index_.good();
+}
+
+bool ClaimContainer::append(const uint8_t *data, size_t length) {
+  if (!data_.write(reinterpret_cast<const char *>(data), length)) {
+    return false;
+  }
+  size_ += length;
+  return true;
+}
+
+bool ClaimContainer::flush() {
+  return static_cast<bool>(data_.flush());
+}
+
+void ClaimContainer::recordClaim(const std::string &claim, uint64_t offset, uint64_t length) {
+  if (openIndex()) {
+    index_ << "+ " << offset << " " << length << " " << claim << "\n";
+    index_.flush();
+  }
+}
+
+void ClaimContainer::recordRemoval(const std::string &claim, uint64_t offset) {
+  if (openIndex()) {
+    index_ << "- " << offset << " " << claim << "\n";
+    index_.flush();
+  }
+}
+
+void ClaimContainer::close() {
+  if (data_.is_open()) {
+    data_.close();
+  }
+  if (index_.is_open()) {
+    index_.close();
+  }
+}
+
+void ClaimContainer::destroy() {
+  close();
+  std::remove(path_.c_str());
+  std::remove(getIndexPath().c_str());
+}
+
+ClaimContainerManager::ClaimContainerManager(std::string directory, uint64_t max_container_size)
+    : directory_(std::move(directory)),
+      max_container_size_(max_container_size),
+      next_container_id_(0),
+      logger_(logging::LoggerFactory<ClaimContainerManager>::getLogger()) {
+}
+
+bool ClaimContainerManager::initialize() {
+  if (utils::file::FileUtils::create_dir(directory_) != 0) {
+    logger_->log_error("Could not create the claim container directory %s", directory_);
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> indexes;
+  utils::file::FileUtils::list_dir(directory_, [&indexes](const std::string&, const std::string &file_name) {
+    if (utils::StringUtils::startsWith(file_name, CONTAINER_PREFIX) && utils::StringUtils::endsWith(file_name, INDEX_SUFFIX)) {
+      indexes.push_back(file_name);
+    }
+    return true;
+  }, logger_, false);
+
+  for (const auto &index : indexes) {
+    const std::string id_string = index.substr(strlen(CONTAINER_PREFIX), index.size() - strlen(CONTAINER_PREFIX) - strlen(INDEX_SUFFIX));
+    uint64_t id = 0;
+    try {
+      id = std::stoull(id_string);
+    } catch (const std::exception&) {
+      logger_->log_warn("Ignoring unexpected claim container index %s", index);
+      continue;
+    }
+    next_container_id_ = (std::max)(next_container_id_, id + 1);
+    const std::string path = getContainerPath(id);
+    auto container = std::make_shared<ClaimContainer>(id, path, utils::file::FileUtils::file_size(path));
+    container->seal();
+
+    std::map<std::string, std::pair<uint64_t, uint64_t>> claims;
+    std::ifstream index_file(container->getIndexPath());
+    std::string line;
+    while (std::getline(index_file, line)) {
+      std::istringstream entry(line);
+      char type;
+      uint64_t offset;
+      uint64_t length = 0;
+      std::string claim;
+      if (!(entry >> type >> offset) || (type == '+' && !(entry >> length)) || entry.get() != ' ' || !std::getline(entry, claim)) {
+        continue;
+      }
+      auto existing = claims.find(claim);
+      if (type == '-' && existing != claims.end() && existing->second.first == offset) {
+        claims.erase(existing);
+      } else if (type == '+' && offset + length <= container->getSize()) {
+        claims[claim] = std::make_pair(offset, length);
+      }
+    }
+
+    for (const auto &claim : claims) {
+      // a claim relocated right before a crash may be listed by two containers, either copy is complete
+      if (locations_.find(claim.first) != locations_.end()) {
+        continue;
+      }
+      locations_[claim.first] = ClaimLocation{container, claim.second.first, claim.second.second};
+      container->addClaim();
+    }
+    containers_[id] = container;
+  }
+
+  for (auto it = containers_.begin(); it != containers_.end();) {
+    if (it->second->getLiveClaimCount() == 0) {
+      it->second->destroy();
+      it = containers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  logger_->log_debug("Restored %zu claims from %zu claim containers in %s", locations_.size(), containers_.size(), directory_);
+  return true;
+}
+
+void ClaimContainerManager::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &container : available_) {
+    container->close();
+  }
+  available_.clear();
+}
+
+std::shared_ptr<io::BaseStream> ClaimContainerManager::write(const std::string &claim, bool append) {
+  std::shared_ptr<ClaimContainer> container = acquire();
+  if (!container) {
+    return nullptr;
+  }
+  std::shared_ptr<io::BaseStream> previous_content = append ? read(claim) : nullptr;
+  auto stream = std::make_shared<ClaimContainerWriteStream>(shared_from_this(), container, claim);
+  if (previous_content) {
+    // the claim cannot grow in place, its previous content is copied next to the new one
+    uint8_t buffer[8192];
+    int read;
+    while ((read = previous_content->readData(buffer, sizeof(buffer))) > 0) {
+      if (stream->writeData(buffer, read) != read) {
+        break;
+      }
+    }
+  }
+  return stream;
+}
+
+std::shared_ptr<io::BaseStream> ClaimContainerManager::read(const std::string &claim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto location = locations_.find(claim);
+  if (location == locations_.end()) {
+    return nullptr;
+  }
+  return std::make_shared<ClaimContainerReadStream>(location->second.container->getPath(), location->second.offset, location->second.length);
+}
+
+bool ClaimContainerManager::exists(const std::string &claim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return locations_.find(claim) != locations_.end();
+}
+
+bool ClaimContainerManager::remove(const std::string &claim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto location = locations_.find(claim);
+  if (location == locations_.end()) {
+    return false;
+  }
+  location->second.container->recordRemoval(claim, location->second.offset);
+  removeLocation(location);
+  return true;
+}
+
+size_t ClaimContainerManager::getContainerCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return containers_.size();
+}
+
+std::shared_ptr<ClaimContainer> ClaimContainerManager::acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!available_.empty()) {
+    auto container = available_.back();
+    available_.pop_back();
+    if (container->openForAppend()) {
+      return container;
+    }
+    logger_->log_error("Could not reopen claim container %s", container->getPath());
+    container->seal();
+    destroyIfUnused(container);
+  }
+  const uint64_t id = next_container_id_++;
+  auto container = std::make_shared<ClaimContainer>(id, getContainerPath(id));
+  if (!container->openForAppend()) {
+    logger_->log_error("Could not create claim container %s", container->getPath());
+    container->destroy();
+    return nullptr;
+  }
+  containers_[id] = container;
+  return container;
+}
+
+void ClaimContainerManager::release(const std::shared_ptr<ClaimContainer> &container, const std::string &claim, uint64_t offset, uint64_t length, bool success) {
+  success = container->flush() && success;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (success) {
+    // record the new location first, so that a crash in between cannot lose the claim
+    container->recordClaim(claim, offset, length);
+    auto previous = locations_.find(claim);
+    if (previous != locations_.end()) {
+      previous->second.container->recordRemoval(claim, previous->second.offset);
+      removeLocation(previous);
+    }
+    locations_[claim] = ClaimLocation{container, offset, length};
+    container->addClaim();
+  } else {
+    logger_->log_error("Could not append %s to claim container %s", claim, container->getPath());
+  }
+
+  if (!success || container->getSize() >= max_container_size_) {
+    container->seal();
+    container->close();
+    destroyIfUnused(container);
+  } else {
+    available_.push_back(container);
+  }
+}
+
+void ClaimContainerManager::removeLocation(std::map<std::string, ClaimLocation>::iterator location) {
+  auto container = location->second.container;
+  locations_.erase(location);
+  container->removeClaim();
+  destroyIfUnused(container);
+}
+
+void ClaimContainerManager::destroyIfUnused(const std::shared_ptr<ClaimContainer> &container) {
+  if (container->isSealed() && container->getLiveClaimCount() == 0) {
+    logger_->log_debug("Deleting claim container %s", container->getPath());
+    container->destroy();
+    containers_.erase(container->getId());
+  }
+}
+
+std::string ClaimContainerManager::getContainerPath(uint64_t id) const {
+  return utils::file::FileUtils::concat_path(directory_, CONTAINER_PREFIX + std::to_string(id));
+}
+
+ClaimContainerReadStream::ClaimContainerReadStream(const std::string &path, uint64_t offset, uint64_t length)
+    : file_(path, std::ios::in | std::ios::binary),
+      start_(offset),
+      length_(length),
+      offset_(0) {
+}
+
+void ClaimContainerReadStream::closeStream() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+}
+
+void ClaimContainerReadStream::seek(uint64_t offset) {
+  offset_ = (std::min)(offset, length_);
+}
+
+int ClaimContainerReadStream::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    throw minifi::Exception{ExceptionType::GENERAL_EXCEPTION, "negative buflen"};
+  }
+
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    buf.resize(buflen);
+  }
+  int ret = readData(buf.data(), buflen);
+
+  if (ret < buflen) {
+    buf.resize((std::max)(ret, 0));
+  }
+  return ret;
+}
+
+int ClaimContainerReadStream::readData(uint8_t *buf, int buflen) {
+  if (IsNullOrEmpty(buf) || !file_.is_open() || buflen < 0) {
+    return -1;
+  }
+  const uint64_t amount = (std::min)(static_cast<uint64_t>(buflen), length_ - offset_);
+  if (amount == 0) {
+    return 0;
+  }
+  file_.clear();
+  file_.seekg(start_ + offset_);
+  if (!file_.read(reinterpret_cast<char *>(buf), amount)) {
+    return -1;
+  }
+  offset_ += amount;
+  return static_cast<int>(amount);
+}
+
+ClaimContainerWriteStream::ClaimContainerWriteStream(std::shared_ptr<ClaimContainerManager> manager, std::shared_ptr<ClaimContainer> container, std::string claim)
+    : manager_(std::move(manager)),
+      container_(std::move(container)),
+      claim_(std::move(claim)),
+      offset_(container_->getSize()),
+      length_(0),
+      success_(true),
+      closed_(false) {
+}
+
+void ClaimContainerWriteStream::closeStream() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  manager_->release(container_, claim_, offset_, length_, success_);
+}
+
+int ClaimContainerWriteStream::writeData(uint8_t *value, int size) {
+  if (IsNullOrEmpty(value) || closed_ || size < 0) {
+    return -1;
+  }
+  if (!container_->append(value, size)) {
+    success_ = false;
+    return -1;
+  }
+  length_ += size;
+  return size;
+}
+
+}  // namespace repository
+}  // namespace core
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
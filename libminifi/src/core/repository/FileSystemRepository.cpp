@@ -17,9 +17,15 @@
  */
 
 #include "core/repository/FileSystemRepository.h"
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <string>
-#include "io/FileStream.h"
+#include "core/Property.h"
+#include "io/BufferedFileStream.h"
+#include "utils/StringUtils.h"
 #include "utils/file/FileUtils.h"
 
 namespace org {
@@ -37,29 +43,95 @@ bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &
     directory_ = configuration->getHome();
   }
   utils::file::FileUtils::create_dir(directory_);
+
+  bool containers_enabled = false;
+  if (configuration->get(Configure::nifi_content_repository_container_enabled, value)) {
+    utils::StringUtils::StringToBool(value, containers_enabled);
+  }
+  if (containers_enabled) {
+    uint64_t max_container_size = DEFAULT_CLAIM_CONTAINER_MAX_SIZE;
+    if (configuration->get(Configure::nifi_content_repository_container_max_size, value) && !core::Property::StringToInt(value, max_container_size)) {
+      logger_->log_error("Invalid claim container size %s, using %d bytes", value, DEFAULT_CLAIM_CONTAINER_MAX_SIZE);
+      max_container_size = DEFAULT_CLAIM_CONTAINER_MAX_SIZE;
+    }
+    claim_containers_ = std::make_shared<ClaimContainerManager>(utils::file::FileUtils::concat_path(directory_, "containers"), max_container_size);
+    if (!claim_containers_->initialize()) {
+      return false;
+    }
+  }
   return true;
 }
 void FileSystemRepository::stop() {
+  if (claim_containers_) {
+    claim_containers_->stop();
+  }
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::write(const std::shared_ptr<minifi::ResourceClaim> &claim, bool append) {
-  return std::make_shared<io::FileStream>(claim->getContentFullPath(), append);
+  if (claim_containers_) {
+    if (!append || claim_containers_->exists(claim->getContentFullPath())) {
+      return claim_containers_->write(claim->getContentFullPath(), append);
+    }
+    // claims written before containers were enabled are still appended in place
+    std::ifstream file(claim->getContentFullPath());
+    if (!file.good()) {
+      return claim_containers_->write(claim->getContentFullPath(), append);
+    }
+  }
+  return std::make_shared<io::BufferedFileStream>(claim->getContentFullPath(), append);
 }
 
 bool FileSystemRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
+  if (claim_containers_ && claim_containers_->exists(streamId->getContentFullPath())) {
+    return true;
+  }
   std::ifstream file(streamId->getContentFullPath());
   return file.good();
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::read(const std::shared_ptr<minifi::ResourceClaim> &claim) {
-  return std::make_shared<io::FileStream>(claim->getContentFullPath(), 0, false);
+  if (claim_containers_) {
+    auto stream = claim_containers_->read(claim->getContentFullPath());
+    if (stream) {
+      return stream;
+    }
+  }
+  return std::make_shared<io::BufferedFileStream>(claim->getContentFullPath(), 0, false);
 }
 
 bool FileSystemRepository::remove(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  if (claim_containers_ && claim_containers_->remove(claim->getContentFullPath())) {
+    return true;
+  }
   std::remove(claim->getContentFullPath().c_str());
   return true;
 }
 
+bool FileSystemRepository::importFile(const std::shared_ptr<minifi::ResourceClaim> &claim, const std::string &source, uint64_t offset, bool keep_source, uint64_t &size) {
+  const std::string destination = claim->getContentFullPath();
+#ifndef WIN32
+  struct stat source_stat;
+  // symbolic links are copied, moving them would leave the content in the hands of their target
+  if (offset == 0 && !keep_source && lstat(source.c_str(), &source_stat) == 0 && S_ISREG(source_stat.st_mode)) {
+    if (std::rename(source.c_str(), destination.c_str()) == 0) {
+      size = source_stat.st_size;
+      logger_->log_debug("Moved %s to %s", source, destination);
+      return true;
+    }
+    logger_->log_debug("Could not move %s to %s (%s), copying it", source, destination, std::strerror(errno));
+  }
+#endif
+  if (!utils::file::FileUtils::copy_file_contents(source, offset, destination, size)) {
+    logger_->log_debug("Could not copy %s to %s", source, destination);
+    std::remove(destination.c_str());
+    return false;
+  }
+  if (!keep_source) {
+    std::remove(source.c_str());
+  }
+  return true;
+}
+
 } /* namespace repository */
 } /* namespace core */
 } /* namespace minifi */
@@ -23,6 +23,7 @@
 
 #include "core/yaml/YamlConfiguration.h"
 #include "core/state/Value.h"
+#include "core/FlowFilePrioritizer.h"
 #ifdef YAML_CONFIGURATION_USE_REGEX
 #include <regex>
 #endif  // YAML_CONFIGURATION_USE_REGEX
@@ -457,6 +458,14 @@ void YamlConfiguration::parseProvenanceReportingYaml(YAML::Node *reportNode, cor
     reportTask->setBatchSize(lvalue);
   }
 
+  if (node["report format"]) {
+    auto reportFormatStr = node["report format"].as<std::string>();
+    if (!reportTask->setReportFormat(reportFormatStr)) {
+      throw std::invalid_argument("Invalid report format " + reportFormatStr);
+    }
+    logger_->log_debug("ProvenanceReportingTask report format %s", reportFormatStr);
+  }
+
   reportTask->initialize();
 
   // add processor to parent
@@ -690,6 +699,37 @@ void YamlConfiguration::parseConnectionYaml(YAML::Node *connectionsNode, core::P
           }
         }
 
+        if (connectionNode["lock free ingest"]) {
+          std::string strvalue = connectionNode["lock free ingest"].as<std::string>();
+          bool lockFree = false;
+          if (utils::StringUtils::StringToBool(strvalue, lockFree)) {
+            connection->setLockFreeIngest(lockFree);
+          }
+        }
+
+        if (connectionNode["prioritizers"]) {
+          std::vector<std::string> prioritizer_names;
+          auto prioritizersNode = connectionNode["prioritizers"];
+          if (prioritizersNode.IsSequence()) {
+            for (const auto &prioritizerNode : prioritizersNode) {
+              prioritizer_names.push_back(prioritizerNode.as<std::string>());
+            }
+          } else {
+            prioritizer_names.push_back(prioritizersNode.as<std::string>());
+          }
+          std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers;
+          for (const auto &prioritizer_name : prioritizer_names) {
+            auto prioritizer = core::FlowFilePrioritizer::create(prioritizer_name);
+            if (!prioritizer) {
+              logger_->log_error("Unknown prioritizer %s for connection %s", prioritizer_name, name);
+              throw std::invalid_argument("Unknown prioritizer " + prioritizer_name + " for connection " + name);
+            }
+            logger_->log_debug("parseConnection: prioritizer => [%s]", prioritizer->getName());
+            prioritizers.push_back(prioritizer);
+          }
+          connection->setPrioritizers(std::move(prioritizers));
+        }
+
         if (connection) {
           parent->addConnection(connection);
         }
@@ -746,6 +786,11 @@ void YamlConfiguration::parsePortYaml(YAML::Node *portNode, core::ProcessGroup *
   YAML::Node propertiesNode = nodeVal["Properties"];
   parsePropertiesNodeYaml(&propertiesNode, std::static_pointer_cast<core::ConfigurableComponent>(processor), nameStr,
   CONFIG_YAML_REMOTE_PROCESS_GROUP_KEY);
+  if (inputPortsObj["use compression"]) {
+    auto useCompression = inputPortsObj["use compression"].as<std::string>();
+    logger_->log_debug("parsePortYaml: use compression => [%s]", useCompression);
+    processor->setProperty(minifi::RemoteProcessorGroupPort::useCompression.getName(), useCompression);
+  }
 
   // add processor to parent
   parent->addProcessor(processor);
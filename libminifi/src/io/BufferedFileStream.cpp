@@ -0,0 +1,332 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/BufferedFileStream.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Exception.h"
+#include "io/validation.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+namespace {
+
+#ifdef WIN32
+int64_t readAt(int fd, uint8_t *buf, size_t count, uint64_t position) {
+  if (_lseeki64(fd, position, SEEK_SET) < 0) {
+    return -1;
+  }
+  return _read(fd, buf, static_cast<unsigned int>(count));
+}
+
+int64_t writeAt(int fd, const uint8_t *buf, size_t count, uint64_t position) {
+  if (_lseeki64(fd, position, SEEK_SET) < 0) {
+    return -1;
+  }
+  return _write(fd, buf, static_cast<unsigned int>(count));
+}
+#else
+int64_t readAt(int fd, uint8_t *buf, size_t count, uint64_t position) {
+  int64_t result;
+  do {
+    result = ::pread(fd, buf, count, position);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+
+int64_t writeAt(int fd, const uint8_t *buf, size_t count, uint64_t position) {
+  int64_t result;
+  do {
+    result = ::pwrite(fd, buf, count, position);
+  } while (result < 0 && errno == EINTR);
+  return result;
+}
+#endif
+
+bool writeFully(int fd, const uint8_t *buf, size_t count, uint64_t position) {
+  while (count > 0) {
+    const int64_t written = writeAt(fd, buf, count, position);
+    if (written <= 0) {
+      return false;
+    }
+    buf += written;
+    count -= written;
+    position += written;
+  }
+  return true;
+}
+
+}  // namespace
+
+constexpr size_t BufferedFileStream::DEFAULT_BUFFER_SIZE;
+
+BufferedFileStream::BufferedFileStream(const std::string &path, uint64_t offset, bool write_enable, size_t buffer_size)
+    : fd_(-1),
+      path_(path),
+      write_enable_(write_enable),
+      append_(false),
+      offset_(offset),
+      length_(0),
+      buffer_size_(buffer_size > 0 ? buffer_size : DEFAULT_BUFFER_SIZE),
+      buffer_position_(offset),
+      buffer_dirty_(false),
+      logger_(logging::LoggerFactory<BufferedFileStream>::getLogger()) {
+  open(write_enable ? O_RDWR : O_RDONLY);
+}
+
+BufferedFileStream::BufferedFileStream(const std::string &path, bool append, size_t buffer_size)
+    : fd_(-1),
+      path_(path),
+      write_enable_(true),
+      append_(append),
+      offset_(0),
+      length_(0),
+      buffer_size_(buffer_size > 0 ? buffer_size : DEFAULT_BUFFER_SIZE),
+      buffer_position_(0),
+      buffer_dirty_(false),
+      logger_(logging::LoggerFactory<BufferedFileStream>::getLogger()) {
+  open(O_RDWR | O_CREAT | (append ? 0 : O_TRUNC));
+}
+
+void BufferedFileStream::open(int flags) {
+#ifdef WIN32
+  fd_ = _open(path_.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  fd_ = ::open(path_.c_str(), flags | O_CLOEXEC, 0666);
+#endif
+  if (fd_ < 0) {
+    logger_->log_debug("Could not open %s: %s", path_, std::strerror(errno));
+    return;
+  }
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == 0) {
+    length_ = file_stat.st_size;
+  }
+}
+
+void BufferedFileStream::closeStream() {
+  if (fd_ < 0) {
+    return;
+  }
+  if (!flush()) {
+    logger_->log_error("Could not write the buffered data of %s", path_);
+  }
+#ifdef WIN32
+  _close(fd_);
+#else
+  ::close(fd_);
+#endif
+  fd_ = -1;
+}
+
+void BufferedFileStream::seek(uint64_t offset) {
+  offset_ = offset;
+}
+
+bool BufferedFileStream::flush() {
+  if (!buffer_dirty_) {
+    return true;
+  }
+  const bool success = writeFully(fd_, buffer_.data(), buffer_.size(), buffer_position_);
+  buffer_position_ += buffer_.size();
+  buffer_.clear();
+  buffer_dirty_ = false;
+  return success;
+}
+
+bool BufferedFileStream::sync() {
+  if (fd_ < 0 || !flush()) {
+    return false;
+  }
+#ifdef WIN32
+  return _commit(fd_) == 0;
+#else
+  return fsync(fd_) == 0;
+#endif
+}
+
+bool BufferedFileStream::resetBuffer(uint64_t position) {
+  const bool success = flush();
+  buffer_.clear();
+  buffer_position_ = position;
+  return success;
+}
+
+bool BufferedFileStream::fill() {
+  if (!resetBuffer(offset_)) {
+    return false;
+  }
+  buffer_.resize(buffer_size_);
+  const int64_t read = readAt(fd_, buffer_.data(), buffer_size_, buffer_position_);
+  buffer_.resize(read > 0 ? read : 0);
+  return read > 0;
+}
+
+int BufferedFileStream::writeData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    throw minifi::Exception{ExceptionType::GENERAL_EXCEPTION, "negative buflen"};
+  }
+
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    return -1;
+  }
+  return writeData(buf.data(), buflen);
+}
+
+// data stream overrides
+
+int BufferedFileStream::writeData(uint8_t *value, int size) {
+  if (IsNullOrEmpty(value) || fd_ < 0 || !write_enable_ || size < 0) {
+    return -1;
+  }
+  if (append_) {
+    offset_ = length_;
+  }
+  if (!buffer_dirty_ || offset_ != buffer_position_ + buffer_.size()) {
+    // only contiguous writes are collected, anything read ahead is stale from now on
+    if (!resetBuffer(offset_)) {
+      return -1;
+    }
+  }
+  if (buffer_.empty() && static_cast<size_t>(size) >= buffer_size_) {
+    if (!writeFully(fd_, value, size, offset_)) {
+      return -1;
+    }
+    buffer_position_ = offset_ + size;
+  } else {
+    buffer_.insert(buffer_.end(), value, value + size);
+    buffer_dirty_ = true;
+    if (buffer_.size() >= buffer_size_ && !flush()) {
+      return -1;
+    }
+  }
+  offset_ += size;
+  length_ = (std::max)(length_, offset_);
+  return size;
+}
+
+int BufferedFileStream::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    throw minifi::Exception{ExceptionType::GENERAL_EXCEPTION, "negative buflen"};
+  }
+
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    buf.resize(buflen);
+  }
+  int ret = readData(buf.data(), buflen);
+
+  if (ret < buflen) {
+    buf.resize((std::max)(ret, 0));
+  }
+  return ret;
+}
+
+int BufferedFileStream::readData(uint8_t *buf, int buflen) {
+  if (IsNullOrEmpty(buf) || fd_ < 0 || buflen < 0) {
+    return -1;
+  }
+  if (buffer_dirty_ && !resetBuffer(offset_)) {
+    return -1;
+  }
+  size_t total = 0;
+  const size_t requested = buflen;
+  while (total < requested) {
+    if (offset_ >= buffer_position_ && offset_ < buffer_position_ + buffer_.size()) {
+      const size_t buffer_offset = offset_ - buffer_position_;
+      const size_t amount = (std::min)(requested - total, buffer_.size() - buffer_offset);
+      std::memcpy(buf + total, buffer_.data() + buffer_offset, amount);
+      total += amount;
+      offset_ += amount;
+    } else if (requested - total >= buffer_size_) {
+      // large reads bypass the buffer
+      const int64_t read = readAt(fd_, buf + total, requested - total, offset_);
+      if (read <= 0) {
+        break;
+      }
+      total += read;
+      offset_ += read;
+    } else if (!fill()) {
+      break;
+    }
+  }
+  return static_cast<int>(total);
+}
+
+int BufferedFileStream::read(uint16_t &value, bool is_little_endian) {
+  uint8_t buf[2];
+  if (readData(&buf[0], 2) != 2)
+    return -1;
+  if (is_little_endian) {
+    value = (buf[0] << 8) | buf[1];
+  } else {
+    value = buf[0] | buf[1] << 8;
+  }
+  return 2;
+}
+
+int BufferedFileStream::read(uint32_t &value, bool is_little_endian) {
+  uint8_t buf[4];
+  if (readData(&buf[0], 4) != 4)
+    return -1;
+  if (is_little_endian) {
+    value = (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+  } else {
+    value = buf[0] | buf[1] << 8 | buf[2] << 16 | buf[3] << 24;
+  }
+  return 4;
+}
+
+int BufferedFileStream::read(uint64_t &value, bool is_little_endian) {
+  uint8_t buf[8];
+  if (readData(&buf[0], 8) != 8)
+    return -1;
+  value = 0;
+  if (is_little_endian) {
+    for (int i = 0; i < 8; ++i) {
+      value = (value << 8) | buf[i];
+    }
+  } else {
+    for (int i = 7; i >= 0; --i) {
+      value = (value << 8) | buf[i];
+    }
+  }
+  return 8;
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
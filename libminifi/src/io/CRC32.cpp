@@ -0,0 +1,157 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io/CRC32.h"
+
+#include <zlib.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MINIFI_CRC32_PCLMUL
+#include <immintrin.h>
+#endif
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+namespace {
+
+#ifdef MINIFI_CRC32_PCLMUL
+
+// the folding works on blocks of 64 bytes, shorter data is left to zlib
+constexpr size_t PCLMUL_MINIMUM_LENGTH = 64;
+
+/**
+ * Folds the data, whose length is at least 64 and a multiple of 16, into the non inverted crc,
+ * following "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Gopal et al.
+ * The constants are those of the bit reflected CRC-32 polynomial 0x04C11DB7 given in the paper.
+ */
+__attribute__((target("pclmul,sse4.1")))
+uint32_t foldCRC32(uint32_t crc, const uint8_t *buffer, size_t length) {
+  alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+  alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+  alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+  alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+  __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x00));
+  __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x10));
+  __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x20));
+  __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+  __m128i x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+  buffer += 64;
+  length -= 64;
+
+  // fold four blocks of 16 bytes in parallel
+  while (length >= 64) {
+    const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    const __m128i x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    const __m128i x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    const __m128i x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + 0x30)));
+    buffer += 64;
+    length -= 64;
+  }
+
+  // fold the four blocks into one
+  x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+  const __m128i blocks[] = { x2, x3, x4 };
+  for (const __m128i &next : blocks) {
+    const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+  }
+
+  // fold the remaining blocks of 16 bytes
+  while (length >= 16) {
+    const __m128i x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer))), x5);
+    buffer += 16;
+    length -= 16;
+  }
+
+  // reduce 128 bits to 64 bits
+  __m128i x2r = _mm_clmulepi64_si128(x1, x0, 0x10);
+  const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+  x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+  x2r = _mm_srli_si128(x1, 4);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2r);
+
+  // Barrett reduction to 32 bits
+  x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+  x2r = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), x0, 0x10);
+  x2r = _mm_clmulepi64_si128(_mm_and_si128(x2r, mask), x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2r);
+  return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+bool detectPCLMUL() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+const bool PCLMUL_SUPPORTED = detectPCLMUL();
+
+#endif
+
+}  // namespace
+
+bool isHardwareCRC32Supported() {
+#ifdef MINIFI_CRC32_PCLMUL
+  return PCLMUL_SUPPORTED;
+#else
+  return false;
+#endif
+}
+
+uint32_t updateCRC32(uint32_t crc, const uint8_t *buffer, size_t length) {
+#ifdef MINIFI_CRC32_PCLMUL
+  if (PCLMUL_SUPPORTED && length >= PCLMUL_MINIMUM_LENGTH) {
+    const size_t folded = length & ~static_cast<size_t>(15);
+    crc = ~foldCRC32(~crc, buffer, folded);
+    buffer += folded;
+    length -= folded;
+  }
+#endif
+  while (length > 0) {
+    // zlib takes the length as a 32 bit integer
+    const uInt chunk = static_cast<uInt>(length > 0x40000000 ? 0x40000000 : length);
+    crc = static_cast<uint32_t>(crc32(crc, buffer, chunk));
+    buffer += chunk;
+    length -= chunk;
+  }
+  return crc;
+}
+
+}  // namespace io
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -17,9 +17,11 @@
  */
 
 #include "provenance/Provenance.h"
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <list>
 #include "core/Repository.h"
@@ -28,6 +30,7 @@
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "FlowController.h"
+#include "utils/StringUtils.h"
 
 namespace org {
 namespace apache {
@@ -380,7 +383,118 @@ bool ProvenanceEventRecord::DeSerialize(const uint8_t *buffer, const size_t buff
   return true;
 }
 
+constexpr uint64_t ProvenancePolicy::DEFAULT_AGGREGATION_INTERVAL_MILLIS;
+
+ProvenancePolicy::ProvenancePolicy(const std::shared_ptr<Configure> &configure, std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType)
+    : mode_(Mode::FULL),
+      sampling_interval_(1),
+      sample_counter_(0),
+      repo_(std::move(repo)),
+      componentId_(std::move(componentId)),
+      componentType_(std::move(componentType)),
+      aggregation_interval_(DEFAULT_AGGREGATION_INTERVAL_MILLIS),
+      aggregation_start_(getTimeMillis()),
+      logger_(logging::LoggerFactory<ProvenancePolicy>::getLogger()) {
+  std::string value;
+  if (getProperty(configure, Configure::nifi_provenance_mode, componentType_, value)) {
+    if (utils::StringUtils::equalsIgnoreCase(value, "lightweight")) {
+      mode_ = Mode::LIGHTWEIGHT;
+    } else if (utils::StringUtils::equalsIgnoreCase(value, "aggregate")) {
+      mode_ = Mode::AGGREGATE;
+    } else if (!utils::StringUtils::equalsIgnoreCase(value, "full")) {
+      logger_->log_error("Invalid provenance mode %s for %s, recording every event", value, componentType_);
+    }
+  }
+  if (getProperty(configure, Configure::nifi_provenance_sampling_rate, componentType_, value)) {
+    try {
+      const double rate = std::stod(value);
+      if (rate <= 0) {
+        sampling_interval_ = 0;
+      } else if (rate < 1) {
+        sampling_interval_ = static_cast<uint64_t>(std::llround(1 / rate));
+      }
+    } catch (const std::exception&) {
+      logger_->log_error("Invalid provenance sampling rate %s for %s, recording every event", value, componentType_);
+    }
+  }
+  if (getProperty(configure, Configure::nifi_provenance_aggregation_interval, componentType_, value)) {
+    int64_t interval;
+    core::TimeUnit unit;
+    if (core::Property::StringToTime(value, interval, unit) && core::Property::ConvertTimeUnitToMS(interval, unit, interval) && interval > 0) {
+      aggregation_interval_ = interval;
+    } else {
+      logger_->log_error("Invalid provenance aggregation interval %s for %s", value, componentType_);
+    }
+  }
+}
+
+ProvenancePolicy::~ProvenancePolicy() {
+  // the repository cannot be written once it has been stopped
+  if (repo_ && repo_->isRunning()) {
+    flush();
+  }
+}
+
+bool ProvenancePolicy::getProperty(const std::shared_ptr<Configure> &configure, const std::string &property, const std::string &componentType, std::string &value) {
+  if (!configure) {
+    return false;
+  }
+  return configure->get(property + "." + componentType, value) || configure->get(property, value);
+}
+
+void ProvenancePolicy::aggregate(const std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceEventCount> &counts) {
+  {
+    std::lock_guard<std::mutex> lock(aggregation_mutex_);
+    for (const auto &count : counts) {
+      auto &total = counts_[count.first];
+      total.events += count.second.events;
+      total.bytes += count.second.bytes;
+    }
+    if (getTimeMillis() - aggregation_start_ < aggregation_interval_) {
+      return;
+    }
+  }
+  flush();
+}
+
+void ProvenancePolicy::flush() {
+  std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceEventCount> counts;
+  uint64_t interval;
+  {
+    std::lock_guard<std::mutex> lock(aggregation_mutex_);
+    const uint64_t now = getTimeMillis();
+    interval = now - aggregation_start_;
+    aggregation_start_ = now;
+    counts.swap(counts_);
+  }
+  if (counts.empty() || repo_->isNoop() || repo_->isFull()) {
+    return;
+  }
+
+  std::vector<std::pair<std::string, std::unique_ptr<io::DataStream>>> flowData;
+  for (const auto &count : counts) {
+    ProvenanceEventRecord event(count.first, componentId_, componentType_);
+    event.setFileSize(count.second.bytes);
+    event.setEventDuration(interval);
+    event.setAttribute("provenance.aggregate.events", std::to_string(count.second.events));
+    event.setAttribute("provenance.aggregate.bytes", std::to_string(count.second.bytes));
+    event.setDetails("Aggregate of " + std::to_string(count.second.events) + " events in " + std::to_string(interval) + " ms");
+
+    std::unique_ptr<io::DataStream> stream(new io::DataStream());
+    event.Serialize(*stream);
+    flowData.emplace_back(event.getUUIDStr(), std::move(stream));
+  }
+  if (!repo_->MultiPut(flowData)) {
+    logger_->log_error("Could not store the aggregated provenance events of %s", componentType_);
+  }
+}
+
 void ProvenanceReporter::commit() {
+  if (policy_ && !pending_counts_.empty()) {
+    policy_->aggregate(pending_counts_);
+    pending_counts_.clear();
+  }
+
   if (repo_->isNoop()) {
     return;
   }
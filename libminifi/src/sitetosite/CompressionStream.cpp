@@ -0,0 +1,217 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sitetosite/CompressionStream.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Exception.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+namespace {
+
+const uint8_t SYNC_BYTES[] = { 'S', 'Y', 'N', 'C' };
+
+// NiFi does not send chunks larger than its buffer, this only guards the allocations
+constexpr uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+void appendInt(std::vector<uint8_t> &buffer, uint32_t value) {
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    buffer.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+bool readFully(io::DataStream *input, uint8_t *buf, size_t length) {
+  size_t total = 0;
+  while (total < length) {
+    const int ret = input->readData(buf + total, static_cast<int>(length - total));
+    if (ret <= 0) {
+      return false;
+    }
+    total += ret;
+  }
+  return true;
+}
+
+bool readInt(io::DataStream *input, uint32_t &value) {
+  uint8_t bytes[4];
+  if (!readFully(input, bytes, sizeof(bytes))) {
+    return false;
+  }
+  value = (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) | (uint32_t{bytes[2]} << 8) | bytes[3];
+  return true;
+}
+
+}  // namespace
+
+constexpr size_t CompressionOutputStream::DEFAULT_BUFFER_SIZE;
+constexpr int CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL;
+
+CompressionOutputStream::CompressionOutputStream(io::DataStream *output, int level, size_t buffer_size)
+    : output_(output),
+      level_(level),
+      buffer_size_(buffer_size > 0 ? buffer_size : DEFAULT_BUFFER_SIZE),
+      data_written_(false) {
+  buffer_.reserve(buffer_size_);
+}
+
+int CompressionOutputStream::writeData(uint8_t *value, int size) {
+  if (value == nullptr || size < 0) {
+    return -1;
+  }
+  int written = 0;
+  while (written < size) {
+    const size_t amount = (std::min)(static_cast<size_t>(size - written), buffer_size_ - buffer_.size());
+    buffer_.insert(buffer_.end(), value + written, value + written + amount);
+    written += amount;
+    if (buffer_.size() >= buffer_size_ && !compressAndWrite()) {
+      return -1;
+    }
+  }
+  return size;
+}
+
+bool CompressionOutputStream::compressAndWrite() {
+  if (buffer_.empty()) {
+    return true;
+  }
+  uLongf compressed_size = compressBound(buffer_.size());
+  // the chunk header and the marker of the previous chunk are written together with the data
+  const size_t header_size = 13;
+  compressed_.resize(header_size + compressed_size);
+  if (compress2(compressed_.data() + header_size, &compressed_size, buffer_.data(), buffer_.size(), level_) != Z_OK) {
+    return false;
+  }
+  std::vector<uint8_t> header;
+  if (data_written_) {
+    header.push_back(1);
+  }
+  header.insert(header.end(), std::begin(SYNC_BYTES), std::end(SYNC_BYTES));
+  appendInt(header, static_cast<uint32_t>(buffer_.size()));
+  appendInt(header, static_cast<uint32_t>(compressed_size));
+  const size_t start = header_size - header.size();
+  std::copy(header.begin(), header.end(), compressed_.begin() + start);
+  const int length = static_cast<int>(header.size() + compressed_size);
+  buffer_.clear();
+  data_written_ = true;
+  return output_->writeData(compressed_.data() + start, length) == length;
+}
+
+bool CompressionOutputStream::finish() {
+  if (!compressAndWrite()) {
+    return false;
+  }
+  if (!data_written_) {
+    return true;
+  }
+  data_written_ = false;
+  uint8_t end = 0;
+  return output_->writeData(&end, 1) == 1;
+}
+
+CompressionInputStream::CompressionInputStream(io::DataStream *input)
+    : input_(input),
+      index_(0),
+      all_data_read_(false),
+      logger_(logging::LoggerFactory<CompressionInputStream>::getLogger()) {
+}
+
+bool CompressionInputStream::readChunk() {
+  uint8_t sync[sizeof(SYNC_BYTES)];
+  if (!readFully(input_, sync, sizeof(sync)) || std::memcmp(sync, SYNC_BYTES, sizeof(sync)) != 0) {
+    logger_->log_error("Compressed site-to-site data does not start with SYNC");
+    return false;
+  }
+  uint32_t original_size;
+  uint32_t compressed_size;
+  if (!readInt(input_, original_size) || !readInt(input_, compressed_size) || original_size > MAX_CHUNK_SIZE || compressed_size > MAX_CHUNK_SIZE) {
+    logger_->log_error("Invalid compressed site-to-site chunk header");
+    return false;
+  }
+  compressed_.resize(compressed_size);
+  if (!readFully(input_, compressed_.data(), compressed_size)) {
+    return false;
+  }
+  buffer_.resize(original_size);
+  uLongf size = original_size;
+  if (uncompress(buffer_.data(), &size, compressed_.data(), compressed_size) != Z_OK || size != original_size) {
+    logger_->log_error("Could not inflate compressed site-to-site chunk");
+    return false;
+  }
+  index_ = 0;
+  uint8_t more_data;
+  if (!readFully(input_, &more_data, 1) || more_data > 1) {
+    logger_->log_error("Invalid marker after compressed site-to-site chunk");
+    return false;
+  }
+  all_data_read_ = more_data == 0;
+  return true;
+}
+
+int CompressionInputStream::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    throw minifi::Exception{ExceptionType::GENERAL_EXCEPTION, "negative buflen"};
+  }
+
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    buf.resize(buflen);
+  }
+  const int ret = readData(buf.data(), buflen);
+  if (ret < buflen) {
+    buf.resize((std::max)(ret, 0));
+  }
+  return ret;
+}
+
+int CompressionInputStream::readData(uint8_t *buf, int buflen) {
+  if (buf == nullptr || buflen < 0) {
+    return -1;
+  }
+  int total = 0;
+  while (total < buflen) {
+    if (index_ >= buffer_.size()) {
+      if (all_data_read_) {
+        break;
+      }
+      if (!readChunk()) {
+        return -1;
+      }
+      continue;
+    }
+    const size_t amount = (std::min)(static_cast<size_t>(buflen - total), buffer_.size() - index_);
+    std::memcpy(buf + total, buffer_.data() + index_, amount);
+    index_ += amount;
+    total += amount;
+  }
+  return total;
+}
+
+}  // namespace sitetosite
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -64,8 +64,52 @@ bool SiteToSitePeer::Open() {
 }
 
 void SiteToSitePeer::Close() {
-  if (stream_ != nullptr)
+  compressor_ = nullptr;
+  decompressor_ = nullptr;
+  if (stream_ != nullptr) {
+    flush();
     stream_->closeStream();
+  }
+}
+
+void SiteToSitePeer::startCompression() {
+  compressor_ = std::unique_ptr<CompressionOutputStream>(new CompressionOutputStream(rawOutput()));
+}
+
+bool SiteToSitePeer::finishCompression() {
+  if (compressor_ == nullptr)
+    return true;
+  const bool success = compressor_->finish();
+  compressor_ = nullptr;
+  return buffered(success ? 1 : -1) > 0;
+}
+
+void SiteToSitePeer::startDecompression() {
+  decompressor_ = std::unique_ptr<CompressionInputStream>(new CompressionInputStream(stream_.get()));
+}
+
+bool SiteToSitePeer::flush() {
+  const auto size = write_buffer_.getSize();
+  if (size == 0)
+    return true;
+  if (stream_ == nullptr) {
+    write_buffer_.initialize();
+    return false;
+  }
+  const int ret = stream_->writeData(const_cast<uint8_t *>(write_buffer_.getBuffer()), size);
+  write_buffer_.initialize();
+  return ret == static_cast<int>(size);
+}
+
+int SiteToSitePeer::write(uint8_t *value, int len) {
+  if (compressor_ == nullptr && write_buffer_size_ > 0 && write_buffer_.getSize() + len > write_buffer_size_) {
+    // make room, content chunks as large as the buffer are not copied
+    if (!flush())
+      return -1;
+    if (static_cast<size_t>(len) >= write_buffer_size_)
+      return Serializable::write(value, len, stream_.get());
+  }
+  return buffered(Serializable::write(value, len, output()));
 }
 
 } /* namespace sitetosite */
@@ -0,0 +1,175 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sitetosite/PeerSelector.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+namespace {
+
+// peers are never starved completely, their reported counts are only a snapshot
+constexpr double MIN_WEIGHT = 0.1;
+
+}  // namespace
+
+constexpr uint64_t PeerSelector::DEFAULT_PENALIZATION_MILLIS;
+
+PeerSelector::PeerSelector(TransferDirection direction, size_t max_idle_clients, uint64_t penalization_millis)
+    : direction_(direction),
+      max_idle_clients_(max_idle_clients),
+      penalization_millis_(penalization_millis),
+      next_index_(0) {
+}
+
+void PeerSelector::setDirection(TransferDirection direction) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  direction_ = direction;
+}
+
+void PeerSelector::setMaxIdleClients(size_t max_idle_clients) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_idle_clients_ = max_idle_clients;
+}
+
+void PeerSelector::setPeers(const std::vector<PeerStatus> &peers) {
+  uint64_t total_flow_files = 0;
+  for (const auto &status : peers) {
+    total_flow_files += status.getFlowFileCount();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PeerState> states;
+  for (const auto &status : peers) {
+    const std::string address = getAddress(*status.getPeer());
+    PeerState state;
+    auto existing = find(address);
+    if (existing != nullptr) {
+      state = std::move(*existing);
+    } else {
+      state.active_transactions = 0;
+      state.penalized_until = 0;
+    }
+    state.peer = status.getPeer();
+    state.address = address;
+    if (total_flow_files == 0) {
+      state.weight = 1.0;
+    } else {
+      const double share = static_cast<double>(status.getFlowFileCount()) / total_flow_files;
+      state.weight = (std::max)(MIN_WEIGHT, direction_ == SEND ? 1.0 - share : share);
+    }
+    states.push_back(std::move(state));
+  }
+  peers_ = std::move(states);
+  next_index_ = 0;
+}
+
+size_t PeerSelector::getPeerCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peers_.size();
+}
+
+std::shared_ptr<Peer> PeerSelector::acquire(std::unique_ptr<SiteToSiteClient> &client) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t now = getTimeMillis();
+  PeerState *selected = nullptr;
+  double selected_load = 0;
+  for (size_t i = 0; i < peers_.size(); ++i) {
+    auto &state = peers_[(next_index_ + i) % peers_.size()];
+    if (state.penalized_until > now) {
+      continue;
+    }
+    const double load = (state.active_transactions + 1) / state.weight;
+    if (selected == nullptr || load < selected_load) {
+      selected = &state;
+      selected_load = load;
+    }
+  }
+  if (selected == nullptr) {
+    return nullptr;
+  }
+  next_index_ = (next_index_ + 1) % peers_.size();
+  selected->active_transactions++;
+  if (!selected->idle_clients.empty()) {
+    client = std::move(selected->idle_clients.back());
+    selected->idle_clients.pop_back();
+  }
+  return selected->peer;
+}
+
+void PeerSelector::release(const std::string &address, std::unique_ptr<SiteToSiteClient> client) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto state = find(address);
+  if (state == nullptr) {
+    // the peer left the cluster in the meantime
+    return;
+  }
+  if (state->active_transactions > 0) {
+    state->active_transactions--;
+  }
+  if (client != nullptr && state->idle_clients.size() < max_idle_clients_) {
+    state->idle_clients.push_back(std::move(client));
+  }
+}
+
+void PeerSelector::penalize(const std::string &address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto state = find(address);
+  if (state == nullptr) {
+    return;
+  }
+  if (state->active_transactions > 0) {
+    state->active_transactions--;
+  }
+  state->penalized_until = getTimeMillis() + penalization_millis_;
+  // the connections of a failing peer are not worth keeping
+  state->idle_clients.clear();
+}
+
+void PeerSelector::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &state : peers_) {
+    state.idle_clients.clear();
+  }
+}
+
+PeerSelector::PeerState *PeerSelector::find(const std::string &address) {
+  for (auto &state : peers_) {
+    if (state.address == address) {
+      return &state;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace sitetosite
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
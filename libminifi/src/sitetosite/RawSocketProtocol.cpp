@@ -41,6 +41,8 @@ namespace sitetosite {
 std::shared_ptr<utils::IdGenerator> RawSiteToSiteClient::id_generator_ = utils::IdGenerator::getIdGenerator();
 std::shared_ptr<utils::IdGenerator> Transaction::id_generator_ = utils::IdGenerator::getIdGenerator();
 
+constexpr size_t RawSiteToSiteClient::WRITE_BUFFER_SIZE;
+
 const char *RawSiteToSiteClient::HandShakePropertyStr[MAX_HANDSHAKE_PROPERTY] = {
 /**
  * Boolean value indicating whether or not the contents of a FlowFile should
@@ -246,7 +248,7 @@ bool RawSiteToSiteClient::handShake() {
   }
 
   std::map<std::string, std::string> properties;
-  properties[HandShakePropertyStr[GZIP]] = "false";
+  properties[HandShakePropertyStr[GZIP]] = use_compression_ ? "true" : "false";
   properties[HandShakePropertyStr[PORT_IDENTIFIER]] = port_id_str_;
   properties[HandShakePropertyStr[REQUEST_EXPIRATION_MILLIS]] = std::to_string(_timeOut);
   if (_currentVersion >= 5) {
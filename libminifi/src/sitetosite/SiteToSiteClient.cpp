@@ -16,15 +16,55 @@
  * limitations under the License.
  */
 #include "sitetosite/SiteToSiteClient.h"
+#include <future>
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
+#include "utils/gsl.h"
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
 namespace sitetosite {
 
+namespace {
+
+// the content of at most one flow file of up to this size is held in memory ahead of sending it
+constexpr uint64_t PREFETCH_MAX_SIZE = 4 * 1024 * 1024;
+// smaller content is read when it is needed, as starting a thread costs more than reading it
+constexpr uint64_t PREFETCH_ASYNC_MIN_SIZE = 64 * 1024;
+
+/**
+ * Reads the content of the flow file from the content repository, in the background for larger content, so
+ * it is read while the previous flow file is sent. An empty result makes send read the content itself.
+ */
+std::future<std::string> prefetchContent(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<FlowFileRecord> &flow) {
+  const auto claim = flow->getResourceClaim();
+  const uint64_t size = flow->getSize();
+  if (claim == nullptr || size == 0 || size > PREFETCH_MAX_SIZE) {
+    return std::future<std::string>();
+  }
+  const auto content_repo = context->getContentRepository();
+  const uint64_t offset = flow->getOffset();
+  auto read = [content_repo, claim, offset, size]() -> std::string {
+    std::string content;
+    const auto stream = content_repo->read(claim);
+    if (stream == nullptr) {
+      return content;
+    }
+    stream->seek(offset);
+    content.resize(size);
+    if (stream->readData(reinterpret_cast<uint8_t *>(&content[0]), static_cast<int>(size)) != static_cast<int>(size)) {
+      content.clear();
+    }
+    return content;
+  };
+  return std::async(size >= PREFETCH_ASYNC_MIN_SIZE ? std::launch::async : std::launch::deferred, read);
+}
+
+}  // namespace
+
 int SiteToSiteClient::readResponse(const std::shared_ptr<Transaction> &transaction, RespondCode &code, std::string &message) {
   uint8_t firstByte;
 
@@ -137,13 +177,23 @@ bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessCont
     throw Exception(SITE2SITE_EXCEPTION, "Can not create transaction");
   }
 
-  bool continueTransaction = true;
   uint64_t startSendingNanos = getTimeNano();
+  std::future<std::string> content = prefetchContent(context, flow);
 
   try {
-    while (continueTransaction) {
+    while (flow) {
       uint64_t startTime = getTimeMillis();
-      std::string payload;
+      // the content of the next flow file is read while this one is sent
+      std::shared_ptr<FlowFileRecord> next;
+      std::future<std::string> next_content;
+      if (getTimeNano() - startSendingNanos <= _batchSendNanos) {
+        next = std::static_pointer_cast<FlowFileRecord>(session->get());
+        if (next) {
+          next_content = prefetchContent(context, next);
+        }
+      }
+
+      const std::string payload = content.valid() ? content.get() : "";
       DataPacket packet(getLogger(), transaction, flow->getAttributes(), payload);
 
       int16_t resp = send(transactionID, &packet, flow, session);
@@ -160,16 +210,9 @@ bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessCont
       }
       session->remove(flow);
 
-      uint64_t transferNanos = getTimeNano() - startSendingNanos;
-      if (transferNanos > _batchSendNanos)
-        break;
-
-      flow = std::static_pointer_cast<FlowFileRecord>(session->get());
-
-      if (!flow) {
-        continueTransaction = false;
-      }
-    }  // while true
+      flow = next;
+      content = std::move(next_content);
+    }
 
     if (!confirm(transactionID)) {
       throw Exception(SITE2SITE_EXCEPTION, "Confirm Failed for " + transactionID);
@@ -441,6 +484,13 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
     }
   }
   // start to read the packet
+  if (use_compression_) {
+    peer_->startCompression();
+  }
+  // the error paths must not leave the compressor installed for the later writes to the peer
+  auto discardCompression = gsl::finally([this] {
+    peer_->discardCompression();
+  });
   uint32_t numAttributes = packet->_attributes.size();
   ret = transaction->getStream().write(numAttributes);
   if (ret != 4) {
@@ -477,7 +527,15 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
       logger_->log_debug("Failed to write content size!");
       return -1;
     }
-    if (flowFile->getSize() > 0) {
+    if (len > 0 && packet->payload_.length() == len) {
+      // the content was prefetched
+      ret = transaction->getStream().writeData(reinterpret_cast<uint8_t *>(const_cast<char*>(packet->payload_.data())), len);
+      if (ret != static_cast<int64_t>(len)) {
+        logger_->log_debug("Failed to write content!");
+        return -1;
+      }
+      packet->_size = len;
+    } else if (flowFile->getSize() > 0) {
       sitetosite::ReadCallback callback(packet);
       session->read(flowFile, &callback);
       if (flowFile->getSize() != packet->_size) {
@@ -513,6 +571,11 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
     }
   }
 
+  if (use_compression_ && !peer_->finishCompression()) {
+    logger_->log_debug("Failed to write the compressed data!");
+    return -1;
+  }
+
   transaction->current_transfers_++;
   transaction->total_transfers_++;
   transaction->_state = DATA_EXCHANGED;
@@ -590,6 +653,9 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
   }
 
   // start to read the packet
+  if (use_compression_) {
+    peer_->startDecompression();
+  }
   uint32_t numAttributes;
   ret = transaction->getStream().read(numAttributes);
   if (ret <= 0 || numAttributes > MAX_NUM_ATTRIBUTES) {
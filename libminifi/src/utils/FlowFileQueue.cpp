@@ -0,0 +1,153 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/FlowFileQueue.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+void FlowFileQueue::setPrioritizers(std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers) {
+  std::vector<value_type> ready;
+  ready.reserve(ready_.size() + prioritized_.size());
+  while (value_type flow_file = popReady()) {
+    ready.push_back(std::move(flow_file));
+  }
+  prioritizers_ = std::move(prioritizers);
+  parse_priorities_ = std::any_of(prioritizers_.begin(), prioritizers_.end(), [](const std::shared_ptr<core::FlowFilePrioritizer>& prioritizer) {
+    return prioritizer->usesPriority();
+  });
+  for (auto& flow_file : ready) {
+    pushReady(std::move(flow_file));
+  }
+}
+
+FlowFileQueue::value_type FlowFileQueue::pop() {
+  releaseExpiredPenalties();
+  return popReady();
+}
+
+void FlowFileQueue::push(const value_type& element) {
+  push(value_type{element});
+}
+
+void FlowFileQueue::push(value_type&& element) {
+  if (element->isPenalized()) {
+    penalized_.push(std::move(element));
+  } else {
+    pushReady(std::move(element));
+  }
+}
+
+std::vector<FlowFileQueue::value_type> FlowFileQueue::clear() {
+  std::vector<value_type> drained;
+  drained.reserve(size());
+  for (auto& flow_file : ready_) {
+    drained.push_back(std::move(flow_file));
+  }
+  ready_.clear();
+  for (auto& entry : prioritized_) {
+    drained.push_back(std::move(entry.flow_file));
+  }
+  prioritized_.clear();
+  while (!penalized_.empty()) {
+    drained.push_back(penalized_.top());
+    penalized_.pop();
+  }
+  return drained;
+}
+
+bool FlowFileQueue::isWorkAvailable() const {
+  if (!ready_.empty() || !prioritized_.empty()) {
+    return true;
+  }
+  return !penalized_.empty() && penalized_.top()->getPenaltyExpiration() <= getTimeMillis();
+}
+
+bool FlowFileQueue::empty() const {
+  return ready_.empty() && prioritized_.empty() && penalized_.empty();
+}
+
+size_t FlowFileQueue::size() const {
+  return ready_.size() + prioritized_.size() + penalized_.size();
+}
+
+void FlowFileQueue::releaseExpiredPenalties() {
+  if (penalized_.empty()) {
+    return;
+  }
+  const uint64_t now = getTimeMillis();
+  while (!penalized_.empty() && penalized_.top()->getPenaltyExpiration() <= now) {
+    pushReady(value_type{penalized_.top()});
+    penalized_.pop();
+  }
+}
+
+bool FlowFileQueue::isHandedOutAfter(const PrioritizedFlowFile& lhs, const PrioritizedFlowFile& rhs) const {
+  for (const auto& prioritizer : prioritizers_) {
+    const int result = prioritizer->compare(*lhs.flow_file, lhs.priority, *rhs.flow_file, rhs.priority);
+    if (result != 0) {
+      return result > 0;
+    }
+  }
+  return lhs.sequence > rhs.sequence;
+}
+
+void FlowFileQueue::pushReady(value_type&& element) {
+  if (prioritizers_.empty()) {
+    ready_.push_back(std::move(element));
+    return;
+  }
+  core::FlowFilePriority priority = parse_priorities_ ? core::FlowFilePriority::parse(*element) : core::FlowFilePriority{};
+  prioritized_.push_back(PrioritizedFlowFile{std::move(element), sequence_++, std::move(priority)});
+  std::push_heap(prioritized_.begin(), prioritized_.end(), [this](const PrioritizedFlowFile& lhs, const PrioritizedFlowFile& rhs) {
+    return isHandedOutAfter(lhs, rhs);
+  });
+}
+
+FlowFileQueue::value_type FlowFileQueue::popReady() {
+  if (!ready_.empty()) {
+    value_type next = std::move(ready_.front());
+    ready_.pop_front();
+    return next;
+  }
+  if (!prioritized_.empty()) {
+    std::pop_heap(prioritized_.begin(), prioritized_.end(), [this](const PrioritizedFlowFile& lhs, const PrioritizedFlowFile& rhs) {
+      return isHandedOutAfter(lhs, rhs);
+    });
+    value_type next = std::move(prioritized_.back().flow_file);
+    prioritized_.pop_back();
+    return next;
+  }
+  return nullptr;
+}
+
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -0,0 +1,230 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utils/file/DirectoryWatcher.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/logging/LoggerConfiguration.h"
+#include "utils/file/FileUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+namespace file {
+
+DirectoryWatcher::DirectoryWatcher(bool recursive, bool watch_modifications)
+    : recursive_(recursive),
+      watch_modifications_(watch_modifications),
+      fd_(-1),
+      logger_(core::logging::LoggerFactory<DirectoryWatcher>::getLogger()) {
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  close();
+}
+
+#ifdef __linux__
+
+bool DirectoryWatcher::isSupported() {
+  return true;
+}
+
+bool DirectoryWatcher::watch(const std::string &directory) {
+  if (fd_ < 0) {
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+      logger_->log_warn("Could not initialize inotify: %s", std::strerror(errno));
+      return false;
+    }
+  }
+  return addWatch(directory, nullptr);
+}
+
+bool DirectoryWatcher::addWatch(const std::string &directory, std::vector<Event> *found_files) {
+  uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF;
+  if (watch_modifications_) {
+    mask |= IN_MODIFY;
+  }
+  if (recursive_) {
+    mask |= IN_CREATE;
+  }
+  const int wd = inotify_add_watch(fd_, directory.c_str(), mask | IN_ONLYDIR);
+  if (wd < 0) {
+    logger_->log_warn("Could not watch %s: %s", directory, std::strerror(errno));
+    return false;
+  }
+  directories_[wd] = directory;
+  logger_->log_debug("Watching %s", directory);
+
+  if (!recursive_ && found_files == nullptr) {
+    return true;
+  }
+  DIR *dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    return true;
+  }
+  bool success = true;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    const std::string path = directory + FileUtils::get_separator() + entry->d_name;
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf) != 0) {
+      continue;
+    }
+    if (S_ISDIR(statbuf.st_mode)) {
+      if (recursive_) {
+        success = addWatch(path, found_files) && success;
+      }
+    } else if (found_files != nullptr) {
+      found_files->push_back(Event{directory, entry->d_name, EventType::WRITTEN});
+    }
+  }
+  closedir(dir);
+  return success;
+}
+
+bool DirectoryWatcher::poll(std::vector<Event> &events, std::chrono::milliseconds timeout) {
+  if (fd_ < 0) {
+    return false;
+  }
+  if (timeout.count() > 0) {
+    struct pollfd poll_fd = {fd_, POLLIN, 0};
+    if (::poll(&poll_fd, 1, static_cast<int>(timeout.count())) < 0 && errno != EINTR) {
+      logger_->log_warn("Could not wait for inotify events: %s", std::strerror(errno));
+      return false;
+    }
+  }
+
+  bool complete = true;
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  while (true) {
+    const ssize_t length = read(fd_, buffer, sizeof(buffer));
+    if (length < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        logger_->log_warn("Could not read inotify events: %s", std::strerror(errno));
+        complete = false;
+      }
+      break;
+    }
+    if (length == 0) {
+      break;
+    }
+    for (char *position = buffer; position < buffer + length;) {
+      const auto event = reinterpret_cast<const struct inotify_event *>(position);
+      position += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        logger_->log_debug("inotify queue overflowed, events were lost");
+        complete = false;
+        continue;
+      }
+      const auto directory = directories_.find(event->wd);
+      if (directory == directories_.end()) {
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        directories_.erase(directory);
+        continue;
+      }
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        // the directory is gone, a moved one would be reported with a stale path
+        inotify_rm_watch(fd_, event->wd);
+        directories_.erase(directory);
+        complete = false;
+        continue;
+      }
+      if (event->len == 0) {
+        continue;
+      }
+      const std::string filename(event->name);
+      if (event->mask & IN_ISDIR) {
+        if (recursive_ && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+          // files may have been created before the watch was added, report them as well
+          complete = addWatch(directory->second + FileUtils::get_separator() + filename, &events) && complete;
+        }
+        continue;
+      }
+      if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        events.push_back(Event{directory->second, filename, EventType::WRITTEN});
+      } else if (event->mask & IN_MODIFY) {
+        events.push_back(Event{directory->second, filename, EventType::MODIFIED});
+      } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        events.push_back(Event{directory->second, filename, EventType::REMOVED});
+      }
+    }
+  }
+  return complete;
+}
+
+void DirectoryWatcher::close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  directories_.clear();
+}
+
+#else
+
+bool DirectoryWatcher::isSupported() {
+  return false;
+}
+
+bool DirectoryWatcher::watch(const std::string &directory) {
+  return false;
+}
+
+bool DirectoryWatcher::addWatch(const std::string &directory, std::vector<Event> *found_files) {
+  return false;
+}
+
+bool DirectoryWatcher::poll(std::vector<Event> &events, std::chrono::milliseconds timeout) {
+  return false;
+}
+
+void DirectoryWatcher::close() {
+}
+
+#endif
+
+}  // namespace file
+}  // namespace utils
+}  // namespace minifi
+}  // namespace nifi
+}  // namespace apache
+}  // namespace org
@@ -18,9 +18,20 @@
 #include "utils/file/FileUtils.h"
 
 #include <zlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include <algorithm>
+#include <cerrno>
 #include <iostream>
+#include <vector>
 
 namespace org {
 namespace apache {
@@ -49,6 +60,127 @@ uint64_t FileUtils::computeChecksum(const std::string &file_name, uint64_t up_to
   return checksum;
 }
 
+namespace {
+
+#ifdef __linux__
+// sendfile and copy_file_range copy a little less than 2 GB per call at most, ask for 1 GB at a time
+constexpr uint64_t MAX_KERNEL_COPY_SIZE = 1024 * 1024 * 1024;
+
+bool copy_in_kernel(int source_fd, uint64_t offset, int destination_fd, uint64_t length, uint64_t &copied) {
+#ifdef SYS_copy_file_range
+  loff_t source_offset = offset;
+  loff_t destination_offset = 0;
+  while (copied < length) {
+    const ssize_t ret = syscall(SYS_copy_file_range, source_fd, &source_offset, destination_fd, &destination_offset, (std::min)(length - copied, MAX_KERNEL_COPY_SIZE), 0u);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      // not supported by the kernel or across these file systems, sendfile takes over from here
+      break;
+    }
+    copied += ret;
+  }
+  if (copied == length) {
+    return true;
+  }
+#endif
+  off_t source_offset_for_sendfile = offset + copied;
+  if (lseek(destination_fd, copied, SEEK_SET) < 0) {
+    return false;
+  }
+  while (copied < length) {
+    const ssize_t ret = sendfile(destination_fd, source_fd, &source_offset_for_sendfile, (std::min)(length - copied, MAX_KERNEL_COPY_SIZE));
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      return false;
+    }
+    if (ret == 0) {
+      // the source has been truncated in the meantime
+      break;
+    }
+    copied += ret;
+  }
+  return true;
+}
+#endif
+
+bool copy_buffered(const std::string &source, uint64_t offset, const std::string &destination, uint64_t &copied) {
+  std::ifstream input(source, std::ios::in | std::ios::binary);
+  std::ofstream output(destination, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!input.is_open() || !output.is_open()) {
+    return false;
+  }
+  if (offset != 0) {
+    input.seekg(offset);
+    if (!input.good()) {
+      return false;
+    }
+  }
+  std::vector<char> buffer(64 * 1024);
+  while (input.good()) {
+    input.read(buffer.data(), buffer.size());
+    const std::streamsize read = input.gcount();
+    if (read <= 0) {
+      break;
+    }
+    if (!output.write(buffer.data(), read)) {
+      return false;
+    }
+    copied += read;
+  }
+  output.close();
+  return !output.fail();
+}
+
+}  // namespace
+
+bool FileUtils::copy_file_contents(const std::string &source, uint64_t offset, const std::string &destination, uint64_t &copied) {
+  copied = 0;
+#ifdef __linux__
+  const int source_fd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source_fd < 0) {
+    return false;
+  }
+  struct stat source_stat;
+  if (fstat(source_fd, &source_stat) != 0 || !S_ISREG(source_stat.st_mode) || source_stat.st_size == 0) {
+    // pipes and pseudo files such as those in /proc do not report their size
+    close(source_fd);
+    return copy_buffered(source, offset, destination, copied);
+  }
+  if (static_cast<uint64_t>(source_stat.st_size) < offset) {
+    close(source_fd);
+    return false;
+  }
+  const int destination_fd = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (destination_fd < 0) {
+    close(source_fd);
+    return false;
+  }
+  const uint64_t length = source_stat.st_size - offset;
+  bool success = false;
+#ifdef FICLONE
+  // copy on write file systems (btrfs, xfs) share the extents of the source instead of copying them
+  if (offset == 0 && ioctl(destination_fd, FICLONE, source_fd) == 0) {
+    copied = length;
+    success = true;
+  }
+#endif
+  if (!success) {
+    success = copy_in_kernel(source_fd, offset, destination_fd, length, copied);
+  }
+  close(source_fd);
+  if (close(destination_fd) != 0) {
+    success = false;
+  }
+  return success;
+#else
+  return copy_buffered(source, offset, destination, copied);
+#endif
+}
+
 }  // namespace file
 }  // namespace utils
 }  // namespace minifi
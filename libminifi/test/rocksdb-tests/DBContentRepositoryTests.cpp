@@ -18,12 +18,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/Core.h"
 #include "DatabaseContentRepository.h"
 #include "FlowFileRecord.h"
 #include "properties/Configure.h"
 #include "provenance/Provenance.h"
+#include "RocksDbStream.h"
 #include "../TestBase.h"
 #include "../unit/ProvenanceTestHelper.h"
 
@@ -294,3 +296,81 @@ TEST_CASE("Delete Remove Count Claim", "[TestDBCR6]") {
 
   REQUIRE(readstr == "well hello there");
 }
+
+TEST_CASE("Content spanning several chunks", "[TestDBCR7]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = std::make_shared<core::repository::DatabaseContentRepository>();
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_chunk_size, "16");
+  REQUIRE(content_repo->initialize(configuration));
+
+  std::string content;
+  for (int i = 0; i < 100; ++i) {
+    content += std::to_string(i) + ",";
+  }
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto stream = content_repo->write(claim);
+  std::vector<uint8_t> first_half(content.begin(), content.begin() + 150);
+  REQUIRE(stream->writeData(first_half.data(), first_half.size()) == 150);
+
+  // nothing is visible before the stream is committed
+  REQUIRE_FALSE(content_repo->exists(claim));
+  stream->closeStream();
+  REQUIRE(content_repo->exists(claim));
+
+  // appending continues in the partially filled last chunk
+  stream = content_repo->write(claim, true);
+  std::vector<uint8_t> second_half(content.begin() + 150, content.end());
+  REQUIRE(stream->writeData(second_half.data(), second_half.size()) == static_cast<int>(second_half.size()));
+  stream->closeStream();
+
+  auto read_stream = content_repo->read(claim);
+  REQUIRE(read_stream->getSize() == content.size());
+  std::vector<uint8_t> buffer;
+  REQUIRE(read_stream->readData(buffer, content.size() + 10) == static_cast<int>(content.size()));
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == content);
+  REQUIRE(read_stream->readData(buffer, 1) == 0);
+
+  read_stream->seek(37);
+  REQUIRE(read_stream->readData(buffer, 20) == 20);
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == content.substr(37, 20));
+
+  REQUIRE(content_repo->remove(claim));
+  REQUIRE_FALSE(content_repo->exists(claim));
+  REQUIRE(content_repo->read(claim)->readData(buffer, 1) == -1);
+}
+
+TEST_CASE("Removing content deletes the chunks of an interrupted commit", "[TestDBCR8]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  rocksdb::Options options;
+  options.create_if_missing = true;
+  rocksdb::DB* db = nullptr;
+  REQUIRE(rocksdb::DB::Open(options, dir, &db).ok());
+  std::unique_ptr<rocksdb::DB> db_guard(db);
+
+  std::string content(40 * 16, 'x');
+  {
+    // enough chunks to be flushed before the commit
+    minifi::io::RocksDbStream stream("content", db, true, 16);
+    std::vector<uint8_t> buffer(content.begin(), content.end());
+    REQUIRE(stream.writeData(buffer.data(), buffer.size()) == static_cast<int>(buffer.size()));
+  }
+  REQUIRE(minifi::io::RocksDbStream::exists(db, "content"));
+  // the chunks were written, but the commit did not get to the metadata
+  REQUIRE(db->Delete(rocksdb::WriteOptions(), "content#meta").ok());
+  REQUIRE_FALSE(minifi::io::RocksDbStream::exists(db, "content"));
+
+  REQUIRE(minifi::io::RocksDbStream::remove(db, "content"));
+
+  std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions()));
+  it->SeekToFirst();
+  REQUIRE_FALSE(it->Valid());
+}
@@ -18,10 +18,14 @@
 
 #include <array>
 #include <chrono>
+#include <memory>
 #include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "ProvenanceRepository.h"
+#include "provenance/Provenance.h"
 #include "../TestBase.h"
 
 #define TEST_PROVENANCE_STORAGE_SIZE (1024*100)  // 100 KB
@@ -121,3 +125,136 @@ TEST_CASE("Test time limit", "[timeLimitTest]") {
 
   verifyMaxKeyCount(provdb, 400);
 }
+
+std::vector<std::string> readEvents(minifi::provenance::ProvenanceRepository& repo, size_t batch_size,
+                                    std::vector<std::shared_ptr<core::SerializableComponent>>& records) {
+  records.clear();
+  size_t count = batch_size;
+  repo.DeSerialize(records, count, []() {return std::make_shared<minifi::provenance::ProvenanceEventRecord>();});
+  REQUIRE(count == records.size());
+  std::vector<std::string> details;
+  for (const auto& record : records) {
+    details.push_back(std::static_pointer_cast<minifi::provenance::ProvenanceEventRecord>(record)->getDetails());
+  }
+  return details;
+}
+
+std::vector<std::string> readEvents(minifi::provenance::ProvenanceRepository& repo, size_t batch_size) {
+  std::vector<std::shared_ptr<core::SerializableComponent>> records;
+  return readEvents(repo, batch_size, records);
+}
+
+void storeEvents(minifi::provenance::ProvenanceRepository& repo, int first, int last) {
+  for (int i = first; i < last; ++i) {
+    minifi::provenance::ProvenanceEventRecord event(minifi::provenance::ProvenanceEventRecord::CREATE, "componentid", "componenttype");
+    event.setDetails(std::to_string(i));
+    minifi::io::DataStream stream;
+    REQUIRE(event.Serialize(stream));
+    REQUIRE(repo.Put(event.getEventId(), stream.getBuffer(), stream.getSize()));
+  }
+}
+
+TEST_CASE("Reporting continues from the acknowledged events", "[reportingCursor]") {
+  TestController testController;
+
+  char dirtemplate[] = "/var/tmp/db.XXXXXX";
+  auto temp_dir = testController.createTempDirectory(dirtemplate);
+  REQUIRE(!temp_dir.empty());
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_directory_default, temp_dir);
+
+  {
+    minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir);
+    REQUIRE(provdb.initialize(configuration));
+    storeEvents(provdb, 0, 25);
+
+    std::vector<std::string> batch = readEvents(provdb, 10);
+    REQUIRE(batch.size() == 10);
+    REQUIRE(batch.front() == "0");
+    // without an acknowledgement the same events are returned
+    std::vector<std::shared_ptr<core::SerializableComponent>> acknowledged;
+    REQUIRE(readEvents(provdb, 10, acknowledged) == batch);
+
+    REQUIRE(provdb.Delete(acknowledged));
+    REQUIRE(provdb.getCursor() == 10);
+    batch = readEvents(provdb, 10, acknowledged);
+    REQUIRE(batch.front() == "10");
+    REQUIRE(batch.back() == "19");
+    REQUIRE(provdb.Delete(acknowledged));
+  }
+
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(configuration));
+  REQUIRE(provdb.getCursor() == 20);
+  storeEvents(provdb, 25, 30);
+  const std::vector<std::string> batch = readEvents(provdb, 100);
+  REQUIRE(batch == (std::vector<std::string>{"20", "21", "22", "23", "24", "25", "26", "27", "28", "29"}));
+}
+
+TEST_CASE("Only the acknowledged events move the reporting cursor", "[reportingCursor]") {
+  TestController testController;
+
+  char dirtemplate[] = "/var/tmp/db.XXXXXX";
+  auto temp_dir = testController.createTempDirectory(dirtemplate);
+  REQUIRE(!temp_dir.empty());
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_directory_default, temp_dir);
+
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(configuration));
+  storeEvents(provdb, 0, 10);
+
+  std::vector<std::shared_ptr<core::SerializableComponent>> records;
+  REQUIRE(readEvents(provdb, 10, records).size() == 10);
+
+  // the first event is not acknowledged, the cursor stays
+  std::vector<std::shared_ptr<core::SerializableComponent>> acknowledged(records.begin() + 1, records.end());
+  REQUIRE(provdb.Delete(acknowledged));
+  REQUIRE(provdb.getCursor() == 0);
+
+  // unrelated records do not move it either
+  std::vector<std::shared_ptr<core::SerializableComponent>> unrelated{std::make_shared<minifi::provenance::ProvenanceEventRecord>()};
+  REQUIRE(provdb.Delete(unrelated));
+  REQUIRE(provdb.getCursor() == 0);
+
+  acknowledged.assign(records.begin(), records.begin() + 4);
+  REQUIRE(provdb.Delete(acknowledged));
+  REQUIRE(provdb.getCursor() == 4);
+
+  acknowledged.assign(records.begin() + 4, records.end());
+  REQUIRE(provdb.Delete(acknowledged));
+  REQUIRE(provdb.getCursor() == 10);
+}
+
+TEST_CASE("Events are found and deleted by their id", "[eventIndex]") {
+  TestController testController;
+
+  char dirtemplate[] = "/var/tmp/db.XXXXXX";
+  auto temp_dir = testController.createTempDirectory(dirtemplate);
+  REQUIRE(!temp_dir.empty());
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_directory_default, temp_dir);
+
+  minifi::provenance::ProvenanceRepository provdb("TestProvRepo", temp_dir);
+  REQUIRE(provdb.initialize(configuration));
+  storeEvents(provdb, 0, 5);
+
+  minifi::provenance::ProvenanceEventRecord event(minifi::provenance::ProvenanceEventRecord::CREATE, "componentid", "componenttype");
+  event.setDetails("indexed");
+  std::vector<std::pair<std::string, std::unique_ptr<minifi::io::DataStream>>> data;
+  data.emplace_back(event.getEventId(), std::unique_ptr<minifi::io::DataStream>(new minifi::io::DataStream()));
+  REQUIRE(event.Serialize(*data.back().second));
+  REQUIRE(provdb.MultiPut(data));
+  storeEvents(provdb, 5, 10);
+
+  std::string value;
+  REQUIRE(provdb.Get(event.getEventId(), value));
+  minifi::provenance::ProvenanceEventRecord read_event;
+  REQUIRE(read_event.DeSerialize(reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+  REQUIRE(read_event.getDetails() == "indexed");
+
+  REQUIRE(provdb.Delete(event.getEventId()));
+  REQUIRE_FALSE(provdb.Get(event.getEventId(), value));
+  REQUIRE_FALSE(provdb.Delete(event.getEventId()));
+  REQUIRE(readEvents(provdb, 100).size() == 10);
+}
@@ -16,11 +16,14 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "core/Core.h"
 #include "core/repository/AtomicRepoEntries.h"
@@ -407,3 +410,159 @@ TEST_CASE("Flush deleted flowfiles before shutdown", "[TestFFR7]") {
     REQUIRE(connection->getQueueSize() == 50);
   }
 }
+
+namespace {
+
+class RecordingFlowFileRepository : public core::repository::FlowFileRepository {
+ public:
+  explicit RecordingFlowFileRepository(const std::string& directory)
+      : core::SerializableComponent("ff"),
+        FlowFileRepository("ff", directory, MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME, MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE, 0),
+        writes_(std::make_shared<Writes>()) {
+    // the writer outlives this object in the group commit writer thread, so it only shares the record of the writes
+    std::shared_ptr<Writes> writes = writes_;
+    setBatchWriter([writes](rocksdb::DB *db, const rocksdb::WriteOptions &options, rocksdb::WriteBatch *batch) {
+      {
+        std::lock_guard<std::mutex> lock(writes->mutex);
+        ++writes->count;
+        writes->record_count += batch->Count();
+        writes->last_options = options;
+      }
+      return db->Write(options, batch);
+    });
+  }
+
+  using FlowFileRepository::getWriteOptions;
+
+  size_t writeCount() {
+    std::lock_guard<std::mutex> lock(writes_->mutex);
+    return writes_->count;
+  }
+
+  size_t writtenRecordCount() {
+    std::lock_guard<std::mutex> lock(writes_->mutex);
+    return writes_->record_count;
+  }
+
+  rocksdb::WriteOptions lastWriteOptions() {
+    std::lock_guard<std::mutex> lock(writes_->mutex);
+    return writes_->last_options;
+  }
+
+ private:
+  struct Writes {
+    std::mutex mutex;
+    size_t count = 0;
+    size_t record_count = 0;
+    rocksdb::WriteOptions last_options;
+  };
+
+  std::shared_ptr<Writes> writes_;
+};
+
+std::shared_ptr<minifi::Configure> createGroupCommitConfig(const std::string& dir, const std::string& max_latency) {
+  auto config = std::make_shared<minifi::Configure>();
+  config->set(minifi::Configure::nifi_flowfile_repository_directory_default, utils::file::FileUtils::concat_path(dir, "flowfile_repository"));
+  config->set(minifi::Configure::nifi_flowfile_repository_group_commit_max_latency, max_latency);
+  return config;
+}
+
+}  // namespace
+
+TEST_CASE("Group commit coalesces concurrent committers", "[TestFFR8]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  auto repository = std::make_shared<RecordingFlowFileRepository>(dir);
+  REQUIRE(repository->initialize(createGroupCommitConfig(dir, "500 ms")));
+
+  constexpr size_t COMMITTER_COUNT = 8;
+  std::vector<std::thread> committers;
+  std::vector<int> results(COMMITTER_COUNT, -1);
+  for (size_t i = 0; i < COMMITTER_COUNT; ++i) {
+    committers.emplace_back([&repository, &results, i] {
+      const std::string value = "value" + std::to_string(i);
+      results[i] = repository->Put("key" + std::to_string(i), reinterpret_cast<const uint8_t*>(value.data()), value.size()) ? 1 : 0;
+    });
+  }
+  for (auto& committer : committers) {
+    committer.join();
+  }
+
+  for (size_t i = 0; i < COMMITTER_COUNT; ++i) {
+    REQUIRE(results[i] == 1);
+    std::string value;
+    REQUIRE(repository->Get("key" + std::to_string(i), value));
+    REQUIRE(value == "value" + std::to_string(i));
+  }
+  REQUIRE(repository->writtenRecordCount() == COMMITTER_COUNT);
+  REQUIRE(repository->writeCount() < COMMITTER_COUNT);
+}
+
+TEST_CASE("Stopping the repository drains the pending group commit writes", "[TestFFR9]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  auto repository = std::make_shared<RecordingFlowFileRepository>(dir);
+  // long enough that only stopping the writer can flush the committer
+  REQUIRE(repository->initialize(createGroupCommitConfig(dir, "1 min")));
+
+  const std::string value = "pending";
+  std::atomic<bool> result{false};
+  std::thread committer([&] {
+    result = repository->Put("key", reinterpret_cast<const uint8_t*>(value.data()), value.size());
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds{200});
+  REQUIRE(repository->writeCount() == 0);
+
+  const auto start = std::chrono::steady_clock::now();
+  repository->stop();
+  committer.join();
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds{30});
+
+  REQUIRE(result);
+  REQUIRE(repository->writeCount() == 1);
+  std::string stored;
+  REQUIRE(repository->Get("key", stored));
+  REQUIRE(stored == value);
+
+  // later committers are written directly
+  REQUIRE(repository->Put("other", reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+  REQUIRE(repository->writeCount() == 2);
+}
+
+TEST_CASE("FlowFile repository durability selects the write options", "[TestFFR10]") {
+  TestController testController;
+  char format[] = "/var/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  auto config = createGroupCommitConfig(dir, "0 ms");
+  bool sync = false;
+  bool disable_wal = false;
+  SECTION("default") {
+  }
+  SECTION("async") {
+    config->set(minifi::Configure::nifi_flowfile_repository_durability, "async");
+  }
+  SECTION("sync") {
+    config->set(minifi::Configure::nifi_flowfile_repository_durability, "sync");
+    sync = true;
+  }
+  SECTION("none") {
+    config->set(minifi::Configure::nifi_flowfile_repository_durability, "none");
+    disable_wal = true;
+  }
+
+  auto repository = std::make_shared<RecordingFlowFileRepository>(dir);
+  REQUIRE(repository->initialize(config));
+  REQUIRE(repository->getWriteOptions().sync == sync);
+  REQUIRE(repository->getWriteOptions().disableWAL == disable_wal);
+
+  const std::string value = "value";
+  REQUIRE(repository->Put("key", reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+  REQUIRE(repository->writeCount() == 1);
+  REQUIRE(repository->lastWriteOptions().sync == sync);
+  REQUIRE(repository->lastWriteOptions().disableWAL == disable_wal);
+}
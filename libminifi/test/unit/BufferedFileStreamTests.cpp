@@ -0,0 +1,156 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io/BufferedFileStream.h"
+#include "io/FileStream.h"
+#include "../TestBase.h"
+
+namespace {
+
+std::string readFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+TEST_CASE("BufferedFileStream writes small writes once closed", "[BufferedFileStream]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  const std::string path = dir + "/tstFile.ext";
+
+  {
+    minifi::io::BufferedFileStream stream(path, false, 16);
+    for (const std::string part : {"hello", " ", "buffered", " ", "world"}) {
+      REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(part.data())), part.size()) == static_cast<int>(part.size()));
+    }
+    REQUIRE(stream.getSize() == 20);
+  }
+  REQUIRE(readFile(path) == "hello buffered world");
+
+  {
+    minifi::io::BufferedFileStream stream(path, true, 16);
+    REQUIRE(stream.getSize() == 20);
+    stream.writeUTF("!");
+  }
+  minifi::io::BufferedFileStream stream(path, 20, false);
+  std::string appended;
+  REQUIRE(stream.readUTF(appended) > 0);
+  REQUIRE(appended == "!");
+}
+
+TEST_CASE("BufferedFileStream reads across buffer boundaries", "[BufferedFileStream]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  const std::string path = dir + "/tstFile.ext";
+
+  std::string content;
+  for (int i = 0; i < 1000; ++i) {
+    content += std::to_string(i);
+  }
+  std::ofstream(path, std::ios::binary) << content;
+
+  minifi::io::BufferedFileStream stream(path, 0, false, 64);
+  REQUIRE(stream.getSize() == content.size());
+  std::vector<uint8_t> buffer;
+  std::string read;
+  int ret;
+  while ((ret = stream.readData(buffer, 50)) > 0) {
+    read.append(buffer.begin(), buffer.end());
+  }
+  REQUIRE(ret == 0);
+  REQUIRE(read == content);
+
+  stream.seek(10);
+  REQUIRE(stream.readData(buffer, 200) == 200);
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == content.substr(10, 200));
+
+  uint32_t value;
+  stream.seek(0);
+  REQUIRE(stream.read(value) == 4);
+  REQUIRE(value == (('0' << 24) | ('1' << 16) | ('2' << 8) | '3'));
+}
+
+TEST_CASE("BufferedFileStream overwrites in place", "[BufferedFileStream]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  const std::string path = dir + "/tstFile.ext";
+  std::ofstream(path, std::ios::binary) << "tempFile";
+
+  minifi::io::BufferedFileStream stream(path, 0, true);
+  std::vector<uint8_t> buffer;
+  REQUIRE(stream.readData(buffer, stream.getSize()) == 8);
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == "tempFile");
+
+  stream.seek(4);
+  stream.write(reinterpret_cast<uint8_t*>(const_cast<char*>("file")), 4);
+  stream.seek(0);
+  REQUIRE(stream.readData(buffer, stream.getSize()) == 8);
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == "tempfile");
+}
+
+TEST_CASE("BufferedFileStream fails on missing files", "[BufferedFileStream]") {
+  minifi::io::BufferedFileStream stream("/this/path/does/not/exist", 0, false);
+  std::vector<uint8_t> buffer;
+  REQUIRE(stream.readData(buffer, 10) == -1);
+  REQUIRE(stream.getSize() == 0);
+}
+
+TEST_CASE("FileStream and BufferedFileStream write throughput", "[.][benchmark]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  // processors usually write their content with a few KB per call
+  std::vector<uint8_t> chunk(1024, 'x');
+  struct Scenario {
+    size_t flow_file_size;
+    size_t flow_file_count;
+  };
+  for (const auto scenario : {Scenario{4 * 1024, 5000}, Scenario{1024 * 1024, 50}}) {
+    for (const bool buffered : {false, true}) {
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < scenario.flow_file_count; ++i) {
+        const std::string path = dir + "/" + std::to_string(i);
+        std::shared_ptr<minifi::io::BaseStream> stream;
+        if (buffered) {
+          stream = std::make_shared<minifi::io::BufferedFileStream>(path);
+        } else {
+          stream = std::make_shared<minifi::io::FileStream>(path);
+        }
+        for (size_t written = 0; written < scenario.flow_file_size; written += chunk.size()) {
+          stream->writeData(chunk.data(), chunk.size());
+        }
+        stream->closeStream();
+      }
+      const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << (buffered ? "BufferedFileStream: " : "FileStream: ") << scenario.flow_file_count << " flow files of "
+          << scenario.flow_file_size / 1024 << " KB in " << elapsed.count() << " ms" << std::endl;
+    }
+  }
+}
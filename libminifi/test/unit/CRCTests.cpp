@@ -16,8 +16,14 @@
  * limitations under the License.
  */
 
+#include <zlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
 #include <string>
 #include <vector>
+#include "io/CRC32.h"
 #include "io/CRCStream.h"
 #include "io/DataStream.h"
 #include "../TestBase.h"
@@ -98,3 +104,37 @@ TEST_CASE("CRCStream: one long write is the same as writing in two pieces", "[in
 
   REQUIRE(test_full.getCRC() == test_piece2.getCRC());
 }
+
+TEST_CASE("updateCRC32 matches zlib for every length and alignment", "[updateCRC32]") {
+  std::mt19937 generator(42);
+  std::vector<uint8_t> data(70000);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(generator());
+  }
+  for (size_t length : {0, 1, 15, 16, 63, 64, 65, 80, 127, 128, 129, 1000, 4096, 65536, 69990}) {
+    for (size_t offset : {0, 1, 7}) {
+      const uint32_t expected = crc32(0x1234, data.data() + offset, length);
+      REQUIRE(org::apache::nifi::minifi::io::updateCRC32(0x1234, data.data() + offset, length) == expected);
+    }
+  }
+}
+
+TEST_CASE("CRC32 throughput", "[.][benchmark]") {
+  std::vector<uint8_t> data(1024 * 1024, 'x');
+  const int iterations = 500;
+  uLong zlib_crc = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    zlib_crc = crc32(zlib_crc, data.data(), data.size());
+  }
+  const auto middle = std::chrono::steady_clock::now();
+  uint32_t crc = 0;
+  for (int i = 0; i < iterations; ++i) {
+    crc = org::apache::nifi::minifi::io::updateCRC32(crc, data.data(), data.size());
+  }
+  const auto end = std::chrono::steady_clock::now();
+  REQUIRE(crc == zlib_crc);
+  std::cout << "zlib crc32: " << std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count() << " ms, updateCRC32"
+      << (org::apache::nifi::minifi::io::isHardwareCRC32Supported() ? " (pclmul): " : ": ")
+      << std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count() << " ms for " << iterations << " MB" << std::endl;
+}
@@ -0,0 +1,144 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "ResourceClaim.h"
+#include "core/repository/FileSystemRepository.h"
+#include "properties/Configure.h"
+
+namespace {
+
+std::shared_ptr<core::repository::FileSystemRepository> createRepository(const std::string &directory, const std::string &max_container_size) {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, directory);
+  configuration->set(minifi::Configure::nifi_content_repository_container_enabled, "true");
+  configuration->set(minifi::Configure::nifi_content_repository_container_max_size, max_container_size);
+  auto content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(content_repo->initialize(configuration));
+  REQUIRE(content_repo->getClaimContainers() != nullptr);
+  return content_repo;
+}
+
+void writeContent(const std::shared_ptr<core::ContentRepository> &content_repo, const std::shared_ptr<minifi::ResourceClaim> &claim, const std::string &content, bool append = false) {
+  auto stream = content_repo->write(claim, append);
+  REQUIRE(stream != nullptr);
+  std::vector<uint8_t> buffer(content.begin(), content.end());
+  REQUIRE(stream->writeData(buffer.data(), buffer.size()) == static_cast<int>(buffer.size()));
+  stream->closeStream();
+}
+
+std::string readContent(const std::shared_ptr<core::ContentRepository> &content_repo, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  auto stream = content_repo->read(claim);
+  std::vector<uint8_t> buffer;
+  stream->readData(buffer, stream->getSize());
+  return std::string(buffer.begin(), buffer.end());
+}
+
+}  // namespace
+
+TEST_CASE("Small claims share a container", "[ClaimContainer]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = createRepository(dir, "1 MB");
+
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> claims;
+  for (int i = 0; i < 100; ++i) {
+    auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+    writeContent(content_repo, claim, "content " + std::to_string(i));
+    claims.push_back(claim);
+  }
+
+  REQUIRE(content_repo->getClaimContainers()->getContainerCount() == 1);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(content_repo->exists(claims[i]));
+    REQUIRE(readContent(content_repo, claims[i]) == "content " + std::to_string(i));
+  }
+
+  auto stream = content_repo->read(claims[42]);
+  stream->seek(8);
+  std::vector<uint8_t> buffer;
+  REQUIRE(stream->readData(buffer, 100) == 2);
+  REQUIRE(std::string(buffer.begin(), buffer.end()) == "42");
+}
+
+TEST_CASE("Appending relocates the claim", "[ClaimContainer]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = createRepository(dir, "1 MB");
+
+  auto first = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto second = std::make_shared<minifi::ResourceClaim>(content_repo);
+  writeContent(content_repo, first, "hello");
+  writeContent(content_repo, second, "other");
+  writeContent(content_repo, first, " world", true);
+
+  REQUIRE(readContent(content_repo, first) == "hello world");
+  REQUIRE(readContent(content_repo, second) == "other");
+}
+
+TEST_CASE("Full containers are deleted once their claims are removed", "[ClaimContainer]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  // every claim fills up its container
+  auto content_repo = createRepository(dir, "4 B");
+
+  auto first = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto second = std::make_shared<minifi::ResourceClaim>(content_repo);
+  writeContent(content_repo, first, "first");
+  writeContent(content_repo, second, "second");
+  REQUIRE(content_repo->getClaimContainers()->getContainerCount() == 2);
+
+  first->increaseFlowFileRecordOwnedCount();
+  first->decreaseFlowFileRecordOwnedCount();
+  REQUIRE(content_repo->removeIfOrphaned(first));
+  REQUIRE_FALSE(content_repo->exists(first));
+  REQUIRE(content_repo->getClaimContainers()->getContainerCount() == 1);
+  REQUIRE(readContent(content_repo, second) == "second");
+}
+
+TEST_CASE("Claim locations survive a restart", "[ClaimContainer]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = createRepository(dir, "1 MB");
+
+  auto kept = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto removed = std::make_shared<minifi::ResourceClaim>(content_repo);
+  writeContent(content_repo, kept, "kept");
+  writeContent(content_repo, removed, "removed");
+  REQUIRE(content_repo->remove(removed));
+  content_repo->stop();
+
+  content_repo = createRepository(dir, "1 MB");
+  auto restored = std::make_shared<minifi::ResourceClaim>(kept->getContentFullPath(), content_repo);
+  REQUIRE(content_repo->exists(restored));
+  REQUIRE(readContent(content_repo, restored) == "kept");
+  REQUIRE_FALSE(content_repo->exists(std::make_shared<minifi::ResourceClaim>(removed->getContentFullPath(), content_repo)));
+
+  // containers of earlier runs are sealed, their last removal deletes them
+  REQUIRE(content_repo->getClaimContainers()->getContainerCount() == 1);
+  REQUIRE(content_repo->remove(restored));
+  REQUIRE(content_repo->getClaimContainers()->getContainerCount() == 0);
+}
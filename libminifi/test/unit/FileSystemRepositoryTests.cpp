@@ -0,0 +1,87 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "ResourceClaim.h"
+#include "core/repository/FileSystemRepository.h"
+#include "properties/Configure.h"
+
+namespace {
+
+std::shared_ptr<core::repository::FileSystemRepository> createRepository(const std::string &directory) {
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, directory);
+  auto content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(content_repo->initialize(configuration));
+  return content_repo;
+}
+
+std::string readContent(const std::shared_ptr<core::ContentRepository> &content_repo, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  auto stream = content_repo->read(claim);
+  std::vector<uint8_t> buffer;
+  stream->readData(buffer, stream->getSize());
+  return std::string(buffer.begin(), buffer.end());
+}
+
+bool fileExists(const std::string &path) {
+  std::ifstream file(path);
+  return file.good();
+}
+
+}  // namespace
+
+TEST_CASE("Files that are not kept are moved into the repository", "[importFile]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = createRepository(dir + "/content");
+  const std::string source = dir + "/input.txt";
+  std::ofstream(source, std::ios::binary) << "imported content";
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  uint64_t size = 0;
+  REQUIRE(content_repo->importFile(claim, source, 0, false, size));
+  REQUIRE(size == 16);
+  REQUIRE_FALSE(fileExists(source));
+  REQUIRE(readContent(content_repo, claim) == "imported content");
+}
+
+TEST_CASE("Kept files are copied into the repository", "[importFile]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = createRepository(dir + "/content");
+  const std::string source = dir + "/input.txt";
+  std::ofstream(source, std::ios::binary) << "imported content";
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  uint64_t size = 0;
+  REQUIRE(content_repo->importFile(claim, source, 9, true, size));
+  REQUIRE(size == 7);
+  REQUIRE(fileExists(source));
+  REQUIRE(readContent(content_repo, claim) == "content");
+
+  auto missing = std::make_shared<minifi::ResourceClaim>(content_repo);
+  REQUIRE_FALSE(content_repo->importFile(missing, dir + "/missing.txt", 0, true, size));
+  REQUIRE_FALSE(content_repo->exists(missing));
+}
@@ -351,3 +351,32 @@ TEST_CASE("FileUtils::computeChecksum with large files", "[computeChecksum]") {
   REQUIRE(FileUtils::computeChecksum(another_file, 8192) == CHECKSUM_OF_8192_BYTES);
   REQUIRE(FileUtils::computeChecksum(another_file, 9000) == CHECKSUM_OF_8192_BYTES);
 }
+
+TEST_CASE("FileUtils::copy_file_contents works", "[copy_file_contents]") {
+  TestController testController;
+
+  char format[] = "/tmp/gt.XXXXXX";
+  std::string dir = testController.createTempDirectory(format);
+
+  std::string source = dir + FileUtils::get_separator() + "source.txt";
+  std::string destination = dir + FileUtils::get_separator() + "destination.txt";
+  std::string content;
+  for (int i = 0; i < 100000; ++i) {
+    content += std::to_string(i);
+  }
+  std::ofstream{source, std::ios::out | std::ios::binary} << content;
+
+  uint64_t copied = 0;
+  REQUIRE(FileUtils::copy_file_contents(source, 0, destination, copied));
+  REQUIRE(copied == content.size());
+  std::ifstream destination_stream{destination, std::ios::in | std::ios::binary};
+  REQUIRE(std::string(std::istreambuf_iterator<char>(destination_stream), {}) == content);
+  destination_stream.close();
+
+  REQUIRE(FileUtils::copy_file_contents(source, 1000, destination, copied));
+  REQUIRE(copied == content.size() - 1000);
+  destination_stream.open(destination, std::ios::in | std::ios::binary);
+  REQUIRE(std::string(std::istreambuf_iterator<char>(destination_stream), {}) == content.substr(1000));
+
+  REQUIRE_FALSE(FileUtils::copy_file_contents(dir + FileUtils::get_separator() + "missing.txt", 0, destination, copied));
+}
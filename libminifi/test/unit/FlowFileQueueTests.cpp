@@ -0,0 +1,327 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/repository/VolatileContentRepository.h"
+#include "core/FlowFilePrioritizer.h"
+#include "utils/FlowFileQueue.h"
+
+namespace {
+
+std::shared_ptr<core::FlowFile> createFlowFile(uint64_t penalty_expiration = 0) {
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>(nullptr, nullptr, std::map<std::string, std::string>{});
+  flow_file->setPenaltyExpiration(penalty_expiration);
+  return flow_file;
+}
+
+}  // namespace
+
+TEST_CASE("FlowFileQueue keeps the insertion order of ready flow files", "[FlowFileQueue]") {
+  utils::FlowFileQueue queue;
+  REQUIRE(queue.empty());
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  REQUIRE(queue.pop() == nullptr);
+
+  const auto first = createFlowFile();
+  const auto second = createFlowFile();
+  queue.push(first);
+  queue.push(second);
+
+  REQUIRE(queue.size() == 2);
+  REQUIRE(queue.isWorkAvailable());
+  REQUIRE(queue.pop() == first);
+  REQUIRE(queue.pop() == second);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("FlowFileQueue does not let penalized flow files block ready ones", "[FlowFileQueue]") {
+  utils::FlowFileQueue queue;
+
+  const auto penalized = createFlowFile(getTimeMillis() + 60000);
+  const auto ready = createFlowFile();
+  queue.push(penalized);
+  queue.push(ready);
+
+  REQUIRE(queue.size() == 2);
+  REQUIRE(queue.pop() == ready);
+  REQUIRE(queue.pop() == nullptr);
+  REQUIRE_FALSE(queue.isWorkAvailable());
+  REQUIRE_FALSE(queue.empty());
+  REQUIRE(queue.size() == 1);
+}
+
+TEST_CASE("FlowFileQueue releases penalized flow files in order of penalty expiration", "[FlowFileQueue]") {
+  utils::FlowFileQueue queue;
+
+  const uint64_t now = getTimeMillis();
+  const auto expires_later = createFlowFile(now + 20);
+  const auto expires_sooner = createFlowFile(now + 10);
+  queue.push(expires_later);
+  queue.push(expires_sooner);
+  REQUIRE(queue.pop() == nullptr);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  REQUIRE(queue.isWorkAvailable());
+  REQUIRE(queue.pop() == expires_sooner);
+  REQUIRE(queue.pop() == expires_later);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("FlowFileQueue::clear returns penalized and ready flow files", "[FlowFileQueue]") {
+  utils::FlowFileQueue queue;
+  queue.push(createFlowFile(getTimeMillis() + 60000));
+  queue.push(createFlowFile());
+
+  REQUIRE(queue.clear().size() == 2);
+  REQUIRE(queue.empty());
+}
+
+TEST_CASE("Connection::poll skips over penalized flow files", "[Connection]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+  auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "penalty_connection");
+
+  const auto penalized = createFlowFile(getTimeMillis() + 60000);
+  const auto ready = createFlowFile();
+  connection->put(penalized);
+  connection->put(ready);
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  REQUIRE(connection->poll(expired) == ready);
+  REQUIRE(connection->poll(expired) == nullptr);
+  REQUIRE(expired.empty());
+  REQUIRE_FALSE(connection->isEmpty());
+  REQUIRE_FALSE(connection->isWorkAvailable());
+  REQUIRE(connection->getQueueSize() == 1);
+}
+
+TEST_CASE("Connection::pollBatch respects the count and size limits", "[Connection][pollBatch]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+  auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "batch_connection");
+
+  std::vector<std::shared_ptr<core::FlowFile>> flow_files;
+  for (int i = 0; i < 10; ++i) {
+    auto flow_file = createFlowFile();
+    flow_file->setSize(10);
+    flow_files.push_back(flow_file);
+  }
+  connection->multiPut(flow_files);
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  auto batch = connection->pollBatch(3, 0, expired);
+  REQUIRE(batch.size() == 3);
+  REQUIRE(batch[0] == flow_files[0]);
+  REQUIRE(batch[2] == flow_files[2]);
+  REQUIRE(batch[0]->getOriginalConnection() == connection);
+
+  batch = connection->pollBatch(100, 25, expired);
+  REQUIRE(batch.size() == 3);
+  REQUIRE(batch[0] == flow_files[3]);
+  REQUIRE(connection->getQueueSize() == 4);
+  REQUIRE(connection->getQueueDataSize() == 40);
+
+  REQUIRE(connection->pollBatch(100, 0, expired).size() == 4);
+  REQUIRE(connection->pollBatch(100, 0, expired).empty());
+  REQUIRE(expired.empty());
+}
+
+TEST_CASE("Connection with lock free ingest hands over every flow file", "[Connection][lockFree]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+  auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "lock_free_connection");
+  connection->setLockFreeIngest(true);
+  connection->setMaxQueueSize(5);
+
+  const auto penalized = createFlowFile(getTimeMillis() + 60000);
+  penalized->setSize(7);
+  connection->put(penalized);
+  for (int i = 0; i < 4; ++i) {
+    auto flow_file = createFlowFile();
+    flow_file->setSize(1);
+    connection->put(flow_file);
+  }
+
+  REQUIRE(connection->getQueueSize() == 5);
+  REQUIRE(connection->getQueueDataSize() == 11);
+  REQUIRE(connection->isFull());
+  REQUIRE(connection->isWorkAvailable());
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  REQUIRE(connection->pollBatch(10, 0, expired).size() == 4);
+  REQUIRE(connection->getQueueSize() == 1);
+  REQUIRE_FALSE(connection->isFull());
+  REQUIRE_FALSE(connection->isWorkAvailable());
+
+  connection->drain(false);
+  REQUIRE(connection->isEmpty());
+  REQUIRE(connection->getQueueDataSize() == 0);
+}
+
+TEST_CASE("Connection with lock free ingest has no work while every ingested flow file is penalized", "[Connection][lockFree]") {
+  auto configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+  auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "lock_free_connection");
+  connection->setLockFreeIngest(true);
+
+  connection->put(createFlowFile(getTimeMillis() + 60000));
+  std::vector<std::shared_ptr<core::FlowFile>> penalized{createFlowFile(getTimeMillis() + 60000), createFlowFile(getTimeMillis() + 60000)};
+  connection->multiPut(penalized);
+  REQUIRE(connection->getQueueSize() == 3);
+  REQUIRE_FALSE(connection->isWorkAvailable());
+
+  connection->put(createFlowFile());
+  REQUIRE(connection->isWorkAvailable());
+}
+
+TEST_CASE("Connection contention with 16 producers and back pressure checks", "[.][benchmark]") {
+  constexpr size_t THREAD_COUNT = 16;
+  constexpr size_t FLOW_FILES_PER_THREAD = 20000;
+
+  auto configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+
+  for (const bool lock_free : {false, true}) {
+    auto connection = std::make_shared<minifi::Connection>(flow_repo, content_repo, "contended_connection");
+    connection->setLockFreeIngest(lock_free);
+    connection->setMaxQueueSize(THREAD_COUNT * FLOW_FILES_PER_THREAD);
+
+    std::vector<std::vector<std::shared_ptr<core::FlowFile>>> flow_files(THREAD_COUNT);
+    for (auto& thread_flow_files : flow_files) {
+      for (size_t i = 0; i < FLOW_FILES_PER_THREAD; ++i) {
+        auto flow_file = createFlowFile();
+        // keep the test repository out of the measurement
+        flow_file->setStoredToRepository(true);
+        thread_flow_files.push_back(flow_file);
+      }
+    }
+
+    std::atomic<size_t> polled{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; ++t) {
+      threads.emplace_back([&, t] {
+        for (const auto& flow_file : flow_files[t]) {
+          connection->put(flow_file);
+        }
+      });
+      threads.emplace_back([&] {
+        // what the scheduler does for every trigger
+        while (polled < THREAD_COUNT * FLOW_FILES_PER_THREAD) {
+          connection->isFull();
+          connection->isWorkAvailable();
+          connection->getQueueSize();
+        }
+      });
+    }
+    threads.emplace_back([&] {
+      std::set<std::shared_ptr<core::FlowFile>> expired;
+      while (polled < THREAD_COUNT * FLOW_FILES_PER_THREAD) {
+        polled += connection->pollBatch(100, 0, expired).size();
+      }
+    });
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << (lock_free ? "lock free ingest: " : "locked ingest: ") << elapsed.count() << " ms for "
+        << THREAD_COUNT * FLOW_FILES_PER_THREAD << " flow files" << std::endl;
+    REQUIRE(connection->isEmpty());
+  }
+}
+
+TEST_CASE("FlowFileQueue orders ready flow files by the configured prioritizers", "[FlowFileQueue][prioritizers]") {
+  utils::FlowFileQueue queue;
+  queue.setPrioritizers({std::make_shared<core::PriorityAttributePrioritizer>()});
+
+  const auto low = createFlowFile();
+  low->setAttribute("priority", "10");
+  const auto high = createFlowFile();
+  high->setAttribute("priority", "2");
+  const auto textual = createFlowFile();
+  textual->setAttribute("priority", "a");
+  const auto none = createFlowFile();
+  const auto also_none = createFlowFile();
+
+  queue.push(none);
+  queue.push(textual);
+  queue.push(low);
+  queue.push(also_none);
+  queue.push(high);
+
+  REQUIRE(queue.pop() == high);
+  REQUIRE(queue.pop() == low);
+  REQUIRE(queue.pop() == textual);
+  // ties are broken by insertion order
+  REQUIRE(queue.pop() == none);
+  REQUIRE(queue.pop() == also_none);
+  REQUIRE(queue.pop() == nullptr);
+}
+
+TEST_CASE("FlowFileQueue applies later prioritizers only to break ties", "[FlowFileQueue][prioritizers]") {
+  utils::FlowFileQueue queue;
+
+  const auto big = createFlowFile();
+  big->setSize(100);
+  const auto small = createFlowFile();
+  small->setSize(1);
+  const auto urgent_big = createFlowFile();
+  urgent_big->setSize(1000);
+  urgent_big->setAttribute("priority", "1");
+  queue.push(big);
+  queue.push(small);
+  queue.push(urgent_big);
+
+  // switching prioritizers reorders what is already queued
+  queue.setPrioritizers({std::make_shared<core::PriorityAttributePrioritizer>(), std::make_shared<core::SmallestFlowFileFirstPrioritizer>()});
+
+  REQUIRE(queue.pop() == urgent_big);
+  REQUIRE(queue.pop() == small);
+  REQUIRE(queue.pop() == big);
+}
+
+TEST_CASE("FlowFilePrioritizer can be created by simple and fully qualified name", "[prioritizers]") {
+  REQUIRE(core::FlowFilePrioritizer::create("OldestFlowFileFirstPrioritizer")->getName() == "OldestFlowFileFirstPrioritizer");
+  REQUIRE(core::FlowFilePrioritizer::create("org.apache.nifi.prioritizer.NewestFlowFileFirstPrioritizer")->getName() == "NewestFlowFileFirstPrioritizer");
+  REQUIRE(core::FlowFilePrioritizer::create("PriorityAttributePrioritizer") != nullptr);
+  REQUIRE(core::FlowFilePrioritizer::create("SmallestFlowFileFirstPrioritizer") != nullptr);
+  REQUIRE(core::FlowFilePrioritizer::create("NoSuchPrioritizer") == nullptr);
+}
@@ -0,0 +1,149 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "io/BaseStream.h"
+#include "sitetosite/Peer.h"
+#include "sitetosite/PeerSelector.h"
+#include "sitetosite/RawSocketProtocol.h"
+#include "../TestBase.h"
+
+namespace {
+
+std::vector<minifi::sitetosite::PeerStatus> createPeers(const std::vector<uint32_t> &flow_file_counts) {
+  std::vector<minifi::sitetosite::PeerStatus> peers;
+  utils::Identifier port_id;
+  for (size_t i = 0; i < flow_file_counts.size(); ++i) {
+    auto peer = std::make_shared<minifi::sitetosite::Peer>(port_id, "host" + std::to_string(i), 8080, false);
+    peers.push_back(minifi::sitetosite::PeerStatus(peer, flow_file_counts[i], false));
+  }
+  return peers;
+}
+
+std::unique_ptr<minifi::sitetosite::SiteToSiteClient> createClient(const std::string &host, uint16_t port) {
+  std::unique_ptr<minifi::sitetosite::SiteToSitePeer> peer(
+      new minifi::sitetosite::SiteToSitePeer(std::unique_ptr<minifi::io::DataStream>(new minifi::io::DataStream()), host, port, ""));
+  return std::unique_ptr<minifi::sitetosite::SiteToSiteClient>(new minifi::sitetosite::RawSiteToSiteClient(std::move(peer)));
+}
+
+}  // namespace
+
+TEST_CASE("PeerSelector spreads transactions across peers", "[PeerSelector]") {
+  minifi::sitetosite::PeerSelector selector(minifi::sitetosite::SEND);
+  selector.setPeers(createPeers({0, 0, 0}));
+  REQUIRE(selector.getPeerCount() == 3);
+
+  std::map<std::string, int> transactions;
+  for (int i = 0; i < 6; ++i) {
+    std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+    auto peer = selector.acquire(client);
+    REQUIRE(peer != nullptr);
+    REQUIRE(client == nullptr);
+    transactions[peer->getHost()]++;
+  }
+  REQUIRE(transactions.size() == 3);
+  for (const auto &peer : transactions) {
+    REQUIRE(peer.second == 2);
+  }
+
+  // a released peer is chosen for the next transaction
+  selector.release("host1:8080", nullptr);
+  std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+  REQUIRE(selector.acquire(client)->getHost() == "host1");
+}
+
+TEST_CASE("PeerSelector weights peers by their queued flow files", "[PeerSelector]") {
+  std::map<std::string, int> transactions;
+  SECTION("Sending prefers the peers with the fewest flow files") {
+    minifi::sitetosite::PeerSelector selector(minifi::sitetosite::SEND);
+    selector.setPeers(createPeers({900, 100}));
+    for (int i = 0; i < 20; ++i) {
+      std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+      transactions[selector.acquire(client)->getHost()]++;
+    }
+    REQUIRE(transactions["host1"] > 3 * transactions["host0"]);
+  }
+  SECTION("Receiving prefers the peers with the most flow files") {
+    minifi::sitetosite::PeerSelector selector(minifi::sitetosite::RECEIVE);
+    selector.setPeers(createPeers({900, 100}));
+    for (int i = 0; i < 20; ++i) {
+      std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+      transactions[selector.acquire(client)->getHost()]++;
+    }
+    REQUIRE(transactions["host0"] > 3 * transactions["host1"]);
+  }
+}
+
+TEST_CASE("PeerSelector avoids penalized peers", "[PeerSelector]") {
+  minifi::sitetosite::PeerSelector selector(minifi::sitetosite::SEND, 1, 100);
+  selector.setPeers(createPeers({0, 0}));
+
+  std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+  auto peer = selector.acquire(client);
+  const auto penalized = minifi::sitetosite::PeerSelector::getAddress(*peer);
+  selector.penalize(penalized);
+  for (int i = 0; i < 5; ++i) {
+    REQUIRE(minifi::sitetosite::PeerSelector::getAddress(*selector.acquire(client)) != penalized);
+  }
+
+  selector.penalize(penalized == "host0:8080" ? "host1:8080" : "host0:8080");
+  REQUIRE(selector.acquire(client) == nullptr);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  REQUIRE(selector.acquire(client) != nullptr);
+}
+
+TEST_CASE("PeerSelector pools the clients of every peer", "[PeerSelector]") {
+  minifi::sitetosite::PeerSelector selector(minifi::sitetosite::SEND, 1);
+  selector.setPeers(createPeers({0}));
+
+  std::unique_ptr<minifi::sitetosite::SiteToSiteClient> first;
+  std::unique_ptr<minifi::sitetosite::SiteToSiteClient> second;
+  REQUIRE(selector.acquire(first) != nullptr);
+  REQUIRE(selector.acquire(second) != nullptr);
+  first = createClient("host0", 8080);
+  second = createClient("host0", 8080);
+  REQUIRE(first->getPeerAddress() == "host0:8080");
+  auto pooled = first.get();
+  selector.release(first->getPeerAddress(), std::move(first));
+  // only one idle client is kept
+  selector.release(second->getPeerAddress(), std::move(second));
+
+  std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client;
+  REQUIRE(selector.acquire(client) != nullptr);
+  REQUIRE(client.get() == pooled);
+
+  // the state of the remaining peers survives a refresh
+  auto refreshed = createPeers({0, 0});
+  selector.setPeers(refreshed);
+  selector.release(client->getPeerAddress(), std::move(client));
+  REQUIRE(selector.acquire(client) != nullptr);
+  REQUIRE(client.get() == pooled);
+
+  selector.release(client->getPeerAddress(), std::move(client));
+  selector.clear();
+  REQUIRE(selector.acquire(client) != nullptr);
+  REQUIRE(client == nullptr);
+}
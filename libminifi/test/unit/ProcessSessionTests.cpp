@@ -15,10 +15,15 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <fstream>
+#include <iostream>
 #include <string>
 
 #include <catch.hpp>
 #include "core/ProcessSession.h"
+#include "io/DataStream.h"
+#include "utils/file/FileUtils.h"
 #include "../TestBase.h"
 
 namespace {
@@ -33,11 +38,14 @@ class Fixture {
  public:
   Fixture();
   core::ProcessSession &processSession() { return *process_session_; }
+  std::shared_ptr<core::ProcessContext> context() { return context_; }
+  minifi::Connection &selfLoop() { return *self_loop_; }
 
  private:
   TestController test_controller_;
   std::shared_ptr<TestPlan> test_plan_;
   std::shared_ptr<core::Processor> dummy_processor_;
+  std::shared_ptr<minifi::Connection> self_loop_;
   std::shared_ptr<core::ProcessContext> context_;
   std::unique_ptr<core::ProcessSession> process_session_;
 };
@@ -45,6 +53,7 @@ class Fixture {
 Fixture::Fixture() {
   test_plan_ = test_controller_.createPlan();
   dummy_processor_ = test_plan_->addProcessor("DummyProcessor", "dummyProcessor");
+  self_loop_ = test_plan_->addConnection(dummy_processor_, {"loop", "flow files routed back to the processor"}, dummy_processor_);
   test_plan_->runNextProcessor();  // set the dummy processor as current
   context_ = test_plan_->getCurrentContext();
   process_session_ = utils::make_unique<core::ProcessSession>(context_);
@@ -74,3 +83,136 @@ TEST_CASE("ProcessSession::existsFlowFileInRelationship works", "[existsFlowFile
   REQUIRE(process_session.existsFlowFileInRelationship(Failure));
   REQUIRE(process_session.existsFlowFileInRelationship(Success));
 }
+
+TEST_CASE("ProcessSession::rollback reverts the modifications of polled FlowFiles", "[rollback]") {
+  Fixture fixture;
+  const core::Relationship Loop{"loop", "flow files routed back to the processor"};
+
+  {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.create();
+    session.putAttribute(flow_file, "state", "original");
+    session.transfer(flow_file, Loop);
+    session.commit();
+  }
+  REQUIRE(fixture.selfLoop().getQueueSize() == 1);
+
+  {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.get();
+    REQUIRE(flow_file);
+    session.putAttribute(flow_file, "state", "modified");
+    session.putAttribute(flow_file, "extra", "value");
+    session.rollback();
+  }
+  REQUIRE(fixture.selfLoop().getQueueSize() == 1);
+
+  core::ProcessSession session(fixture.context());
+  const auto flow_file = session.get();
+  REQUIRE(flow_file);
+  std::string value;
+  REQUIRE(flow_file->getAttribute("state", value));
+  REQUIRE(value == "original");
+  REQUIRE_FALSE(flow_file->getAttribute("extra", value));
+}
+
+TEST_CASE("ProcessSession::rollback reverts the content imported into polled FlowFiles", "[rollback]") {
+  Fixture fixture;
+  const core::Relationship Loop{"loop", "flow files routed back to the processor"};
+  const std::string original_content = "original";
+  const std::string imported_content = "imported content";
+
+  std::shared_ptr<minifi::ResourceClaim> original_claim;
+  {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.create();
+    minifi::io::DataStream stream(reinterpret_cast<const uint8_t*>(original_content.data()), original_content.size());
+    session.importFrom(stream, flow_file);
+    original_claim = flow_file->getResourceClaim();
+    session.transfer(flow_file, Loop);
+    session.commit();
+  }
+  REQUIRE(original_claim);
+
+  {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.get();
+    REQUIRE(flow_file);
+    SECTION("importFrom") {
+      minifi::io::DataStream stream(reinterpret_cast<const uint8_t*>(imported_content.data()), imported_content.size());
+      session.importFrom(stream, flow_file);
+    }
+    SECTION("import") {
+      TestController test_controller;
+      char format[] = "/tmp/gt.XXXXXX";
+      const std::string source = utils::file::FileUtils::concat_path(test_controller.createTempDirectory(format), "source");
+      std::ofstream{source, std::ios::binary} << imported_content;
+      session.import(source, flow_file, true);
+    }
+    REQUIRE(flow_file->getResourceClaim() != original_claim);
+    REQUIRE(flow_file->getSize() == imported_content.size());
+    session.rollback();
+  }
+  REQUIRE(fixture.selfLoop().getQueueSize() == 1);
+
+  core::ProcessSession session(fixture.context());
+  const auto flow_file = session.get();
+  REQUIRE(flow_file);
+  REQUIRE(flow_file->getResourceClaim() == original_claim);
+  REQUIRE(flow_file->getSize() == original_content.size());
+}
+
+TEST_CASE("ProcessSession::rollback removes the content written into polled FlowFiles", "[rollback]") {
+  Fixture fixture;
+  const core::Relationship Loop{"loop", "flow files routed back to the processor"};
+  {
+    core::ProcessSession session(fixture.context());
+    session.transfer(session.create(), Loop);
+    session.commit();
+  }
+
+  struct WriteCallback : public minifi::OutputStreamCallback {
+    int64_t process(std::shared_ptr<minifi::io::BaseStream> stream) override {
+      std::string content = "written content";
+      return stream->writeData(reinterpret_cast<uint8_t*>(&content[0]), content.size());
+    }
+  } callback;
+
+  std::shared_ptr<minifi::ResourceClaim> written_claim;
+  {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.get();
+    REQUIRE(flow_file);
+    session.write(flow_file, &callback);
+    written_claim = flow_file->getResourceClaim();
+    REQUIRE(written_claim);
+    REQUIRE(fixture.context()->getContentRepository()->exists(written_claim));
+    session.rollback();
+  }
+  REQUIRE_FALSE(fixture.context()->getContentRepository()->exists(written_claim));
+}
+
+TEST_CASE("ProcessSession get/transfer/commit cost per FlowFile", "[.][benchmark]") {
+  Fixture fixture;
+  const core::Relationship Loop{"loop", "flow files routed back to the processor"};
+  constexpr size_t FLOW_FILE_COUNT = 10000;
+
+  {
+    core::ProcessSession session(fixture.context());
+    for (size_t i = 0; i < FLOW_FILE_COUNT; ++i) {
+      session.transfer(session.create(), Loop);
+    }
+    session.commit();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < FLOW_FILE_COUNT; ++i) {
+    core::ProcessSession session(fixture.context());
+    const auto flow_file = session.get();
+    REQUIRE(flow_file);
+    session.transfer(flow_file, Loop);
+    session.commit();
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "get/transfer/commit: " << elapsed.count() / FLOW_FILE_COUNT << " ns per FlowFile" << std::endl;
+}
@@ -0,0 +1,144 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../TestBase.h"
+#include "FlowFileRecord.h"
+#include "ProvenanceTestHelper.h"
+#include "core/repository/VolatileContentRepository.h"
+#include "properties/Configure.h"
+#include "provenance/Provenance.h"
+
+namespace {
+
+std::shared_ptr<minifi::FlowFileRecord> createFlowFile(const std::shared_ptr<core::Repository> &repo) {
+  std::map<std::string, std::string> attributes{{"filename", "data.txt"}};
+  auto flow_file = std::make_shared<minifi::FlowFileRecord>(repo, std::make_shared<core::repository::VolatileContentRepository>(), attributes);
+  flow_file->setSize(10);
+  return flow_file;
+}
+
+std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>> storedEvents(const std::shared_ptr<TestRepository> &repo) {
+  std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>> events;
+  for (const auto &entry : repo->getRepoMap()) {
+    auto event = std::make_shared<provenance::ProvenanceEventRecord>();
+    REQUIRE(event->DeSerialize(reinterpret_cast<const uint8_t*>(entry.second.data()), entry.second.size()));
+    events.push_back(event);
+  }
+  return events;
+}
+
+}  // namespace
+
+TEST_CASE("Lightweight provenance events carry no attributes", "[ProvenancePolicy]") {
+  TestController testController;
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_mode, "lightweight");
+  auto repo = std::make_shared<TestRepository>();
+  auto policy = std::make_shared<provenance::ProvenancePolicy>(configuration, repo, "processor", "processor");
+  REQUIRE(policy->getMode() == provenance::ProvenancePolicy::Mode::LIGHTWEIGHT);
+
+  provenance::ProvenanceReporter reporter(repo, "processor", "processor", policy);
+  reporter.create(createFlowFile(repo), "created");
+  reporter.commit();
+
+  auto events = storedEvents(repo);
+  REQUIRE(events.size() == 1);
+  REQUIRE(events[0]->getEventType() == provenance::ProvenanceEventRecord::CREATE);
+  REQUIRE(events[0]->getAttributes().empty());
+  REQUIRE(events[0]->getLineageIdentifiers().empty());
+}
+
+TEST_CASE("Provenance events are sampled per processor", "[ProvenancePolicy]") {
+  TestController testController;
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(std::string(minifi::Configure::nifi_provenance_sampling_rate) + ".sampled", "0.1");
+  auto repo = std::make_shared<TestRepository>();
+
+  for (const std::string processor : {"sampled", "other"}) {
+    auto policy = std::make_shared<provenance::ProvenancePolicy>(configuration, repo, processor, processor);
+    provenance::ProvenanceReporter reporter(repo, processor, processor, policy);
+    for (int i = 0; i < 100; ++i) {
+      reporter.create(createFlowFile(repo), "created");
+    }
+    reporter.commit();
+  }
+
+  size_t sampled = 0;
+  size_t other = 0;
+  for (const auto &event : storedEvents(repo)) {
+    REQUIRE(event->getAttributes().at("filename") == "data.txt");
+    (event->getComponentType() == "sampled" ? sampled : other)++;
+  }
+  REQUIRE(sampled == 10);
+  REQUIRE(other == 100);
+}
+
+TEST_CASE("Aggregated provenance events count the events and bytes per type", "[ProvenancePolicy]") {
+  TestController testController;
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_mode, "aggregate");
+  auto repo = std::make_shared<TestRepository>();
+  auto policy = std::make_shared<provenance::ProvenancePolicy>(configuration, repo, "processor", "processor");
+
+  for (int session = 0; session < 2; ++session) {
+    provenance::ProvenanceReporter reporter(repo, "processor", "processor", policy);
+    for (int i = 0; i < 3; ++i) {
+      reporter.create(createFlowFile(repo), "created");
+    }
+    reporter.drop(createFlowFile(repo), "dropped");
+    reporter.commit();
+  }
+  // the aggregation interval has not elapsed yet
+  REQUIRE(repo->getRepoMap().empty());
+
+  policy->flush();
+  auto events = storedEvents(repo);
+  REQUIRE(events.size() == 2);
+  for (const auto &event : events) {
+    const bool created = event->getEventType() == provenance::ProvenanceEventRecord::CREATE;
+    REQUIRE(event->getAttributes().at("provenance.aggregate.events") == (created ? "6" : "2"));
+    REQUIRE(event->getAttributes().at("provenance.aggregate.bytes") == (created ? "60" : "20"));
+    REQUIRE(event->getFileSize() == (created ? 60 : 20));
+  }
+}
+
+TEST_CASE("The provenance aggregation interval can be overridden per processor", "[ProvenancePolicy]") {
+  TestController testController;
+  auto configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_mode, "aggregate");
+  configuration->set(minifi::Configure::nifi_provenance_aggregation_interval, "1 hour");
+  configuration->set(std::string(minifi::Configure::nifi_provenance_aggregation_interval) + ".frequent", "1 ms");
+
+  for (const std::string processor : {"frequent", "other"}) {
+    auto repo = std::make_shared<TestRepository>();
+    auto policy = std::make_shared<provenance::ProvenancePolicy>(configuration, repo, processor, processor);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    provenance::ProvenanceReporter reporter(repo, processor, processor, policy);
+    reporter.create(createFlowFile(repo), "created");
+    reporter.commit();
+    // only the overridden interval has elapsed
+    REQUIRE(storedEvents(repo).size() == (processor == "frequent" ? 1 : 0));
+  }
+}
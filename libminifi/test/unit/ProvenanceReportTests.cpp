@@ -0,0 +1,137 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../TestBase.h"
+#include "core/reporting/SiteToSiteProvenanceReportingTask.h"
+#include "io/StreamFactory.h"
+#include "provenance/Provenance.h"
+#include "rapidjson/document.h"
+
+namespace {
+
+using minifi::core::reporting::SiteToSiteProvenanceReportingTask;
+
+std::shared_ptr<SiteToSiteProvenanceReportingTask> createReportingTask() {
+  auto configuration = std::make_shared<minifi::Configure>();
+  return std::make_shared<SiteToSiteProvenanceReportingTask>(minifi::io::StreamFactory::getInstance(configuration), configuration);
+}
+
+std::vector<std::shared_ptr<core::SerializableComponent>> createEvents(size_t count) {
+  std::vector<std::shared_ptr<core::SerializableComponent>> events;
+  for (size_t i = 0; i < count; ++i) {
+    auto event = std::make_shared<provenance::ProvenanceEventRecord>(provenance::ProvenanceEventRecord::SEND, "componentid", "componenttype");
+    event->setDetails("event " + std::to_string(i));
+    event->setTransitUri("http://localhost:8080/contentListener");
+    event->addParentUuid("parent");
+    events.push_back(event);
+  }
+  return events;
+}
+
+}  // namespace
+
+TEST_CASE("The JSON report contains every event", "[ProvenanceReport]") {
+  TestController testController;
+  auto task = createReportingTask();
+  auto events = createEvents(3);
+
+  std::string report;
+  task->getJsonReport(nullptr, nullptr, events, report);
+  REQUIRE(report.find('\n') == std::string::npos);
+
+  rapidjson::Document document;
+  document.Parse(report.c_str(), report.length());
+  REQUIRE_FALSE(document.HasParseError());
+  REQUIRE(document.IsArray());
+  REQUIRE(document.Size() == 3);
+  REQUIRE(std::string(document[1]["details"].GetString()) == "event 1");
+  REQUIRE(std::string(document[1]["eventType"].GetString()) == "SEND");
+  REQUIRE(std::string(document[1]["componentType"].GetString()) == "componenttype");
+  REQUIRE(document[1]["parentIds"].Size() == 1);
+  REQUIRE(document[1]["childIds"].Size() == 0);
+  REQUIRE(document[1]["updatedAttributes"].IsObject());
+}
+
+TEST_CASE("The binary report contains the length prefixed events", "[ProvenanceReport]") {
+  TestController testController;
+  auto task = createReportingTask();
+  REQUIRE(task->setReportFormat("BINARY"));
+  REQUIRE(task->getReportFormat() == SiteToSiteProvenanceReportingTask::ReportFormat::BINARY);
+  REQUIRE_FALSE(task->setReportFormat("xml"));
+  auto events = createEvents(3);
+
+  std::string report;
+  task->getBinaryReport(events, report);
+
+  size_t position = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    REQUIRE(position + 4 <= report.size());
+    uint32_t length = 0;
+    for (size_t j = 0; j < 4; ++j) {
+      length = (length << 8) | static_cast<uint8_t>(report[position + j]);
+    }
+    position += 4;
+    provenance::ProvenanceEventRecord event;
+    REQUIRE(event.DeSerialize(reinterpret_cast<const uint8_t*>(report.data() + position), length));
+    REQUIRE(event.getDetails() == "event " + std::to_string(i));
+    position += length;
+  }
+  REQUIRE(position == report.size());
+}
+
+TEST_CASE("Provenance report throughput", "[.][benchmark]") {
+  TestController testController;
+  auto task = createReportingTask();
+  constexpr size_t EVENT_COUNT = 10000;
+  constexpr size_t REPORT_COUNT = 20;
+  auto events = createEvents(EVENT_COUNT);
+
+  // the peak resident set size only grows, so the leaner format is measured first
+  for (const bool binary : {true, false}) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t report_size = 0;
+    for (size_t i = 0; i < REPORT_COUNT; ++i) {
+      std::string report;
+      if (binary) {
+        task->getBinaryReport(events, report);
+      } else {
+        task->getJsonReport(nullptr, nullptr, events, report);
+      }
+      report_size = report.size();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << (binary ? "binary" : "json") << " report: " << EVENT_COUNT * REPORT_COUNT * 1000 / (elapsed.count() + 1) << " events/sec, "
+        << report_size / 1024 << " KB per " << EVENT_COUNT << " events";
+#ifndef WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << ", peak RSS " << usage.ru_maxrss / 1024 << " MB";
+#endif
+    std::cout << std::endl;
+  }
+}
@@ -95,8 +95,11 @@ TEST_CASE("TestSiteToSiteVerifySend", "[S2S3]") {
 
   std::unique_ptr<minifi::sitetosite::SiteToSitePeer> peer = std::unique_ptr<minifi::sitetosite::SiteToSitePeer>(
       new minifi::sitetosite::SiteToSitePeer(std::unique_ptr<minifi::io::DataStream>(new org::apache::nifi::minifi::io::BaseStream(collector)), "fake_host", 65433, ""));
+  auto peer_reference = peer.get();
 
   minifi::sitetosite::RawSiteToSiteClient protocol(std::move(peer));
+  // every field is checked as a separate write, the coalescing of writes is tested below
+  peer_reference->setWriteBufferSize(0);
 
   std::string uuid_str = "C56A4180-65AA-42EC-A945-5FD21DEC0538";
 
@@ -153,6 +156,30 @@ TEST_CASE("TestSiteToSiteVerifySend", "[S2S3]") {
   REQUIRE(payload == rx_payload);
 }
 
+TEST_CASE("SiteToSitePeer coalesces small writes", "[S2S5]") {
+  SiteToSiteResponder *collector = new SiteToSiteResponder();
+  minifi::sitetosite::SiteToSitePeer peer(std::unique_ptr<minifi::io::DataStream>(new org::apache::nifi::minifi::io::BaseStream(collector)), "fake_host", 65433, "");
+  peer.setWriteBufferSize(16);
+
+  uint32_t number = 7;
+  REQUIRE(peer.write(number) == 4);
+  REQUIRE(peer.writeUTF("abc") > 0);
+  REQUIRE_FALSE(collector->has_next_client_response());
+
+  // a full buffer is written at once, larger writes bypass it
+  std::string content(32, 'x');
+  REQUIRE(peer.write(reinterpret_cast<uint8_t*>(&content[0]), content.size()) == 32);
+  REQUIRE(collector->get_next_client_response().size() == 9);
+  REQUIRE(collector->get_next_client_response() == content);
+
+  REQUIRE(peer.writeUTF("def") > 0);
+  REQUIRE_FALSE(collector->has_next_client_response());
+  collector->push_response("1");
+  uint8_t value;
+  REQUIRE(peer.read(value) == 1);
+  REQUIRE(collector->get_next_client_response().size() == 5);
+}
+
 TEST_CASE("TestSiteToSiteVerifyNegotiationFail", "[S2S4]") {
   SiteToSiteResponder *collector = new SiteToSiteResponder();
 
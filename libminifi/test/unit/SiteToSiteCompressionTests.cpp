@@ -0,0 +1,146 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "io/DataStream.h"
+#include "sitetosite/CompressionStream.h"
+#include "sitetosite/Peer.h"
+#include "../TestBase.h"
+
+namespace {
+
+std::string compress(const std::string &data, size_t buffer_size) {
+  minifi::io::DataStream output;
+  minifi::sitetosite::CompressionOutputStream compressor(&output, minifi::sitetosite::CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL, buffer_size);
+  REQUIRE(compressor.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), data.size()) == static_cast<int>(data.size()));
+  REQUIRE(compressor.finish());
+  return std::string(reinterpret_cast<const char*>(output.getBuffer()), output.getSize());
+}
+
+std::string text(size_t size) {
+  std::string data;
+  for (size_t i = 0; data.size() < size; ++i) {
+    data += "{\"id\":" + std::to_string(i) + ",\"sensor\":\"temperature\",\"value\":" + std::to_string(i % 40) + "}\n";
+  }
+  data.resize(size);
+  return data;
+}
+
+}  // namespace
+
+TEST_CASE("Compressed site-to-site data is framed like NiFi's CompressionOutputStream", "[S2SCompression]") {
+  const std::string compressed = compress("hello hello hello", 64);
+  REQUIRE(compressed.substr(0, 4) == "SYNC");
+  // original length as a big endian integer
+  REQUIRE(compressed.substr(4, 4) == std::string("\0\0\0\x11", 4));
+  REQUIRE(compressed.back() == '\0');
+
+  const std::string chunked = compress(text(200), 64);
+  REQUIRE(chunked.substr(0, 4) == "SYNC");
+  REQUIRE(chunked.find(std::string("\x01SYNC", 5)) != std::string::npos);
+}
+
+TEST_CASE("CompressionInputStream reads exactly the compressed data", "[S2SCompression]") {
+  const std::string data = text(100000);
+  const std::string compressed = compress(data, 4096);
+  REQUIRE(compressed.size() < data.size() / 2);
+
+  minifi::io::DataStream input(reinterpret_cast<const uint8_t*>(compressed.data()), compressed.size());
+  const std::string trailer = "next";
+  input.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(trailer.data())), trailer.size());
+
+  minifi::sitetosite::CompressionInputStream decompressor(&input);
+  std::vector<uint8_t> buffer;
+  std::string read;
+  while (!decompressor.isFinished()) {
+    REQUIRE(decompressor.readData(buffer, 1000) > 0);
+    read.append(buffer.begin(), buffer.end());
+  }
+  REQUIRE(read == data);
+  REQUIRE(decompressor.readData(buffer, 10) == 0);
+
+  std::vector<uint8_t> rest;
+  REQUIRE(input.readData(rest, 4) == 4);
+  REQUIRE(std::string(rest.begin(), rest.end()) == trailer);
+}
+
+TEST_CASE("SiteToSitePeer compresses and decompresses packets", "[S2SCompression]") {
+  auto stream = new minifi::io::DataStream();
+  minifi::sitetosite::SiteToSitePeer peer(std::unique_ptr<minifi::io::DataStream>(stream), "fake_host", 65433, "");
+  peer.setWriteBufferSize(1024);
+
+  const uint32_t attributes = 1;
+  peer.startCompression();
+  REQUIRE(peer.write(attributes) == 4);
+  REQUIRE(peer.writeUTF("filename", true) > 0);
+  REQUIRE(peer.writeUTF("data.txt", true) > 0);
+  REQUIRE(peer.finishCompression());
+  const uint8_t response = 0x0F;
+  REQUIRE(peer.write(response) == 1);
+  REQUIRE(peer.flush());
+
+  peer.startDecompression();
+  uint32_t read_attributes;
+  std::string key;
+  std::string value;
+  REQUIRE(peer.read(read_attributes) == 4);
+  REQUIRE(read_attributes == attributes);
+  REQUIRE(peer.readUTF(key, true) > 0);
+  REQUIRE(peer.readUTF(value, true) > 0);
+  REQUIRE(key == "filename");
+  REQUIRE(value == "data.txt");
+  // the end of the compressed data switches back to the plain stream
+  uint8_t read_response;
+  REQUIRE(peer.read(read_response) == 1);
+  REQUIRE(read_response == response);
+}
+
+TEST_CASE("Site-to-site compression throughput and bytes on the wire", "[.][benchmark]") {
+  std::mt19937 generator(7);
+  std::string random(8 * 1024 * 1024, '\0');
+  for (auto &byte : random) {
+    byte = static_cast<char>(generator());
+  }
+  struct Scenario {
+    std::string name;
+    std::string data;
+  };
+  for (const auto &scenario : {Scenario{"json lines", text(8 * 1024 * 1024)}, Scenario{"random", random}}) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::string compressed = compress(scenario.data, minifi::sitetosite::CompressionOutputStream::DEFAULT_BUFFER_SIZE);
+    const auto middle = std::chrono::steady_clock::now();
+    minifi::io::DataStream input(reinterpret_cast<const uint8_t*>(compressed.data()), compressed.size());
+    minifi::sitetosite::CompressionInputStream decompressor(&input);
+    std::vector<uint8_t> buffer(scenario.data.size());
+    REQUIRE(decompressor.readData(buffer.data(), buffer.size()) == static_cast<int>(buffer.size()));
+    const auto end = std::chrono::steady_clock::now();
+
+    const double megabytes = scenario.data.size() / (1024.0 * 1024.0);
+    const auto compress_ms = std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count();
+    const auto decompress_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count();
+    std::cout << scenario.name << ": " << scenario.data.size() << " bytes sent as " << compressed.size() << " bytes on the wire ("
+        << (100.0 * compressed.size() / scenario.data.size()) << "%), compression " << megabytes * 1000 / (compress_ms + 1) << " MB/s, decompression "
+        << megabytes * 1000 / (decompress_ms + 1) << " MB/s" << std::endl;
+  }
+}